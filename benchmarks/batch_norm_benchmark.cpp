@@ -0,0 +1,132 @@
+#include "../src/network/network.h"
+#include "../src/network/layer.h"
+#include "../src/network/batch_norm_layer.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <random>
+
+// 批归一化基准：深层sigmoid网络逐批训练时有无批归一化的收敛速度，以及推理时折叠前后的吞吐量
+int main() {
+    const size_t inputs = 16;
+    const size_t hidden = 32;
+    const size_t depth = 6;
+    const size_t classes = 4;
+    const size_t batch_size = 32;
+    const int epochs = 40;
+    const double learning_rate = 0.5;
+    
+    // 每类一个高斯簇，输入尺度各不相同（部分特征远离0，使sigmoid饱和）
+    std::mt19937 rng(5);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::vector<std::vector<double>> centers(classes, std::vector<double>(inputs));
+    for (auto& center : centers) {
+        for (size_t k = 0; k < inputs; k++) {
+            center[k] = noise(rng) * (1.0 + k % 4) + 3.0;
+        }
+    }
+    auto make_dataset = [&](size_t count) {
+        neural_network::Dataset data;
+        for (size_t i = 0; i < count; i++) {
+            const size_t label = i % classes;
+            std::vector<double> x(inputs);
+            for (size_t k = 0; k < inputs; k++) {
+                x[k] = centers[label][k] + noise(rng) * 2.5;
+            }
+            std::vector<double> target(classes, 0.0);
+            target[label] = 1.0;
+            data.push_back({x, target});
+        }
+        return data;
+    };
+    neural_network::Dataset train_data = make_dataset(1024);
+    neural_network::Dataset validation = make_dataset(512);
+    std::vector<std::vector<double>> validation_inputs;
+    for (const auto& sample : validation) {
+        validation_inputs.push_back(sample.first);
+    }
+    
+    auto build = [&](bool batch_norm) {
+        auto network = std::make_shared<neural_network::Network>();
+        network->setSeed(3);
+        size_t width = inputs;
+        for (size_t d = 0; d < depth; d++) {
+            auto dense = std::make_shared<neural_network::Layer>(hidden, width);
+            if (batch_norm) {
+                for (auto& neuron : dense->getNeurons()) {
+                    neuron->setActivationFunction(neural_network::ActivationType::LINEAR);
+                }
+            }
+            network->addLayer(dense);
+            if (batch_norm) {
+                network->addLayer(std::make_shared<neural_network::BatchNormLayer>(
+                    hidden, neural_network::ActivationType::SIGMOID));
+            }
+            width = hidden;
+        }
+        network->addLayer(std::make_shared<neural_network::Layer>(classes, width));
+        return network;
+    };
+    
+    auto throughput = [&](const neural_network::Network& network) {
+        double best = 1e30;
+        for (int repeat = 0; repeat < 5; repeat++) {
+            auto start = std::chrono::steady_clock::now();
+            auto outputs = network.predictBatch(validation_inputs);
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (outputs.size() == validation_inputs.size()) {
+                best = std::min(best, elapsed);
+            }
+        }
+        return validation_inputs.size() / best;
+    };
+    
+    std::cout << "网络: " << inputs << "-" << hidden << "x" << depth << "-" << classes << "，批大小: " << batch_size
+              << "，学习率: " << learning_rate << "，训练/验证样本: " << train_data.size() << "/" << validation.size()
+              << std::endl;
+    std::cout << "列: 模型 / 各轮后的验证准确率 / 首次达到90%准确率的轮数" << std::endl;
+    
+    std::shared_ptr<neural_network::Network> trained_bn;
+    for (int batch_norm = 0; batch_norm < 2; batch_norm++) {
+        auto network = build(batch_norm != 0);
+        int reached = -1;
+        std::cout << std::left << std::setw(12) << (batch_norm ? "batchnorm" : "plain");
+        for (int epoch = 1; epoch <= epochs; epoch++) {
+            for (size_t begin = 0; begin < train_data.size(); begin += batch_size) {
+                neural_network::Dataset batch(train_data.begin() + begin,
+                                              train_data.begin() + std::min(train_data.size(), begin + batch_size));
+                network->trainBatch(batch, learning_rate);
+            }
+            double accuracy = network->evaluate(validation, neural_network::EvaluationMetrics::ALL, 1).accuracy;
+            if (reached < 0 && accuracy >= 0.9) {
+                reached = epoch;
+            }
+            if (epoch % 10 == 0 || epoch == 1) {
+                std::cout << "ep" << epoch << "=" << std::fixed << std::setprecision(3) << accuracy << "  ";
+            }
+        }
+        std::cout << "90%@" << (reached < 0 ? std::string("未达到") : std::to_string(reached)) << std::endl;
+        if (batch_norm) {
+            trained_bn = network;
+        }
+    }
+    
+    // 推理：带批归一化层、折叠后、以及同结构的普通网络
+    auto folded = trained_bn->foldBatchNorm();
+    auto plain = build(false);
+    double difference = 0.0;
+    auto reference = trained_bn->predictBatch(validation_inputs);
+    auto folded_outputs = folded->predictBatch(validation_inputs);
+    for (size_t s = 0; s < reference.size(); s++) {
+        for (size_t k = 0; k < reference[s].size(); k++) {
+            difference = std::max(difference, std::abs(reference[s][k] - folded_outputs[s][k]));
+        }
+    }
+    std::cout << "推理吞吐(样本/秒): batchnorm " << std::setprecision(0) << throughput(*trained_bn)
+              << "，折叠后 " << throughput(*folded) << "（" << folded->getLayerCount() << "层），普通网络 "
+              << throughput(*plain) << "；折叠前后最大偏差 " << std::scientific << std::setprecision(2) << difference
+              << std::endl;
+    return 0;
+}
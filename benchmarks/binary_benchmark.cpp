@@ -0,0 +1,95 @@
+#include "../src/network/network.h"
+#include "../src/network/layer.h"
+#include "../src/network/binary_layer.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <random>
+
+// 二值层基准：0/1像素输入上全连接隐藏层与XNOR-popcount隐藏层的准确率、推理参数内存和吞吐量
+int main() {
+    const size_t side = 16;
+    const size_t inputs = side * side;
+    const size_t hidden = 256;
+    const size_t classes = 10;
+    const double flip_probability = 0.1;
+    const int epochs = 5;
+    
+    // 与digit_recognition示例相同的0/1像素：每类一个随机原型，样本随机翻转部分像素
+    std::mt19937 rng(11);
+    std::bernoulli_distribution coin(0.5);
+    std::bernoulli_distribution flip(flip_probability);
+    std::vector<std::vector<double>> prototypes(classes, std::vector<double>(inputs));
+    for (auto& prototype : prototypes) {
+        for (auto& pixel : prototype) {
+            pixel = coin(rng) ? 1.0 : 0.0;
+        }
+    }
+    auto make_dataset = [&](size_t count) {
+        neural_network::Dataset data;
+        for (size_t i = 0; i < count; i++) {
+            const size_t label = i % classes;
+            std::vector<double> x = prototypes[label];
+            for (auto& pixel : x) {
+                if (flip(rng)) {
+                    pixel = 1.0 - pixel;
+                }
+            }
+            std::vector<double> target(classes, 0.0);
+            target[label] = 1.0;
+            data.push_back({x, target});
+        }
+        return data;
+    };
+    neural_network::Dataset train_data = make_dataset(500);
+    neural_network::Dataset validation = make_dataset(500);
+    
+    std::cout << "网络: " << inputs << "-" << hidden << "-" << classes << "，像素翻转概率: " << flip_probability
+              << "，训练/验证样本: " << train_data.size() << "/" << validation.size() << std::endl;
+    std::cout << "列: 隐藏层类型 / 准确率 / 隐藏层推理参数(字节) / 隐藏层批量推理吞吐(样本/秒)" << std::endl;
+    std::cout << std::left << std::setw(10) << "hidden" << std::setw(12) << "accuracy" << std::setw(16) << "param_bytes"
+              << "samples_per_s" << std::endl;
+    
+    std::vector<std::vector<double>> batch;
+    for (const auto& sample : validation) {
+        batch.push_back(sample.first);
+    }
+    
+    for (int binary = 0; binary < 2; binary++) {
+        std::shared_ptr<neural_network::Layer> hidden_layer;
+        if (binary) {
+            hidden_layer = std::make_shared<neural_network::BinaryLayer>(hidden, inputs);
+        } else {
+            hidden_layer = std::make_shared<neural_network::Layer>(hidden, inputs);
+        }
+        neural_network::Network network;
+        network.setSeed(1);
+        network.addLayer(hidden_layer);
+        network.addLayer(std::make_shared<neural_network::Layer>(classes, hidden));
+        for (int epoch = 0; epoch < epochs; epoch++) {
+            for (const auto& sample : train_data) {
+                network.train(sample.first, sample.second, 0.1);
+            }
+        }
+        auto evaluation = network.evaluate(validation, neural_network::EvaluationMetrics::ALL, 1);
+        
+        // 只测隐藏层本身，重复多次取最小耗时
+        double best = 1e30;
+        for (int repeat = 0; repeat < 5; repeat++) {
+            auto start = std::chrono::steady_clock::now();
+            auto outputs = hidden_layer->predictBatch(batch);
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (outputs.size() == batch.size()) {
+                best = std::min(best, elapsed);
+            }
+        }
+        
+        std::cout << std::left << std::setw(10) << hidden_layer->typeName() << std::setw(12) << std::fixed
+                  << std::setprecision(3) << evaluation.accuracy << std::setw(16)
+                  << hidden_layer->memoryUsage().parameter_bytes << std::setprecision(0)
+                  << batch.size() / best << std::endl;
+    }
+    return 0;
+}
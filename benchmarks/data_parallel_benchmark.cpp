@@ -0,0 +1,88 @@
+#include "../src/network/network.h"
+#include "../src/network/layer.h"
+#include "../src/network/data_parallel_trainer.h"
+#include "../src/neuron/neuron.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cmath>
+
+// 数据并行基准：单线程逐样本训练与DataParallelTrainer确定性/非确定性模式在不同线程数下的吞吐量，
+// 以及确定性模式的结果是否与线程数无关
+int main() {
+    const size_t inputs = 64;
+    const size_t hidden = 128;
+    const size_t classes = 10;
+    const size_t batch_size = 64;
+    const int epochs = 3;
+    
+    neural_network::Dataset data;
+    for (size_t i = 0; i < 1024; i++) {
+        std::vector<double> x(inputs);
+        for (size_t k = 0; k < inputs; k++) {
+            x[k] = std::sin(0.37 * i + 0.11 * k * (i % classes + 1));
+        }
+        std::vector<double> target(classes, 0.0);
+        target[i % classes] = 1.0;
+        data.push_back({x, target});
+    }
+    
+    auto make_network = [&]() {
+        neural_network::Neuron::setGlobalSeed(7);
+        neural_network::Network network;
+        network.addLayer(std::make_shared<neural_network::Layer>(hidden, inputs));
+        network.addLayer(std::make_shared<neural_network::Layer>(classes, hidden));
+        return network;
+    };
+    
+    std::cout << "网络: " << inputs << "-" << hidden << "-" << classes << "，样本: " << data.size()
+              << "，批大小: " << batch_size << "，轮数: " << epochs << std::endl;
+    std::cout << std::left << std::setw(16) << "mode" << std::setw(10) << "threads" << std::setw(16) << "samples_per_s"
+              << std::setw(12) << "loss" << "same_as_1_thread" << std::endl;
+    
+    // 基线：逐样本SGD（更新语义不同，只作吞吐量参考）
+    {
+        neural_network::Network network = make_network();
+        auto start = std::chrono::steady_clock::now();
+        for (int epoch = 0; epoch < epochs; epoch++) {
+            for (const auto& sample : data) {
+                network.train(sample.first, sample.second, 0.1);
+            }
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << std::left << std::setw(16) << "sequential_sgd" << std::setw(10) << 1 << std::setw(16)
+                  << std::fixed << std::setprecision(0) << epochs * data.size() / elapsed << std::setw(12) << "-"
+                  << "-" << std::endl;
+    }
+    
+    for (int deterministic = 1; deterministic >= 0; deterministic--) {
+        std::vector<double> reference;
+        for (size_t threads : {1, 2, 4}) {
+            neural_network::Network network = make_network();
+            neural_network::DataParallelOptions options;
+            options.num_threads = threads;
+            options.deterministic = deterministic != 0;
+            options.seed = 3;
+            neural_network::DataParallelTrainer trainer(network, options);
+            
+            double seconds = 0.0;
+            double loss = 0.0;
+            for (int epoch = 0; epoch < epochs; epoch++) {
+                auto stats = trainer.trainEpoch(data, batch_size, 0.5);
+                seconds += stats.wall_seconds;
+                loss = stats.mean_loss;
+            }
+            std::vector<double> parameters = network.getParameters();
+            if (threads == 1) {
+                reference = parameters;
+            }
+            std::cout << std::left << std::setw(16) << (deterministic ? "deterministic" : "fast") << std::setw(10)
+                      << threads << std::setw(16) << std::setprecision(0) << epochs * data.size() / seconds
+                      << std::setw(12) << std::setprecision(6) << loss << (parameters == reference ? "yes" : "no")
+                      << std::endl;
+        }
+    }
+    return 0;
+}
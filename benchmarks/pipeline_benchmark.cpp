@@ -0,0 +1,78 @@
+#include "../src/network/network.h"
+#include "../src/network/layer.h"
+#include "../src/network/pipeline_trainer.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <memory>
+#include <cstdlib>
+#include <thread>
+
+// 流水线并行训练基准：阶段利用率与气泡比例随微批次数的变化
+int main(int argc, char* argv[]) {
+    const size_t stages = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4;
+    const size_t depth = 8;
+    const size_t width = 64;
+    const size_t batch_size = 64;
+    const int steps = 5;
+    
+    neural_network::Network network;
+    network.setSeed(1);
+    for (size_t l = 0; l < depth; l++) {
+        network.addLayer(std::make_shared<neural_network::Layer>(width, width));
+    }
+    
+    neural_network::Dataset batch;
+    for (size_t i = 0; i < batch_size; i++) {
+        std::vector<double> inputs(width);
+        std::vector<double> targets(width);
+        for (size_t k = 0; k < width; k++) {
+            inputs[k] = ((i * 31 + k * 17) % 101) / 101.0;
+            targets[k] = ((i + k) % 2) * 1.0;
+        }
+        batch.push_back({inputs, targets});
+    }
+    
+    neural_network::PipelineTrainer trainer(network, stages);
+    std::cout << "网络: " << depth << "层 x " << width << "，批次: " << batch_size
+              << "，阶段数: " << trainer.getStageCount()
+              << "，硬件线程: " << std::thread::hardware_concurrency() << std::endl;
+    std::cout << "列: 调度 / 微批次数 / 每批耗时(ms) / 气泡比例 / 理论气泡比例 / 各阶段利用率" << std::endl;
+    std::cout << std::left << std::setw(8) << "sched" << std::setw(8) << "micro" << std::setw(12) << "wall_ms"
+              << std::setw(12) << "bubble" << std::setw(12) << "ideal" << "utilization" << std::endl;
+    
+    const neural_network::PipelineSchedule schedules[] = {neural_network::PipelineSchedule::GPIPE,
+                                                          neural_network::PipelineSchedule::ONE_F_ONE_B};
+    for (auto schedule : schedules) {
+        trainer.setSchedule(schedule);
+        for (size_t micro = 1; micro <= batch_size; micro *= 2) {
+            trainer.trainBatch(batch, micro, 0.01);
+            
+            double wall = 0.0;
+            double bubble = 0.0;
+            std::vector<double> utilization(trainer.getStageCount(), 0.0);
+            for (int step = 0; step < steps; step++) {
+                auto stats = trainer.trainBatch(batch, micro, 0.01);
+                wall += stats.wall_seconds;
+                bubble += stats.bubble_fraction;
+                for (size_t s = 0; s < utilization.size(); s++) {
+                    utilization[s] += stats.stage_utilization[s];
+                }
+            }
+            
+            // 各阶段耗时相同时的理论气泡比例：(S - 1) / (M + S - 1)
+            double ideal = (trainer.getStageCount() - 1.0) / (micro + trainer.getStageCount() - 1.0);
+            std::cout << std::left << std::setw(8)
+                      << (schedule == neural_network::PipelineSchedule::GPIPE ? "GPipe" : "1F1B")
+                      << std::setw(8) << micro << std::fixed << std::setprecision(3)
+                      << std::setw(12) << wall / steps * 1000.0 << std::setw(12) << bubble / steps
+                      << std::setw(12) << ideal;
+            for (double u : utilization) {
+                std::cout << u / steps << " ";
+            }
+            std::cout << std::endl;
+        }
+    }
+    
+    return 0;
+}
@@ -1,5 +1,6 @@
 #include "../src/network/network.h"
 #include "../src/network/layer.h"
+#include "../src/network/inference_cache.h"
 #include "../src/neuron/neuron.h"
 #include <iostream>
 #include <vector>
@@ -92,16 +93,14 @@ int main() {
         std::mt19937 g(rd());
         std::shuffle(trainingData.begin(), trainingData.end(), g);
         
-        double totalLoss = 0.0;
         for (const auto& sample : trainingData) {
-            auto output = network.forward(sample.first);
-            totalLoss += network.computeLoss(output, sample.second);
             network.train(sample.first, sample.second, learningRate);
         }
         
         // 每500轮显示一次损失
         if (epoch % 500 == 0) {
-            std::cout << "Epoch " << epoch << ", 平均损失: " << totalLoss / trainingData.size() << std::endl;
+            auto evaluation = network.evaluate(trainingData, neural_network::EvaluationMetrics::LOSS);
+            std::cout << "Epoch " << epoch << ", 平均损失: " << evaluation.mean_loss << std::endl;
         }
     }
     
@@ -121,5 +120,28 @@ int main() {
     
     std::cout << "\n准确率: " << (100.0 * correct / trainingData.size()) << "%" << std::endl;
     
+    // 并行评估：混淆矩阵与各类别统计
+    auto evaluation = network.evaluate(trainingData);
+    std::cout << "混淆矩阵 [实际][预测]:" << std::endl;
+    for (const auto& row : evaluation.confusion_matrix) {
+        std::cout << "  " << row[0] << " " << row[1] << std::endl;
+    }
+    for (size_t c = 0; c < evaluation.per_class.size(); c++) {
+        const auto& stats = evaluation.per_class[c];
+        std::cout << "类别 " << c << ": 精确率=" << stats.precision << ", 召回率=" << stats.recall
+                  << ", F1=" << stats.f1 << std::endl;
+    }
+    
+    // 像素网格重复出现，推理缓存可直接返回之前的结果
+    network.enableInferenceCache(1 << 20);
+    for (int round = 0; round < 100; round++) {
+        for (const auto& sample : trainingData) {
+            network.predict(sample.first);
+        }
+    }
+    auto cacheStats = network.getInferenceCacheStats();
+    std::cout << "推理缓存: 命中=" << cacheStats.hits << ", 未命中=" << cacheStats.misses
+              << ", 条目=" << cacheStats.entries << std::endl;
+    
     return 0;
 }
\ No newline at end of file
@@ -35,6 +35,11 @@ int main() {
         {0.0}
     };
     
+    neural_network::Dataset dataset;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        dataset.push_back({inputs[i], targets[i]});
+    }
+    
     std::cout << "训练前的输出:" << std::endl;
     for (size_t i = 0; i < inputs.size(); i++) {
         auto output = network.forward(inputs[i]);
@@ -55,12 +60,8 @@ int main() {
         
         // 每1000轮显示一次损失
         if (epoch % 1000 == 0) {
-            double totalLoss = 0.0;
-            for (size_t i = 0; i < inputs.size(); i++) {
-                auto output = network.forward(inputs[i]);
-                totalLoss += network.computeLoss(output, targets[i]);
-            }
-            std::cout << "Epoch " << epoch << ", Loss: " << totalLoss / inputs.size() << std::endl;
+            auto evaluation = network.evaluate(dataset, neural_network::EvaluationMetrics::LOSS);
+            std::cout << "Epoch " << epoch << ", Loss: " << evaluation.mean_loss << std::endl;
         }
     }
     
@@ -0,0 +1,212 @@
+#include "activation_cache.h"
+#include "tracer.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace neural_network {
+
+namespace {
+
+const uint64_t kActivationCacheMagic = 0x3148435443414e4eull; // "NNACTCH1"
+const uint32_t kActivationCacheVersion = 1;
+
+/**
+ * @brief FNV-1a累加任意字节
+ */
+uint64_t fnv1a(uint64_t hash, const void* data, size_t bytes) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < bytes; i++) {
+        hash ^= p[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+} // namespace
+
+struct ActivationCache::FileHeader {
+    uint64_t magic;          ///< 魔数，数据写完后最后写入
+    uint32_t version;        ///< 格式版本
+    uint32_t reserved;       ///< 保留
+    uint64_t boundary;       ///< 前缀层数
+    uint64_t sample_count;   ///< 样本数
+    uint64_t width;          ///< 每个样本的输出宽度
+    uint64_t checksum;       ///< 前缀校验和
+};
+
+uint64_t ActivationCache::prefixChecksum(const Network& network, size_t boundary) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    std::vector<double> parameters;
+    for (size_t i = 0; i < std::min(boundary, network.getLayerCount()); i++) {
+        auto layer = network.getLayer(i);
+        const std::string type = layer->typeName();
+        const uint64_t shape[2] = {layer->inputSize(), layer->size()};
+        hash = fnv1a(hash, type.data(), type.size());
+        hash = fnv1a(hash, shape, sizeof(shape));
+        
+        parameters.resize(layer->parameterCount());
+        layer->exportParameters(parameters.data());
+        hash = fnv1a(hash, parameters.data(), parameters.size() * sizeof(double));
+        parameters.resize(layer->bufferCount());
+        layer->exportBuffers(parameters.data());
+        hash = fnv1a(hash, parameters.data(), parameters.size() * sizeof(double));
+    }
+    return hash;
+}
+
+std::shared_ptr<ActivationCache> ActivationCache::build(const Network& network, size_t boundary,
+                                                        const Dataset& dataset, const std::string& filename,
+                                                        size_t batchSize) {
+    if (boundary > network.getLayerCount() || network.getLayerCount() == 0) {
+        return nullptr;
+    }
+    NN_TRACE_SCOPE_ARG("io", "ActivationCache::build", "samples", dataset.size());
+    
+    std::shared_ptr<ActivationCache> cache(new ActivationCache());
+    cache->boundary_ = boundary;
+    cache->sample_count_ = dataset.size();
+    cache->width_ = boundary == 0 ? network.getLayer(0)->inputSize() : network.getLayer(boundary - 1)->size();
+    cache->checksum_ = prefixChecksum(network, boundary);
+    const size_t data_bytes = cache->sample_count_ * cache->width_ * sizeof(double);
+    
+    double* data = nullptr;
+    std::string temp_name;
+    int fd = -1;
+    if (filename.empty()) {
+        cache->memory_.resize(cache->sample_count_ * cache->width_);
+        data = cache->memory_.data();
+    } else {
+        // 先写临时文件再原子改名，不会留下不完整的缓存文件
+        temp_name = filename + ".tmp." + std::to_string(getpid());
+        fd = ::open(temp_name.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0644);
+        if (fd < 0) {
+            return nullptr;
+        }
+        cache->mapping_bytes_ = sizeof(FileHeader) + data_bytes;
+        void* base = MAP_FAILED;
+        if (ftruncate(fd, static_cast<off_t>(cache->mapping_bytes_)) == 0) {
+            base = mmap(nullptr, cache->mapping_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (base == MAP_FAILED) {
+            unlink(temp_name.c_str());
+            return nullptr;
+        }
+        cache->mapping_ = base;
+        data = reinterpret_cast<double*>(static_cast<unsigned char*>(base) + sizeof(FileHeader));
+    }
+    
+    // 按批只读推理前缀各层，不触碰训练缓存
+    const size_t batch_size = std::max<size_t>(batchSize, 1);
+    std::vector<std::vector<double>> batch;
+    for (size_t begin = 0; begin < dataset.size(); begin += batch_size) {
+        const size_t end = std::min(dataset.size(), begin + batch_size);
+        batch.clear();
+        for (size_t s = begin; s < end; s++) {
+            batch.push_back(dataset[s].first);
+        }
+        for (size_t i = 0; i < boundary; i++) {
+            batch = network.getLayer(i)->predictBatch(batch);
+        }
+        for (size_t s = begin; s < end; s++) {
+            std::vector<double>& values = batch[s - begin];
+            values.resize(cache->width_, 0.0);
+            std::copy(values.begin(), values.end(), data + s * cache->width_);
+        }
+    }
+    cache->data_ = data;
+    
+    if (cache->mapping_) {
+        auto* header = static_cast<FileHeader*>(cache->mapping_);
+        header->version = kActivationCacheVersion;
+        header->reserved = 0;
+        header->boundary = boundary;
+        header->sample_count = cache->sample_count_;
+        header->width = cache->width_;
+        header->checksum = cache->checksum_;
+        header->magic = kActivationCacheMagic;
+        
+        mprotect(cache->mapping_, cache->mapping_bytes_, PROT_READ);
+        if (msync(cache->mapping_, cache->mapping_bytes_, MS_SYNC) != 0 ||
+            rename(temp_name.c_str(), filename.c_str()) != 0) {
+            unlink(temp_name.c_str());
+            return nullptr;
+        }
+    }
+    return cache;
+}
+
+std::shared_ptr<ActivationCache> ActivationCache::open(const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(FileHeader)) {
+        close(fd);
+        return nullptr;
+    }
+    const size_t bytes = static_cast<size_t>(info.st_size);
+    void* base = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return nullptr;
+    }
+    
+    std::shared_ptr<ActivationCache> cache(new ActivationCache());
+    cache->mapping_ = base;
+    cache->mapping_bytes_ = bytes;
+    
+    const auto* header = static_cast<const FileHeader*>(base);
+    if (header->magic != kActivationCacheMagic || header->version != kActivationCacheVersion ||
+        header->width == 0 || sizeof(FileHeader) + header->sample_count * header->width * sizeof(double) != bytes) {
+        return nullptr;
+    }
+    cache->boundary_ = header->boundary;
+    cache->sample_count_ = header->sample_count;
+    cache->width_ = header->width;
+    cache->checksum_ = header->checksum;
+    cache->data_ = reinterpret_cast<const double*>(static_cast<const unsigned char*>(base) + sizeof(FileHeader));
+    return cache;
+}
+
+ActivationCache::~ActivationCache() {
+    if (mapping_) {
+        munmap(mapping_, mapping_bytes_);
+    }
+}
+
+bool ActivationCache::matches(const Network& network) const {
+    return boundary_ <= network.getLayerCount() && checksum_ == prefixChecksum(network, boundary_);
+}
+
+const double* ActivationCache::row(size_t index) const {
+    return data_ + index * width_;
+}
+
+std::vector<double> ActivationCache::activations(size_t index) const {
+    const double* values = row(index);
+    return std::vector<double>(values, values + width_);
+}
+
+size_t ActivationCache::getBoundary() const {
+    return boundary_;
+}
+
+size_t ActivationCache::getSampleCount() const {
+    return sample_count_;
+}
+
+size_t ActivationCache::getWidth() const {
+    return width_;
+}
+
+bool ActivationCache::isMapped() const {
+    return mapping_ != nullptr;
+}
+
+} // namespace neural_network
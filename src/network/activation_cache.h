@@ -0,0 +1,122 @@
+#ifndef ACTIVATION_CACHE_H
+#define ACTIVATION_CACHE_H
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include "network.h"
+
+namespace neural_network {
+
+/**
+ * @brief 冻结前缀输出缓存
+ *
+ * 对整个数据集计算一次网络前boundary层（冻结前缀）的输出，之后每轮微调用
+ * Network::trainFrom(boundary, ...)只计算可训练的后缀。缓存可以保存在内存中，
+ * 也可以写入文件并以只读方式映射：文件可被之后的微调任务直接打开，数据集
+ * 大于内存时由操作系统按需换页。
+ *
+ * 文件头记录前缀各层参数的校验和，前缀权重改变后matches()返回false。
+ * 缓存的第i行对应构建时数据集的第i个样本。
+ */
+class ActivationCache {
+public:
+    /**
+     * @brief 计算数据集在前boundary层上的输出并缓存
+     * @param network 网络（前boundary层通常已冻结）
+     * @param boundary 冻结前缀的层数，缓存的是第boundary层的输入
+     * @param dataset 数据集（只使用输入）
+     * @param filename 缓存文件路径，为空时缓存在内存中
+     * @param batchSize 批量推理的样本数
+     * @return 缓存，boundary超出层数或写文件失败时返回nullptr
+     */
+    static std::shared_ptr<ActivationCache> build(const Network& network, size_t boundary, const Dataset& dataset,
+                                                  const std::string& filename = "", size_t batchSize = 256);
+    
+    /**
+     * @brief 以只读方式映射已有的缓存文件
+     * @param filename 缓存文件路径
+     * @return 缓存，文件不存在或格式错误时返回nullptr
+     */
+    static std::shared_ptr<ActivationCache> open(const std::string& filename);
+    
+    /**
+     * @brief 计算网络前boundary层的结构和参数校验和
+     * @param network 网络
+     * @param boundary 前缀层数
+     * @return 校验和（FNV-1a）
+     */
+    static uint64_t prefixChecksum(const Network& network, size_t boundary);
+    
+    /**
+     * @brief 析构函数，解除文件映射
+     */
+    ~ActivationCache();
+    
+    ActivationCache(const ActivationCache&) = delete;
+    ActivationCache& operator=(const ActivationCache&) = delete;
+    
+    /**
+     * @brief 缓存是否与网络当前的前缀一致
+     * @param network 网络
+     * @return 是否一致
+     */
+    bool matches(const Network& network) const;
+    
+    /**
+     * @brief 获取第index个样本的前缀输出
+     * @param index 样本索引
+     * @return 指向width个double的指针
+     */
+    const double* row(size_t index) const;
+    
+    /**
+     * @brief 以向量形式获取第index个样本的前缀输出（可直接传给trainFrom）
+     * @param index 样本索引
+     * @return 前缀输出
+     */
+    std::vector<double> activations(size_t index) const;
+    
+    /**
+     * @brief 获取前缀层数
+     * @return 层数
+     */
+    size_t getBoundary() const;
+    
+    /**
+     * @brief 获取样本数
+     * @return 样本数
+     */
+    size_t getSampleCount() const;
+    
+    /**
+     * @brief 获取每个样本的输出宽度
+     * @return 宽度
+     */
+    size_t getWidth() const;
+    
+    /**
+     * @brief 缓存是否来自文件映射
+     * @return 是否映射
+     */
+    bool isMapped() const;
+
+private:
+    struct FileHeader;
+    
+    ActivationCache() = default;
+    
+    size_t boundary_ = 0;              ///< 前缀层数
+    size_t sample_count_ = 0;          ///< 样本数
+    size_t width_ = 0;                 ///< 每个样本的输出宽度
+    uint64_t checksum_ = 0;            ///< 构建时前缀的校验和
+    std::vector<double> memory_;       ///< 内存模式下的数据
+    const double* data_ = nullptr;     ///< 数据起始位置
+    void* mapping_ = nullptr;          ///< 文件映射，内存模式下为空
+    size_t mapping_bytes_ = 0;         ///< 映射大小
+};
+
+} // namespace neural_network
+
+#endif // ACTIVATION_CACHE_H
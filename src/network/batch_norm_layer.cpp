@@ -0,0 +1,330 @@
+#include "batch_norm_layer.h"
+#include "dense_kernel.h"
+#include "tracer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace neural_network {
+
+BatchNormLayer::BatchNormLayer(size_t features, ActivationType activation, double momentum, double epsilon)
+    : Layer(features, features, WeightInitScheme::UNIFORM),
+      features_(features), activation_(activation), momentum_(momentum), epsilon_(epsilon),
+      gamma_(features, 1.0), beta_(features, 0.0), running_mean_(features, 0.0), running_var_(features, 1.0),
+      gamma_gradients_(features, 0.0), beta_gradients_(features, 0.0), batch_inv_std_(features, 1.0),
+      batch_size_(0) {}
+
+void BatchNormLayer::normalizeWithRunningStats(const std::vector<double>& inputs,
+                                               std::vector<double>& outputs) const {
+    outputs.resize(features_);
+    for (size_t f = 0; f < features_; f++) {
+        const double x = f < inputs.size() ? inputs[f] : 0.0;
+        const double normalized = (x - running_mean_[f]) / std::sqrt(running_var_[f] + epsilon_);
+        outputs[f] = applyActivation(activation_, gamma_[f] * normalized + beta_[f]);
+    }
+}
+
+std::vector<double> BatchNormLayer::forward(const std::vector<double>& inputs) {
+    NN_TRACE_SCOPE_ARG("layer", "BatchNormLayer::forward", "features", features_);
+    last_inputs_ = inputs;
+    last_inputs_.resize(features_, 0.0);
+    normalizeWithRunningStats(last_inputs_, last_outputs_);
+    return last_outputs_;
+}
+
+std::vector<std::vector<double>> BatchNormLayer::predictBatch(const std::vector<std::vector<double>>& batch) const {
+    std::vector<std::vector<double>> outputs(batch.size());
+    for (size_t s = 0; s < batch.size(); s++) {
+        normalizeWithRunningStats(batch[s], outputs[s]);
+    }
+    return outputs;
+}
+
+std::vector<double> BatchNormLayer::backward(const std::vector<double>& errors, double gradientScale,
+                                             bool propagateErrors) {
+    NN_TRACE_SCOPE_ARG("layer", "BatchNormLayer::backward", "features", features_);
+    
+    // 逐样本训练时统计量固定，本层是逐特征的仿射变换
+    std::vector<double> prev_errors;
+    if (propagateErrors) {
+        prev_errors.resize(features_, 0.0);
+    }
+    for (size_t f = 0; f < features_; f++) {
+        const double inv_std = 1.0 / std::sqrt(running_var_[f] + epsilon_);
+        const double normalized = (last_inputs_[f] - running_mean_[f]) * inv_std;
+        const double error_term = errors[f] * activationDerivative(activation_, last_outputs_[f]);
+        gamma_gradients_[f] = error_term * normalized / gradientScale;
+        beta_gradients_[f] = error_term / gradientScale;
+        
+        // 激活函数与前面的线性全连接层属于同一个逻辑层，传回的误差包含其导数
+        if (propagateErrors) {
+            prev_errors[f] = error_term * gamma_[f] * inv_std;
+        }
+    }
+    return prev_errors;
+}
+
+std::vector<std::vector<double>> BatchNormLayer::forwardBatch(const std::vector<std::vector<double>>& batch) {
+    const size_t n = batch.size();
+    if (n < 2) {
+        // 单个样本的方差为0，退化为按滑动统计量计算
+        batch_size_ = 0;
+        return Layer::forwardBatch(batch);
+    }
+    NN_TRACE_SCOPE_ARG("layer", "BatchNormLayer::forwardBatch", "samples", n);
+    
+    batch_size_ = n;
+    batch_normalized_.resize(n * features_);
+    batch_outputs_.resize(n * features_);
+    std::vector<std::vector<double>> outputs(n, std::vector<double>(features_));
+    
+    // 与forward、predictBatch一致，不足特征数的样本按0补齐
+    auto input = [&batch](size_t s, size_t f) { return f < batch[s].size() ? batch[s][f] : 0.0; };
+    for (size_t f = 0; f < features_; f++) {
+        double mean = 0.0;
+        for (size_t s = 0; s < n; s++) {
+            mean += input(s, f);
+        }
+        mean /= static_cast<double>(n);
+        double variance = 0.0;
+        for (size_t s = 0; s < n; s++) {
+            const double centered = input(s, f) - mean;
+            variance += centered * centered;
+        }
+        
+        // 归一化使用有偏方差，滑动方差使用无偏估计
+        const double biased = variance / static_cast<double>(n);
+        const double unbiased = variance / static_cast<double>(n - 1);
+        running_mean_[f] = momentum_ * running_mean_[f] + (1.0 - momentum_) * mean;
+        running_var_[f] = momentum_ * running_var_[f] + (1.0 - momentum_) * unbiased;
+        
+        const double inv_std = 1.0 / std::sqrt(biased + epsilon_);
+        batch_inv_std_[f] = inv_std;
+        for (size_t s = 0; s < n; s++) {
+            const double normalized = (input(s, f) - mean) * inv_std;
+            const double output = applyActivation(activation_, gamma_[f] * normalized + beta_[f]);
+            batch_normalized_[s * features_ + f] = normalized;
+            batch_outputs_[s * features_ + f] = output;
+            outputs[s][f] = output;
+        }
+    }
+    return outputs;
+}
+
+std::vector<std::vector<double>> BatchNormLayer::backwardBatch(const std::vector<std::vector<double>>& errors,
+                                                               bool propagateErrors) {
+    if (batch_size_ == 0) {
+        return Layer::backwardBatch(errors, propagateErrors);
+    }
+    const size_t n = std::min(batch_size_, errors.size());
+    NN_TRACE_SCOPE_ARG("layer", "BatchNormLayer::backwardBatch", "samples", n);
+    
+    std::vector<std::vector<double>> prev_errors;
+    if (propagateErrors) {
+        prev_errors.assign(n, std::vector<double>(features_, 0.0));
+    }
+    std::vector<double> error_terms(n);
+    const double count = static_cast<double>(n);
+    for (size_t f = 0; f < features_; f++) {
+        double sum = 0.0;
+        double weighted_sum = 0.0;
+        for (size_t s = 0; s < n; s++) {
+            error_terms[s] = errors[s][f] * activationDerivative(activation_, batch_outputs_[s * features_ + f]);
+            sum += error_terms[s];
+            weighted_sum += error_terms[s] * batch_normalized_[s * features_ + f];
+        }
+        
+        // 与其他层的批量反向传播一致，记录整批的平均梯度
+        gamma_gradients_[f] = weighted_sum / count;
+        beta_gradients_[f] = sum / count;
+        
+        // 均值和方差依赖整批输入：dx = gamma / (n * std) * (n * g - sum(g) - x̂ * sum(g * x̂))
+        if (propagateErrors) {
+            const double factor = gamma_[f] * batch_inv_std_[f] / count;
+            for (size_t s = 0; s < n; s++) {
+                prev_errors[s][f] = factor * (count * error_terms[s] - sum -
+                                              batch_normalized_[s * features_ + f] * weighted_sum);
+            }
+        }
+    }
+    batch_size_ = 0;
+    return prev_errors;
+}
+
+void BatchNormLayer::updateWeights(double learningRate) {
+    for (size_t f = 0; f < features_; f++) {
+        gamma_[f] -= learningRate * gamma_gradients_[f];
+        beta_[f] -= learningRate * beta_gradients_[f];
+    }
+}
+
+size_t BatchNormLayer::parameterCount() const {
+    return 2 * features_;
+}
+
+void BatchNormLayer::exportParameters(double* out) const {
+    out = std::copy(gamma_.begin(), gamma_.end(), out);
+    std::copy(beta_.begin(), beta_.end(), out);
+}
+
+void BatchNormLayer::importParameters(const double* in) {
+    std::copy(in, in + features_, gamma_.begin());
+    std::copy(in + features_, in + 2 * features_, beta_.begin());
+}
+
+void BatchNormLayer::exportGradients(double* out) const {
+    out = std::copy(gamma_gradients_.begin(), gamma_gradients_.end(), out);
+    std::copy(beta_gradients_.begin(), beta_gradients_.end(), out);
+}
+
+void BatchNormLayer::importGradients(const double* in) {
+    std::copy(in, in + features_, gamma_gradients_.begin());
+    std::copy(in + features_, in + 2 * features_, beta_gradients_.begin());
+}
+
+size_t BatchNormLayer::bufferCount() const {
+    return 2 * features_;
+}
+
+void BatchNormLayer::exportBuffers(double* out) const {
+    out = std::copy(running_mean_.begin(), running_mean_.end(), out);
+    std::copy(running_var_.begin(), running_var_.end(), out);
+}
+
+void BatchNormLayer::importBuffers(const double* in) {
+    std::copy(in, in + features_, running_mean_.begin());
+    std::copy(in + features_, in + 2 * features_, running_var_.begin());
+}
+
+double BatchNormLayer::outputDerivative(size_t /*index*/, double output) const {
+    return activationDerivative(activation_, output);
+}
+
+size_t BatchNormLayer::size() const {
+    return features_;
+}
+
+std::string BatchNormLayer::typeName() const {
+    return "batchnorm";
+}
+
+void BatchNormLayer::save(std::ostream& out, PrecisionType precision) const {
+    auto convert = [precision](double value) {
+        return precision == PrecisionType::BFLOAT16 ? roundToBFloat16(value) : value;
+    };
+    
+    out << typeName() << " " << features_ << " " << activationName(activation_) << " " << momentum_ << " "
+        << epsilon_ << std::endl;
+    
+    // gamma、beta、滑动均值、滑动方差各占一行
+    for (const auto* values : {&gamma_, &beta_, &running_mean_, &running_var_}) {
+        for (size_t f = 0; f < features_; f++) {
+            out << convert((*values)[f]);
+            if (f < features_ - 1) {
+                out << " ";
+            }
+        }
+        out << std::endl;
+    }
+}
+
+bool BatchNormLayer::loadParameters(std::istream& in) {
+    for (auto* values : {&gamma_, &beta_, &running_mean_, &running_var_}) {
+        for (size_t f = 0; f < features_; f++) {
+            in >> (*values)[f];
+        }
+    }
+    return !in.fail();
+}
+
+LayerMemoryUsage BatchNormLayer::memoryUsage() const {
+    // 推理需要gamma、beta和滑动统计量（折叠后为0）
+    LayerMemoryUsage usage;
+    usage.type = typeName();
+    usage.parameter_bytes = (parameterCount() + bufferCount()) * sizeof(double);
+    usage.overhead_bytes = sizeof(BatchNormLayer) + cacheBytes() +
+                           (gamma_.capacity() + beta_.capacity() + running_mean_.capacity() +
+                            running_var_.capacity() - parameterCount() - bufferCount()) * sizeof(double) +
+                           (gamma_gradients_.capacity() + beta_gradients_.capacity() + batch_normalized_.capacity() +
+                            batch_outputs_.capacity() + batch_inv_std_.capacity()) * sizeof(double);
+    return usage;
+}
+
+std::shared_ptr<BatchNormLayer> BatchNormLayer::fromHeader(std::istream& in) {
+    size_t features;
+    std::string activation_name;
+    double momentum, epsilon;
+    in >> features >> activation_name >> momentum >> epsilon;
+    ActivationType activation;
+    if (in.fail() || !parseActivation(activation_name, activation)) {
+        return nullptr;
+    }
+    return std::make_shared<BatchNormLayer>(features, activation, momentum, epsilon);
+}
+
+void BatchNormLayer::initializeWeights(WeightInitScheme scheme, uint64_t /*seed*/) {
+    // 批归一化的初始值是确定的：恒等缩放、零平移、标准统计量
+    init_scheme_ = scheme;
+    std::fill(gamma_.begin(), gamma_.end(), 1.0);
+    std::fill(beta_.begin(), beta_.end(), 0.0);
+    std::fill(running_mean_.begin(), running_mean_.end(), 0.0);
+    std::fill(running_var_.begin(), running_var_.end(), 1.0);
+}
+
+void BatchNormLayer::setPrecision(PrecisionType /*precision*/) {
+    // 逐特征的缩放和平移始终以double计算
+}
+
+std::string BatchNormLayer::kernelShapeKey() const {
+    return "";
+}
+
+std::vector<KernelConfig> BatchNormLayer::kernelCandidates(size_t /*maxThreads*/) const {
+    return {};
+}
+
+bool BatchNormLayer::foldInto(Layer& dense) const {
+    if (dense.typeName() != "dense" || dense.size() != features_) {
+        return false;
+    }
+    const auto& neurons = dense.getNeurons();
+    for (const auto& neuron : neurons) {
+        if (neuron->getActivationType() != ActivationType::LINEAR) {
+            return false;
+        }
+    }
+    
+    for (size_t j = 0; j < features_; j++) {
+        const double scale = gamma_[j] / std::sqrt(running_var_[j] + epsilon_);
+        std::vector<double> weights = neurons[j]->getWeights();
+        for (auto& weight : weights) {
+            weight *= scale;
+        }
+        neurons[j]->setWeights(weights);
+        neurons[j]->setBias((neurons[j]->getBias() - running_mean_[j]) * scale + beta_[j]);
+        neurons[j]->setActivationFunction(activation_);
+    }
+    dense.syncPackedWeights();
+    return true;
+}
+
+ActivationType BatchNormLayer::getActivation() const {
+    return activation_;
+}
+
+const std::vector<double>& BatchNormLayer::getGamma() const {
+    return gamma_;
+}
+
+const std::vector<double>& BatchNormLayer::getBeta() const {
+    return beta_;
+}
+
+const std::vector<double>& BatchNormLayer::getRunningMean() const {
+    return running_mean_;
+}
+
+const std::vector<double>& BatchNormLayer::getRunningVariance() const {
+    return running_var_;
+}
+
+} // namespace neural_network
@@ -0,0 +1,140 @@
+#ifndef BATCH_NORM_LAYER_H
+#define BATCH_NORM_LAYER_H
+
+#include <vector>
+#include <memory>
+#include <string>
+#include "layer.h"
+
+namespace neural_network {
+
+/**
+ * @brief 批归一化层
+ *
+ * 对每个特征做 y = act(gamma * (x - mean) / sqrt(var + epsilon) + beta)。
+ * 通常接在线性激活的全连接层之后，并把原本的激活函数放到本层：
+ * Layer(线性) -> BatchNormLayer(sigmoid) 等价于一个带批归一化的sigmoid全连接层，
+ * 推理时可以用Network::foldBatchNorm把两层合并为一个全连接层，没有额外开销。
+ *
+ * Network::trainBatch（forwardBatch/backwardBatch）使用整批的均值和方差，
+ * 并以动量更新滑动统计量；predict、predictBatch以及逐样本的train/computeGradients
+ * 使用滑动统计量，此时本层是固定的仿射变换，只学习gamma和beta。
+ *
+ * 参数只包含gamma和beta；滑动均值和滑动方差作为状态量（bufferCount/exportBuffers）单独导出，
+ * 不计入参数量和梯度，随模型复制、保存，数据并行和分布式训练时从主网络同步。
+ * 逐样本路径（train、DataParallelTrainer、DistributedTrainer）不更新滑动统计量，
+ * 需要先用trainBatch估计统计量。
+ */
+class BatchNormLayer : public Layer {
+public:
+    /**
+     * @brief 构造函数
+     * @param features 特征数（输入数等于输出数）
+     * @param activation 归一化之后的激活函数
+     * @param momentum 滑动统计量的动量（新值 = momentum * 旧值 + (1 - momentum) * 批统计量）
+     * @param epsilon 方差的数值稳定项
+     */
+    explicit BatchNormLayer(size_t features, ActivationType activation = ActivationType::LINEAR,
+                            double momentum = 0.9, double epsilon = 1e-5);
+    
+    std::vector<double> forward(const std::vector<double>& inputs) override;
+    std::vector<std::vector<double>> predictBatch(const std::vector<std::vector<double>>& batch) const override;
+    std::vector<double> backward(const std::vector<double>& errors, double gradientScale = 1.0,
+                                 bool propagateErrors = true) override;
+    std::vector<std::vector<double>> forwardBatch(const std::vector<std::vector<double>>& batch) override;
+    std::vector<std::vector<double>> backwardBatch(const std::vector<std::vector<double>>& errors,
+                                                   bool propagateErrors = true) override;
+    void updateWeights(double learningRate) override;
+    size_t parameterCount() const override;
+    void exportParameters(double* out) const override;
+    void importParameters(const double* in) override;
+    void exportGradients(double* out) const override;
+    void importGradients(const double* in) override;
+    size_t bufferCount() const override;
+    void exportBuffers(double* out) const override;
+    void importBuffers(const double* in) override;
+    double outputDerivative(size_t index, double output) const override;
+    size_t size() const override;
+    std::string typeName() const override;
+    void save(std::ostream& out, PrecisionType precision) const override;
+    bool loadParameters(std::istream& in) override;
+    LayerMemoryUsage memoryUsage() const override;
+    void initializeWeights(WeightInitScheme scheme, uint64_t seed) override;
+    void setPrecision(PrecisionType precision) override;
+    std::string kernelShapeKey() const override;
+    std::vector<KernelConfig> kernelCandidates(size_t maxThreads) const override;
+    
+    /**
+     * @brief 从模型文件的层描述行创建批归一化层（类型名已读取）
+     * @param in 输入流
+     * @return 批归一化层，格式错误时返回nullptr
+     */
+    static std::shared_ptr<BatchNormLayer> fromHeader(std::istream& in);
+    
+    /**
+     * @brief 把本层（按滑动统计量）的缩放和平移折叠进前面的全连接层
+     *
+     * W'[j] = W[j] * s[j]，b'[j] = (b[j] - mean[j]) * s[j] + beta[j]，其中 s = gamma / sqrt(var + epsilon)；
+     * 折叠后全连接层使用本层的激活函数。
+     * @param dense 前一层，必须是全部神经元为线性激活、输出数等于特征数的全连接层
+     * @return 前一层不满足条件时返回false且不做修改
+     */
+    bool foldInto(Layer& dense) const;
+    
+    /**
+     * @brief 获取激活函数类型
+     * @return 激活函数类型
+     */
+    ActivationType getActivation() const;
+    
+    /**
+     * @brief 获取缩放系数gamma
+     * @return gamma
+     */
+    const std::vector<double>& getGamma() const;
+    
+    /**
+     * @brief 获取平移系数beta
+     * @return beta
+     */
+    const std::vector<double>& getBeta() const;
+    
+    /**
+     * @brief 获取滑动均值
+     * @return 滑动均值
+     */
+    const std::vector<double>& getRunningMean() const;
+    
+    /**
+     * @brief 获取滑动方差
+     * @return 滑动方差
+     */
+    const std::vector<double>& getRunningVariance() const;
+
+private:
+    size_t features_;                           ///< 特征数
+    ActivationType activation_;                 ///< 激活函数类型
+    double momentum_;                           ///< 滑动统计量的动量
+    double epsilon_;                            ///< 方差的数值稳定项
+    std::vector<double> gamma_;                 ///< 缩放系数
+    std::vector<double> beta_;                  ///< 平移系数
+    std::vector<double> running_mean_;          ///< 滑动均值
+    std::vector<double> running_var_;           ///< 滑动方差
+    std::vector<double> gamma_gradients_;       ///< 缩放系数梯度
+    std::vector<double> beta_gradients_;        ///< 平移系数梯度
+    std::vector<double> batch_normalized_;      ///< 最近一批的归一化值（样本 x 特征）
+    std::vector<double> batch_outputs_;         ///< 最近一批的输出（样本 x 特征）
+    std::vector<double> batch_inv_std_;         ///< 最近一批每个特征的1 / sqrt(var + epsilon)
+    size_t batch_size_;                         ///< 最近一批的样本数，0表示没有待反向传播的批次
+    
+    /**
+     * @brief 用滑动统计量计算一个样本
+     * @param inputs 输入
+     * @param outputs 输出
+     */
+    void normalizeWithRunningStats(const std::vector<double>& inputs, std::vector<double>& outputs) const;
+};
+
+} // namespace neural_network
+
+#endif // BATCH_NORM_LAYER_H
@@ -0,0 +1,78 @@
+#ifndef BFLOAT16_H
+#define BFLOAT16_H
+
+#include <cstdint>
+#include <cstring>
+
+namespace neural_network {
+
+/**
+ * @brief 数值存储精度枚举
+ */
+enum class PrecisionType {
+    FLOAT64,
+    BFLOAT16
+};
+
+/**
+ * @brief bfloat16数值类型（软件模拟）
+ * 
+ * 保留float32的高16位：1位符号、8位指数、7位尾数。
+ * 与float32指数范围相同，因此转换时只损失尾数精度。
+ */
+struct BFloat16 {
+    uint16_t bits = 0;  ///< 原始位模式
+    
+    /**
+     * @brief 从float转换（就近舍入到偶数）
+     * @param value float值
+     * @return bfloat16值
+     */
+    static BFloat16 fromFloat(float value) {
+        uint32_t raw;
+        std::memcpy(&raw, &value, sizeof(raw));
+        
+        BFloat16 result;
+        if ((raw & 0x7f800000u) == 0x7f800000u && (raw & 0x007fffffu) != 0) {
+            // NaN：保持为静默NaN，避免舍入后变成无穷大
+            result.bits = static_cast<uint16_t>((raw >> 16) | 0x0040u);
+            return result;
+        }
+        uint32_t rounding_bias = 0x7fffu + ((raw >> 16) & 1u);
+        result.bits = static_cast<uint16_t>((raw + rounding_bias) >> 16);
+        return result;
+    }
+    
+    /**
+     * @brief 从double转换
+     * @param value double值
+     * @return bfloat16值
+     */
+    static BFloat16 fromDouble(double value) {
+        return fromFloat(static_cast<float>(value));
+    }
+    
+    /**
+     * @brief 转换为float（无损）
+     * @return float值
+     */
+    float toFloat() const {
+        uint32_t raw = static_cast<uint32_t>(bits) << 16;
+        float value;
+        std::memcpy(&value, &raw, sizeof(value));
+        return value;
+    }
+};
+
+/**
+ * @brief 将double舍入到bfloat16可表示的最近值
+ * @param value 原始值
+ * @return 舍入后的值
+ */
+inline double roundToBFloat16(double value) {
+    return BFloat16::fromDouble(value).toFloat();
+}
+
+} // namespace neural_network
+
+#endif // BFLOAT16_H
@@ -0,0 +1,359 @@
+#include "binary_layer.h"
+#include "tracer.h"
+#include "../neuron/philox.h"
+#include <algorithm>
+#include <cmath>
+
+namespace neural_network {
+
+namespace {
+
+const size_t kWordBits = 64;            ///< 每个打包字的位数
+const double kInputThreshold = 0.5;     ///< 大于该值的输入视为+1
+
+/**
+ * @brief 计算64位整数中1的个数
+ */
+inline size_t popcount64(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<size_t>(__builtin_popcountll(value));
+#else
+    value = value - ((value >> 1) & 0x5555555555555555ULL);
+    value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+    value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<size_t>((value * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+using XorPopcountKernel = size_t (*)(const uint64_t*, const uint64_t*, size_t);
+
+/**
+ * @brief 两个位串异或后1的个数（不一致的位数）
+ */
+size_t xorPopcount(const uint64_t* a, const uint64_t* b, size_t words) {
+    size_t count = 0;
+    for (size_t w = 0; w < words; w++) {
+        count += popcount64(a[w] ^ b[w]);
+    }
+    return count;
+}
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+/**
+ * @brief 使用popcnt指令的版本（默认编译选项下__builtin_popcountll展开为查表）
+ */
+__attribute__((target("popcnt")))
+size_t xorPopcountHardware(const uint64_t* a, const uint64_t* b, size_t words) {
+    size_t count = 0;
+    for (size_t w = 0; w < words; w++) {
+        count += static_cast<size_t>(__builtin_popcountll(a[w] ^ b[w]));
+    }
+    return count;
+}
+#endif
+
+/**
+ * @brief 按CPU支持情况选择计数内核（只选择一次）
+ */
+XorPopcountKernel xorPopcountKernel() {
+    static const XorPopcountKernel kernel = []() -> XorPopcountKernel {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+        if (__builtin_cpu_supports("popcnt")) {
+            return xorPopcountHardware;
+        }
+#endif
+        return xorPopcount;
+    }();
+    return kernel;
+}
+
+/**
+ * @brief 直通估计的导数：|z| <= 1时为0.5（0/1输出对应hard-tanh的一半）
+ */
+inline double straightThroughDerivative(double z) {
+    return std::fabs(z) <= 1.0 ? 0.5 : 0.0;
+}
+
+} // namespace
+
+BinaryLayer::BinaryLayer(size_t numNeurons, size_t numInputs)
+    : Layer(0, numInputs, WeightInitScheme::UNIFORM),
+      num_neurons_(numNeurons), words_per_row_((numInputs + kWordBits - 1) / kWordBits),
+      scale_(1.0 / std::sqrt(static_cast<double>(std::max<size_t>(numInputs, 1)))),
+      weights_(numNeurons * numInputs), biases_(numNeurons, 0.0),
+      weight_gradients_(weights_.size(), 0.0), bias_gradients_(numNeurons, 0.0),
+      packed_weights_(numNeurons * words_per_row_, 0), thresholds_(numNeurons, 0) {
+    last_outputs_.resize(numNeurons);
+    
+    // 与神经元的默认初始化保持一致：[-0.5, 0.5]均匀分布
+    initializeWeights(WeightInitScheme::UNIFORM, Neuron::deriveInitSeed());
+}
+
+std::vector<double> BinaryLayer::forward(const std::vector<double>& inputs) {
+    NN_TRACE_SCOPE_ARG("layer", "BinaryLayer::forward", "neurons", num_neurons_);
+    last_inputs_ = inputs;
+    last_inputs_.resize(num_inputs_, 0.0);
+    
+    std::vector<uint64_t> packed(words_per_row_);
+    packInputs(last_inputs_, packed.data());
+    computeOutputs(packed.data(), last_outputs_);
+    return last_outputs_;
+}
+
+std::vector<std::vector<double>> BinaryLayer::predictBatch(const std::vector<std::vector<double>>& batch) const {
+    std::vector<std::vector<double>> outputs(batch.size());
+    std::vector<uint64_t> packed(words_per_row_);
+    for (size_t s = 0; s < batch.size(); s++) {
+        packInputs(batch[s], packed.data());
+        computeOutputs(packed.data(), outputs[s]);
+    }
+    return outputs;
+}
+
+void BinaryLayer::packInputs(const std::vector<double>& inputs, uint64_t* packed) const {
+    std::fill(packed, packed + words_per_row_, 0);
+    const size_t count = std::min(inputs.size(), num_inputs_);
+    for (size_t i = 0; i < count; i++) {
+        if (inputs[i] > kInputThreshold) {
+            packed[i / kWordBits] |= uint64_t(1) << (i % kWordBits);
+        }
+    }
+}
+
+void BinaryLayer::computeOutputs(const uint64_t* packed, std::vector<double>& outputs) const {
+    outputs.resize(num_neurons_);
+    for (size_t j = 0; j < num_neurons_; j++) {
+        outputs[j] = binaryDot(packed, j) >= thresholds_[j] ? 1.0 : 0.0;
+    }
+}
+
+int64_t BinaryLayer::binaryDot(const uint64_t* packed, size_t neuron) const {
+    // 补齐的位在输入和权重中都是0，异或后不计入不一致位数
+    const int64_t mismatches = static_cast<int64_t>(
+        xorPopcountKernel()(packed, packed_weights_.data() + neuron * words_per_row_, words_per_row_));
+    return static_cast<int64_t>(num_inputs_) - 2 * mismatches;
+}
+
+std::vector<double> BinaryLayer::backward(const std::vector<double>& errors, double gradientScale,
+                                          bool propagateErrors) {
+    NN_TRACE_SCOPE_ARG("layer", "BinaryLayer::backward", "neurons", num_neurons_);
+    
+    // 前向使用的二值输入；z由缓存的输入重新计算，不依赖最近一次前向
+    std::vector<double> signs(num_inputs_);
+    for (size_t i = 0; i < num_inputs_; i++) {
+        signs[i] = last_inputs_[i] > kInputThreshold ? 1.0 : -1.0;
+    }
+    std::vector<uint64_t> packed(words_per_row_);
+    packInputs(last_inputs_, packed.data());
+    
+    std::vector<double> prev_errors;
+    if (propagateErrors) {
+        prev_errors.resize(num_inputs_, 0.0);
+    }
+    
+    for (size_t j = 0; j < num_neurons_; j++) {
+        const double z = static_cast<double>(binaryDot(packed.data(), j)) * scale_ + biases_[j];
+        const double error_term = errors[j] * straightThroughDerivative(z);
+        bias_gradients_[j] = error_term / gradientScale;
+        
+        // 梯度直接作用于潜在权重（符号函数的导数按1处理）
+        const double weight_term = error_term * scale_ / gradientScale;
+        double* gradients = weight_gradients_.data() + j * num_inputs_;
+        for (size_t i = 0; i < num_inputs_; i++) {
+            gradients[i] = weight_term * signs[i];
+        }
+        
+        // 与全连接层相同，按前向实际使用的（二值）权重把误差分配到输入
+        if (propagateErrors) {
+            const double* weights = weights_.data() + j * num_inputs_;
+            const double scaled_error = errors[j] * scale_;
+            for (size_t i = 0; i < num_inputs_; i++) {
+                prev_errors[i] += weights[i] >= 0.0 ? scaled_error : -scaled_error;
+            }
+        }
+    }
+    return prev_errors;
+}
+
+void BinaryLayer::updateWeights(double learningRate) {
+    // 潜在权重截断到[-1, 1]，避免远离0后符号再也无法翻转
+    for (size_t i = 0; i < weights_.size(); i++) {
+        weights_[i] = std::max(-1.0, std::min(1.0, weights_[i] - learningRate * weight_gradients_[i]));
+    }
+    for (size_t j = 0; j < num_neurons_; j++) {
+        biases_[j] -= learningRate * bias_gradients_[j];
+    }
+    repack();
+}
+
+void BinaryLayer::repack() {
+    std::fill(packed_weights_.begin(), packed_weights_.end(), 0);
+    const double root_n = std::sqrt(static_cast<double>(std::max<size_t>(num_inputs_, 1)));
+    const double limit = static_cast<double>(num_inputs_) + 1.0;
+    
+    for (size_t j = 0; j < num_neurons_; j++) {
+        const double* weights = weights_.data() + j * num_inputs_;
+        uint64_t* row = packed_weights_.data() + j * words_per_row_;
+        for (size_t i = 0; i < num_inputs_; i++) {
+            if (weights[i] >= 0.0) {
+                row[i / kWordBits] |= uint64_t(1) << (i % kWordBits);
+            }
+        }
+        
+        // 点积 * scale + 偏置 >= 0  <=>  点积 >= ceil(-偏置 * sqrt(n))
+        const double threshold = std::ceil(-biases_[j] * root_n);
+        thresholds_[j] = static_cast<int64_t>(std::max(-limit, std::min(limit, threshold)));
+    }
+}
+
+size_t BinaryLayer::parameterCount() const {
+    return weights_.size() + biases_.size();
+}
+
+void BinaryLayer::exportParameters(double* out) const {
+    out = std::copy(weights_.begin(), weights_.end(), out);
+    std::copy(biases_.begin(), biases_.end(), out);
+}
+
+void BinaryLayer::importParameters(const double* in) {
+    std::copy(in, in + weights_.size(), weights_.begin());
+    std::copy(in + weights_.size(), in + weights_.size() + biases_.size(), biases_.begin());
+    repack();
+}
+
+void BinaryLayer::exportGradients(double* out) const {
+    out = std::copy(weight_gradients_.begin(), weight_gradients_.end(), out);
+    std::copy(bias_gradients_.begin(), bias_gradients_.end(), out);
+}
+
+void BinaryLayer::importGradients(const double* in) {
+    std::copy(in, in + weight_gradients_.size(), weight_gradients_.begin());
+    std::copy(in + weight_gradients_.size(), in + weight_gradients_.size() + bias_gradients_.size(),
+              bias_gradients_.begin());
+}
+
+double BinaryLayer::outputDerivative(size_t index, double /*output*/) const {
+    // 0/1输出无法反推z，由当前缓存的输入重新计算
+    if (index >= num_neurons_ || last_inputs_.size() != num_inputs_) {
+        return 0.0;
+    }
+    std::vector<uint64_t> packed(words_per_row_);
+    packInputs(last_inputs_, packed.data());
+    return straightThroughDerivative(static_cast<double>(binaryDot(packed.data(), index)) * scale_ + biases_[index]);
+}
+
+size_t BinaryLayer::size() const {
+    return num_neurons_;
+}
+
+std::string BinaryLayer::typeName() const {
+    return "binary";
+}
+
+void BinaryLayer::save(std::ostream& out, PrecisionType precision) const {
+    auto convert = [precision](double value) {
+        return precision == PrecisionType::BFLOAT16 ? roundToBFloat16(value) : value;
+    };
+    
+    out << typeName() << " " << num_neurons_ << " " << num_inputs_ << std::endl;
+    
+    // 保存潜在权重以便继续训练；每个神经元一行偏置、一行权重
+    for (size_t j = 0; j < num_neurons_; j++) {
+        out << convert(biases_[j]) << std::endl;
+        for (size_t i = 0; i < num_inputs_; i++) {
+            out << convert(weights_[j * num_inputs_ + i]);
+            if (i < num_inputs_ - 1) {
+                out << " ";
+            }
+        }
+        out << std::endl;
+    }
+}
+
+bool BinaryLayer::loadParameters(std::istream& in) {
+    for (size_t j = 0; j < num_neurons_; j++) {
+        in >> biases_[j];
+        for (size_t i = 0; i < num_inputs_; i++) {
+            in >> weights_[j * num_inputs_ + i];
+        }
+    }
+    repack();
+    return !in.fail();
+}
+
+size_t BinaryLayer::packedBytes() const {
+    return packed_weights_.size() * sizeof(uint64_t) + thresholds_.size() * sizeof(int64_t);
+}
+
+LayerMemoryUsage BinaryLayer::memoryUsage() const {
+    // 参数按推理实际使用的打包形式计算，潜在权重和偏置属于训练状态
+    LayerMemoryUsage usage;
+    usage.type = typeName();
+    usage.parameter_bytes = packedBytes();
+    usage.overhead_bytes = sizeof(BinaryLayer) + cacheBytes() +
+                           (weights_.capacity() + biases_.capacity() + weight_gradients_.capacity() +
+                            bias_gradients_.capacity()) * sizeof(double) +
+                           (packed_weights_.capacity() - packed_weights_.size()) * sizeof(uint64_t) +
+                           (thresholds_.capacity() - thresholds_.size()) * sizeof(int64_t);
+    return usage;
+}
+
+std::shared_ptr<BinaryLayer> BinaryLayer::fromHeader(std::istream& in) {
+    size_t neuron_count, input_count;
+    in >> neuron_count >> input_count;
+    if (in.fail()) {
+        return nullptr;
+    }
+    return std::make_shared<BinaryLayer>(neuron_count, input_count);
+}
+
+void BinaryLayer::initializeWeights(WeightInitScheme scheme, uint64_t seed) {
+    init_scheme_ = scheme;
+    
+    // 潜在权重只用其符号，幅度决定翻转所需的更新量；XAVIER/HE按扇入缩小范围
+    double limit = 0.5;
+    if (scheme == WeightInitScheme::XAVIER) {
+        limit = std::min(1.0, std::sqrt(6.0 / static_cast<double>(std::max<size_t>(num_inputs_ + num_neurons_, 1))));
+    } else if (scheme == WeightInitScheme::HE) {
+        limit = std::min(1.0, std::sqrt(6.0 / static_cast<double>(std::max<size_t>(num_inputs_, 1))));
+    }
+    
+    // 每个神经元占一个Philox流：前numInputs个值为权重，最后一个为偏置
+    std::vector<double> values(num_inputs_ + 1);
+    for (size_t j = 0; j < num_neurons_; j++) {
+        philoxFillUniform(seed, j, values.data(), values.size(), -limit, limit);
+        std::copy(values.begin(), values.begin() + num_inputs_, weights_.begin() + j * num_inputs_);
+        biases_[j] = scheme == WeightInitScheme::UNIFORM ? values[num_inputs_] : 0.0;
+    }
+    repack();
+}
+
+void BinaryLayer::setPrecision(PrecisionType /*precision*/) {
+    // 推理始终使用打包的符号位，潜在权重以double存储
+}
+
+std::string BinaryLayer::kernelShapeKey() const {
+    // XNOR-popcount只有一种实现，不参与调优
+    return "";
+}
+
+std::vector<KernelConfig> BinaryLayer::kernelCandidates(size_t /*maxThreads*/) const {
+    return {};
+}
+
+const std::vector<double>& BinaryLayer::getWeights() const {
+    return weights_;
+}
+
+void BinaryLayer::setWeights(const std::vector<double>& weights) {
+    if (weights.size() == weights_.size()) {
+        weights_ = weights;
+        repack();
+    }
+}
+
+const std::vector<double>& BinaryLayer::getBiases() const {
+    return biases_;
+}
+
+} // namespace neural_network
@@ -0,0 +1,127 @@
+#ifndef BINARY_LAYER_H
+#define BINARY_LAYER_H
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include "layer.h"
+
+namespace neural_network {
+
+/**
+ * @brief 二值化全连接层（XNOR-popcount）
+ *
+ * 输入按阈值0.5二值化（大于0.5视为+1，否则视为-1），适合0/1像素这类输入，
+ * 也可直接接在另一个二值层或sigmoid层之后；权重取潜在实值权重的符号。
+ * 输入和权重各按64位一个字打包，点积为 n - 2·popcount(x XOR w)（即XNOR计数），
+ * 与偏置换算出的整数阈值比较后输出0或1。推理时每个权重只占1位，是double的1/64。
+ *
+ * 训练使用直通估计（STE）：前向使用二值权重和激活，反向把梯度直接传给潜在
+ * 实值权重。记 z = 点积 / sqrt(n) + 偏置，输出对z的导数在|z| <= 1时取0.5、
+ * 否则为0（hard-tanh近似）；潜在权重更新后截断到[-1, 1]。z在反向传播时由缓存的输入重新计算，
+ * 因此取出和放回缓存（批量训练、流水线训练）后每个样本使用自己的z。
+ */
+class BinaryLayer : public Layer {
+public:
+    /**
+     * @brief 构造函数
+     * @param numNeurons 神经元数量
+     * @param numInputs 输入数量
+     */
+    BinaryLayer(size_t numNeurons, size_t numInputs);
+    
+    std::vector<double> forward(const std::vector<double>& inputs) override;
+    std::vector<std::vector<double>> predictBatch(const std::vector<std::vector<double>>& batch) const override;
+    std::vector<double> backward(const std::vector<double>& errors, double gradientScale = 1.0,
+                                 bool propagateErrors = true) override;
+    void updateWeights(double learningRate) override;
+    size_t parameterCount() const override;
+    void exportParameters(double* out) const override;
+    void importParameters(const double* in) override;
+    void exportGradients(double* out) const override;
+    void importGradients(const double* in) override;
+    double outputDerivative(size_t index, double output) const override;
+    size_t size() const override;
+    std::string typeName() const override;
+    void save(std::ostream& out, PrecisionType precision) const override;
+    bool loadParameters(std::istream& in) override;
+    LayerMemoryUsage memoryUsage() const override;
+    void initializeWeights(WeightInitScheme scheme, uint64_t seed) override;
+    void setPrecision(PrecisionType precision) override;
+    std::string kernelShapeKey() const override;
+    std::vector<KernelConfig> kernelCandidates(size_t maxThreads) const override;
+    
+    /**
+     * @brief 从模型文件的层描述行创建二值层（类型名已读取）
+     * @param in 输入流
+     * @return 二值层，格式错误时返回nullptr
+     */
+    static std::shared_ptr<BinaryLayer> fromHeader(std::istream& in);
+    
+    /**
+     * @brief 获取潜在实值权重（按神经元连续存放）
+     * @return 权重
+     */
+    const std::vector<double>& getWeights() const;
+    
+    /**
+     * @brief 设置潜在实值权重并重新打包
+     * @param weights 权重（大小须为神经元数 x 输入数）
+     */
+    void setWeights(const std::vector<double>& weights);
+    
+    /**
+     * @brief 获取偏置
+     * @return 偏置
+     */
+    const std::vector<double>& getBiases() const;
+    
+    /**
+     * @brief 推理时打包权重和整数阈值占用的字节数
+     * @return 字节数
+     */
+    size_t packedBytes() const;
+
+private:
+    size_t num_neurons_;                        ///< 神经元数量
+    size_t words_per_row_;                      ///< 每个神经元（及每个输入样本）的64位字数
+    double scale_;                              ///< 点积缩放因子 1/sqrt(n)
+    std::vector<double> weights_;               ///< 潜在实值权重
+    std::vector<double> biases_;                ///< 偏置（作用于缩放后的点积）
+    std::vector<double> weight_gradients_;      ///< 权重梯度
+    std::vector<double> bias_gradients_;        ///< 偏置梯度
+    std::vector<uint64_t> packed_weights_;      ///< 权重符号位（1表示+1），按神经元连续存放
+    std::vector<int64_t> thresholds_;           ///< 输出1所需的最小整数点积
+    
+    /**
+     * @brief 根据潜在权重和偏置重新生成符号位和整数阈值
+     */
+    void repack();
+    
+    /**
+     * @brief 把输入二值化并打包（多余的位为0）
+     * @param inputs 输入
+     * @param packed 输出，大小为words_per_row_
+     */
+    void packInputs(const std::vector<double>& inputs, uint64_t* packed) const;
+    
+    /**
+     * @brief 由打包输入计算所有神经元的输出
+     * @param packed 打包输入
+     * @param outputs 输出（0或1）
+     */
+    void computeOutputs(const uint64_t* packed, std::vector<double>& outputs) const;
+    
+    /**
+     * @brief 由打包输入计算一个神经元的整数点积 n - 2·popcount(x XOR w)
+     * @param packed 打包输入
+     * @param neuron 神经元索引
+     * @return 点积
+     */
+    int64_t binaryDot(const uint64_t* packed, size_t neuron) const;
+};
+
+} // namespace neural_network
+
+#endif // BINARY_LAYER_H
@@ -0,0 +1,132 @@
+#include "code_generator.h"
+#include "network.h"
+#include "dense_kernel.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+
+namespace neural_network {
+
+namespace {
+
+/**
+ * @brief 以十六进制浮点字面量输出double，保证无损
+ */
+std::string hexLiteral(double value) {
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%a", value);
+    return buffer;
+}
+
+/**
+ * @brief 生成对加权和sum应用激活函数的表达式（与applyActivation的计算相同）
+ */
+std::string activationExpression(ActivationType type, const std::string& sum) {
+    switch (type) {
+        case ActivationType::TANH:
+            return "std::tanh(" + sum + ")";
+        case ActivationType::RELU:
+            return "(0.0 < " + sum + " ? " + sum + " : 0.0)";
+        case ActivationType::LINEAR:
+            return sum;
+        case ActivationType::SIGMOID:
+        default:
+            return "1.0 / (1.0 + std::exp(-" + sum + "))";
+    }
+}
+
+bool isIdentifier(const std::string& name) {
+    if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) {
+        return false;
+    }
+    return std::all_of(name.begin(), name.end(), [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    });
+}
+
+} // namespace
+
+bool generateInferenceHeader(const Network& network, const std::string& namespaceName, std::ostream& out) {
+    if (network.getLayerCount() == 0 || network.isMixedPrecision() || !isIdentifier(namespaceName)) {
+        return false;
+    }
+    for (size_t l = 0; l < network.getLayerCount(); l++) {
+        auto layer = network.getLayer(l);
+        if (layer->typeName() != "dense" || layer->size() == 0 ||
+            (l > 0 && layer->inputSize() != network.getLayer(l - 1)->size())) {
+            return false;
+        }
+    }
+    
+    std::string guard = namespaceName;
+    std::transform(guard.begin(), guard.end(), guard.begin(), [](char c) {
+        return static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    });
+    guard += "_GENERATED_H";
+    
+    const size_t input_size = network.getLayer(0)->inputSize();
+    const size_t output_size = network.getLayer(network.getLayerCount() - 1)->size();
+    
+    out << "// 由nn_codegen生成，请勿手工修改\n"
+        << "// 编译时不要启用-ffast-math，并关闭乘加收缩（-ffp-contract=off），以便与Network::forward逐位一致\n"
+        << "#ifndef " << guard << "\n#define " << guard << "\n\n"
+        << "#include <cmath>\n#include <cstddef>\n\n"
+        << "namespace " << namespaceName << " {\n\n"
+        << "constexpr std::size_t kInputSize = " << input_size << ";\n"
+        << "constexpr std::size_t kOutputSize = " << output_size << ";\n";
+    
+    // 各层权重与偏置
+    for (size_t l = 0; l < network.getLayerCount(); l++) {
+        auto layer = network.getLayer(l);
+        const auto& neurons = layer->getNeurons();
+        out << "\nconstexpr double kLayer" << l << "Weights[" << neurons.size() << "][" << layer->inputSize()
+            << "] = {\n";
+        for (const auto& neuron : neurons) {
+            out << "    {";
+            const auto& weights = neuron->getWeights();
+            for (size_t k = 0; k < weights.size(); k++) {
+                out << (k > 0 ? ", " : "") << hexLiteral(weights[k]);
+            }
+            out << "},\n";
+        }
+        out << "};\n";
+        out << "constexpr double kLayer" << l << "Biases[" << neurons.size() << "] = {";
+        for (size_t j = 0; j < neurons.size(); j++) {
+            out << (j > 0 ? ", " : "") << hexLiteral(neurons[j]->getBias());
+        }
+        out << "};\n";
+    }
+    
+    // 完全展开的推理函数：每个神经元一条语句
+    out << "\n/**\n * @brief 推理\n * @param input kInputSize个输入\n * @param output kOutputSize个输出\n */\n"
+        << "inline void predict(const double* input, double* output) {\n";
+    std::string previous = "input";
+    for (size_t l = 0; l < network.getLayerCount(); l++) {
+        auto layer = network.getLayer(l);
+        const auto& neurons = layer->getNeurons();
+        const bool last = l + 1 == network.getLayerCount();
+        const std::string current = last ? "output" : "layer" + std::to_string(l);
+        const std::string weights = "kLayer" + std::to_string(l) + "Weights";
+        const std::string biases = "kLayer" + std::to_string(l) + "Biases";
+        
+        out << "    // 第" << l << "层: " << layer->inputSize() << " -> " << neurons.size() << "\n";
+        if (!last) {
+            out << "    double " << current << "[" << neurons.size() << "];\n";
+        }
+        for (size_t j = 0; j < neurons.size(); j++) {
+            std::string sum = "(0.0";
+            for (size_t k = 0; k < layer->inputSize(); k++) {
+                sum += " + " + previous + "[" + std::to_string(k) + "] * " + weights + "[" + std::to_string(j) +
+                       "][" + std::to_string(k) + "]";
+            }
+            sum += " + " + biases + "[" + std::to_string(j) + "])";
+            out << "    {\n        const double sum = " << sum << ";\n        " << current << "[" << j
+                << "] = " << activationExpression(neurons[j]->getActivationType(), "sum") << ";\n    }\n";
+        }
+        previous = current;
+    }
+    out << "}\n\n} // namespace " << namespaceName << "\n\n#endif // " << guard << "\n";
+    return static_cast<bool>(out);
+}
+
+} // namespace neural_network
@@ -0,0 +1,31 @@
+#ifndef CODE_GENERATOR_H
+#define CODE_GENERATOR_H
+
+#include <ostream>
+#include <string>
+
+namespace neural_network {
+
+class Network;
+
+/**
+ * @brief 为全连接网络生成独立的C++推理头文件
+ * 
+ * 生成的头文件只依赖标准库：每层权重和偏置是十六进制浮点字面量的constexpr数组，
+ * 推理函数对每个神经元完全展开并内联其激活函数。累加顺序与Neuron::forward相同
+ * （从0.0开始按输入顺序累加，最后加偏置），因此在同一平台上以相同的浮点设置
+ * （不启用-ffast-math，且不把乘加收缩为FMA，如GCC/Clang的-ffp-contract=off）
+ * 编译时，结果与Network::forward逐位一致。
+ * 
+ * 生成的命名空间提供kInputSize、kOutputSize和
+ * predict(const double* input, double* output)。
+ * @param network 网络（只能包含全连接层，且不能处于混合精度模式）
+ * @param namespaceName 生成代码使用的命名空间
+ * @param out 输出流
+ * @return 是否生成成功，网络包含不支持的层或命名空间不合法时返回false
+ */
+bool generateInferenceHeader(const Network& network, const std::string& namespaceName, std::ostream& out);
+
+} // namespace neural_network
+
+#endif // CODE_GENERATOR_H
@@ -0,0 +1,399 @@
+#include "conv_layer.h"
+#include "dense_kernel.h"
+#include "gemm.h"
+#include "tracer.h"
+#include "../neuron/philox.h"
+#include <algorithm>
+#include <cmath>
+
+namespace neural_network {
+
+namespace {
+
+const size_t kDirectKernelMax = 3;  ///< AUTO模式下使用直接卷积的最大卷积核边长
+
+} // namespace
+
+Conv2DLayer::Conv2DLayer(size_t inChannels, size_t inHeight, size_t inWidth, size_t outChannels,
+                         size_t kernelSize, size_t stride, size_t padding, ActivationType activation)
+    : Layer(0, inChannels * inHeight * inWidth, WeightInitScheme::UNIFORM),
+      in_channels_(inChannels), in_height_(inHeight), in_width_(inWidth), out_channels_(outChannels),
+      kernel_size_(kernelSize), stride_(std::max<size_t>(stride, 1)), padding_(padding),
+      out_height_(0), out_width_(0), activation_(activation), algorithm_(ConvAlgorithm::AUTO),
+      weights_(outChannels * inChannels * kernelSize * kernelSize), biases_(outChannels),
+      weight_gradients_(weights_.size(), 0.0), bias_gradients_(outChannels, 0.0) {
+    if (inHeight + 2 * padding_ >= kernelSize && inWidth + 2 * padding_ >= kernelSize) {
+        out_height_ = (inHeight + 2 * padding_ - kernelSize) / stride_ + 1;
+        out_width_ = (inWidth + 2 * padding_ - kernelSize) / stride_ + 1;
+    }
+    last_outputs_.resize(size());
+    
+    // 与神经元的默认初始化保持一致：[-0.5, 0.5]均匀分布
+    initializeWeights(WeightInitScheme::UNIFORM, Neuron::deriveInitSeed());
+}
+
+std::vector<double> Conv2DLayer::forward(const std::vector<double>& inputs) {
+    NN_TRACE_SCOPE_ARG("layer", "Conv2DLayer::forward", "channels", out_channels_);
+    last_inputs_ = inputs;
+    last_inputs_.resize(num_inputs_, 0.0);
+    computeOutputs(last_inputs_, last_outputs_);
+    return last_outputs_;
+}
+
+std::vector<std::vector<double>> Conv2DLayer::predictBatch(const std::vector<std::vector<double>>& batch) const {
+    std::vector<std::vector<double>> outputs(batch.size());
+    std::vector<double> padded;
+    for (size_t s = 0; s < batch.size(); s++) {
+        padded = batch[s];
+        padded.resize(num_inputs_, 0.0);
+        computeOutputs(padded, outputs[s]);
+    }
+    return outputs;
+}
+
+void Conv2DLayer::computeOutputs(const std::vector<double>& inputs, std::vector<double>& outputs) const {
+    const size_t positions = out_height_ * out_width_;
+    outputs.assign(out_channels_ * positions, 0.0);
+    
+    ConvAlgorithm algorithm = algorithm_;
+    if (algorithm == ConvAlgorithm::AUTO) {
+        algorithm = kernel_size_ <= kDirectKernelMax ? ConvAlgorithm::DIRECT : ConvAlgorithm::IM2COL_GEMM;
+    }
+    
+    if (algorithm == ConvAlgorithm::IM2COL_GEMM) {
+        std::vector<double> columns;
+        im2col(inputs, columns);
+        gemmBlocked(out_channels_, positions, patchSize(), weights_.data(), columns.data(), outputs.data(),
+                    kernel_config_.blocking);
+    } else {
+        // 直接卷积：小卷积核时避免展开矩阵的内存开销
+        for (size_t oc = 0; oc < out_channels_; oc++) {
+            const double* kernel = weights_.data() + oc * patchSize();
+            double* out = outputs.data() + oc * positions;
+            for (size_t c = 0; c < in_channels_; c++) {
+                const double* channel = inputs.data() + c * in_height_ * in_width_;
+                for (size_t ki = 0; ki < kernel_size_; ki++) {
+                    for (size_t kj = 0; kj < kernel_size_; kj++) {
+                        const double w = kernel[(c * kernel_size_ + ki) * kernel_size_ + kj];
+                        for (size_t oh = 0; oh < out_height_; oh++) {
+                            long row = static_cast<long>(oh * stride_ + ki) - static_cast<long>(padding_);
+                            if (row < 0 || row >= static_cast<long>(in_height_)) continue;
+                            for (size_t ow = 0; ow < out_width_; ow++) {
+                                long col = static_cast<long>(ow * stride_ + kj) - static_cast<long>(padding_);
+                                if (col < 0 || col >= static_cast<long>(in_width_)) continue;
+                                out[oh * out_width_ + ow] += w * channel[row * in_width_ + col];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    
+    for (size_t oc = 0; oc < out_channels_; oc++) {
+        double* out = outputs.data() + oc * positions;
+        for (size_t p = 0; p < positions; p++) {
+            out[p] = applyActivation(activation_, out[p] + biases_[oc]);
+        }
+    }
+}
+
+std::vector<double> Conv2DLayer::backward(const std::vector<double>& errors, double gradientScale,
+                                          bool propagateErrors) {
+    NN_TRACE_SCOPE_ARG("layer", "Conv2DLayer::backward", "channels", out_channels_);
+    const size_t positions = out_height_ * out_width_;
+    const size_t patch = patchSize();
+    
+    // 误差项 = 误差 x 激活函数导数
+    std::vector<double> deltas(errors.size());
+    for (size_t i = 0; i < deltas.size(); i++) {
+        deltas[i] = errors[i] * activationDerivative(activation_, last_outputs_[i]);
+    }
+    
+    std::vector<double> columns;
+    im2col(last_inputs_, columns);
+    
+    // 权重梯度 = 误差项 x 展开矩阵的转置；共享的卷积核累加所有位置的梯度
+    for (size_t oc = 0; oc < out_channels_; oc++) {
+        const double* delta = deltas.data() + oc * positions;
+        double bias_sum = 0.0;
+        for (size_t p = 0; p < positions; p++) {
+            bias_sum += delta[p];
+        }
+        bias_gradients_[oc] = bias_sum / gradientScale;
+        
+        for (size_t r = 0; r < patch; r++) {
+            const double* column = columns.data() + r * positions;
+            double sum = 0.0;
+            for (size_t p = 0; p < positions; p++) {
+                sum += delta[p] * column[p];
+            }
+            weight_gradients_[oc * patch + r] = sum / gradientScale;
+        }
+    }
+    
+    if (!propagateErrors) {
+        return {};
+    }
+    
+    // 与全连接层相同，把本层误差按权重分配到输入，导数由前一层自己乘上
+    std::vector<double> column_errors(patch * positions, 0.0);
+    for (size_t oc = 0; oc < out_channels_; oc++) {
+        const double* error = errors.data() + oc * positions;
+        for (size_t r = 0; r < patch; r++) {
+            const double w = weights_[oc * patch + r];
+            double* target = column_errors.data() + r * positions;
+            for (size_t p = 0; p < positions; p++) {
+                target[p] += w * error[p];
+            }
+        }
+    }
+    
+    std::vector<double> prev_errors;
+    col2im(column_errors, prev_errors);
+    return prev_errors;
+}
+
+void Conv2DLayer::updateWeights(double learningRate) {
+    for (size_t i = 0; i < weights_.size(); i++) {
+        weights_[i] -= learningRate * weight_gradients_[i];
+    }
+    for (size_t oc = 0; oc < out_channels_; oc++) {
+        biases_[oc] -= learningRate * bias_gradients_[oc];
+    }
+}
+
+size_t Conv2DLayer::parameterCount() const {
+    return weights_.size() + biases_.size();
+}
+
+void Conv2DLayer::exportParameters(double* out) const {
+    out = std::copy(weights_.begin(), weights_.end(), out);
+    std::copy(biases_.begin(), biases_.end(), out);
+}
+
+void Conv2DLayer::importParameters(const double* in) {
+    std::copy(in, in + weights_.size(), weights_.begin());
+    std::copy(in + weights_.size(), in + weights_.size() + biases_.size(), biases_.begin());
+}
+
+void Conv2DLayer::exportGradients(double* out) const {
+    out = std::copy(weight_gradients_.begin(), weight_gradients_.end(), out);
+    std::copy(bias_gradients_.begin(), bias_gradients_.end(), out);
+}
+
+void Conv2DLayer::importGradients(const double* in) {
+    std::copy(in, in + weight_gradients_.size(), weight_gradients_.begin());
+    std::copy(in + weight_gradients_.size(), in + weight_gradients_.size() + bias_gradients_.size(),
+              bias_gradients_.begin());
+}
+
+double Conv2DLayer::outputDerivative(size_t /*index*/, double output) const {
+    return activationDerivative(activation_, output);
+}
+
+size_t Conv2DLayer::size() const {
+    return out_channels_ * out_height_ * out_width_;
+}
+
+std::string Conv2DLayer::typeName() const {
+    return "conv2d";
+}
+
+void Conv2DLayer::save(std::ostream& out, PrecisionType precision) const {
+    auto convert = [precision](double value) {
+        return precision == PrecisionType::BFLOAT16 ? roundToBFloat16(value) : value;
+    };
+    
+    out << typeName() << " " << in_channels_ << " " << in_height_ << " " << in_width_ << " "
+        << out_channels_ << " " << kernel_size_ << " " << stride_ << " " << padding_ << " "
+        << activationName(activation_) << std::endl;
+    
+    // 每个卷积核一行偏置、一行权重
+    const size_t patch = patchSize();
+    for (size_t oc = 0; oc < out_channels_; oc++) {
+        out << convert(biases_[oc]) << std::endl;
+        for (size_t r = 0; r < patch; r++) {
+            out << convert(weights_[oc * patch + r]);
+            if (r < patch - 1) {
+                out << " ";
+            }
+        }
+        out << std::endl;
+    }
+}
+
+bool Conv2DLayer::loadParameters(std::istream& in) {
+    const size_t patch = patchSize();
+    for (size_t oc = 0; oc < out_channels_; oc++) {
+        in >> biases_[oc];
+        for (size_t r = 0; r < patch; r++) {
+            in >> weights_[oc * patch + r];
+        }
+    }
+    return !in.fail();
+}
+
+LayerMemoryUsage Conv2DLayer::memoryUsage() const {
+    LayerMemoryUsage usage;
+    usage.type = typeName();
+    usage.parameter_bytes = (weights_.size() + biases_.size()) * sizeof(double);
+    usage.overhead_bytes = sizeof(Conv2DLayer) + cacheBytes() +
+                           (weight_gradients_.capacity() + bias_gradients_.capacity() +
+                            weights_.capacity() + biases_.capacity()) * sizeof(double) -
+                           usage.parameter_bytes;
+    return usage;
+}
+
+std::shared_ptr<Conv2DLayer> Conv2DLayer::fromHeader(std::istream& in) {
+    size_t in_channels, in_height, in_width, out_channels, kernel_size, stride, padding;
+    std::string activation_name;
+    in >> in_channels >> in_height >> in_width >> out_channels >> kernel_size >> stride >> padding >> activation_name;
+    
+    ActivationType activation;
+    if (in.fail() || !parseActivation(activation_name, activation)) {
+        return nullptr;
+    }
+    return std::make_shared<Conv2DLayer>(in_channels, in_height, in_width, out_channels,
+                                         kernel_size, stride, padding, activation);
+}
+
+void Conv2DLayer::initializeWeights(WeightInitScheme scheme, uint64_t seed) {
+    init_scheme_ = scheme;
+    
+    const size_t fan_in = patchSize();
+    const size_t fan_out = out_channels_ * kernel_size_ * kernel_size_;
+    double limit = 0.5;
+    if (scheme == WeightInitScheme::XAVIER) {
+        limit = std::sqrt(6.0 / static_cast<double>(std::max<size_t>(fan_in + fan_out, 1)));
+    } else if (scheme == WeightInitScheme::HE) {
+        limit = std::sqrt(6.0 / static_cast<double>(std::max<size_t>(fan_in, 1)));
+    }
+    
+    // 每个卷积核占一个Philox流：前patchSize()个值为权重，最后一个为偏置
+    std::vector<double> values(fan_in + 1);
+    for (size_t oc = 0; oc < out_channels_; oc++) {
+        philoxFillUniform(seed, oc, values.data(), values.size(), -limit, limit);
+        std::copy(values.begin(), values.begin() + fan_in, weights_.begin() + oc * fan_in);
+        biases_[oc] = scheme == WeightInitScheme::UNIFORM ? values[fan_in] : 0.0;
+    }
+}
+
+void Conv2DLayer::setPrecision(PrecisionType /*precision*/) {
+    // 卷积层始终以double存储
+}
+
+void Conv2DLayer::setAlgorithm(ConvAlgorithm algorithm) {
+    algorithm_ = algorithm;
+}
+
+std::string Conv2DLayer::kernelShapeKey() const {
+    return "conv2d:" + std::to_string(in_channels_) + "x" + std::to_string(in_height_) + "x" +
+           std::to_string(in_width_) + ":" + std::to_string(out_channels_) + "k" + std::to_string(kernel_size_) +
+           "s" + std::to_string(stride_) + "p" + std::to_string(padding_);
+}
+
+std::vector<KernelConfig> Conv2DLayer::kernelCandidates(size_t /*maxThreads*/) const {
+    std::vector<KernelConfig> candidates;
+    KernelConfig config;
+    config.variant = KernelVariant::DIRECT;
+    candidates.push_back(config);
+    
+    const GemmBlocking blockings[] = {{16, 64, 64}, {64, 128, 256}, {128, 256, 512}};
+    config.variant = KernelVariant::BLOCKED_GEMM;
+    for (const auto& blocking : blockings) {
+        config.blocking = blocking;
+        candidates.push_back(config);
+    }
+    return candidates;
+}
+
+void Conv2DLayer::setKernelConfig(const KernelConfig& config) {
+    kernel_config_ = config;
+    kernel_config_.threads = 1;
+    if (config.variant == KernelVariant::DIRECT) {
+        algorithm_ = ConvAlgorithm::DIRECT;
+    } else if (config.variant == KernelVariant::BLOCKED_GEMM) {
+        algorithm_ = ConvAlgorithm::IM2COL_GEMM;
+    } else {
+        algorithm_ = ConvAlgorithm::AUTO;
+    }
+}
+
+const std::vector<double>& Conv2DLayer::getWeights() const {
+    return weights_;
+}
+
+void Conv2DLayer::setWeights(const std::vector<double>& weights) {
+    if (weights.size() == weights_.size()) {
+        weights_ = weights;
+    }
+}
+
+const std::vector<double>& Conv2DLayer::getBiases() const {
+    return biases_;
+}
+
+size_t Conv2DLayer::outputHeight() const {
+    return out_height_;
+}
+
+size_t Conv2DLayer::outputWidth() const {
+    return out_width_;
+}
+
+size_t Conv2DLayer::outputChannels() const {
+    return out_channels_;
+}
+
+size_t Conv2DLayer::patchSize() const {
+    return in_channels_ * kernel_size_ * kernel_size_;
+}
+
+void Conv2DLayer::im2col(const std::vector<double>& inputs, std::vector<double>& columns) const {
+    const size_t positions = out_height_ * out_width_;
+    columns.assign(patchSize() * positions, 0.0);
+    
+    for (size_t c = 0; c < in_channels_; c++) {
+        const double* channel = inputs.data() + c * in_height_ * in_width_;
+        for (size_t ki = 0; ki < kernel_size_; ki++) {
+            for (size_t kj = 0; kj < kernel_size_; kj++) {
+                double* row = columns.data() + ((c * kernel_size_ + ki) * kernel_size_ + kj) * positions;
+                for (size_t oh = 0; oh < out_height_; oh++) {
+                    long in_row = static_cast<long>(oh * stride_ + ki) - static_cast<long>(padding_);
+                    if (in_row < 0 || in_row >= static_cast<long>(in_height_)) continue;
+                    for (size_t ow = 0; ow < out_width_; ow++) {
+                        long in_col = static_cast<long>(ow * stride_ + kj) - static_cast<long>(padding_);
+                        if (in_col < 0 || in_col >= static_cast<long>(in_width_)) continue;
+                        row[oh * out_width_ + ow] = channel[in_row * in_width_ + in_col];
+                    }
+                }
+            }
+        }
+    }
+}
+
+void Conv2DLayer::col2im(const std::vector<double>& columns, std::vector<double>& outputs) const {
+    const size_t positions = out_height_ * out_width_;
+    outputs.assign(num_inputs_, 0.0);
+    
+    for (size_t c = 0; c < in_channels_; c++) {
+        double* channel = outputs.data() + c * in_height_ * in_width_;
+        for (size_t ki = 0; ki < kernel_size_; ki++) {
+            for (size_t kj = 0; kj < kernel_size_; kj++) {
+                const double* row = columns.data() + ((c * kernel_size_ + ki) * kernel_size_ + kj) * positions;
+                for (size_t oh = 0; oh < out_height_; oh++) {
+                    long in_row = static_cast<long>(oh * stride_ + ki) - static_cast<long>(padding_);
+                    if (in_row < 0 || in_row >= static_cast<long>(in_height_)) continue;
+                    for (size_t ow = 0; ow < out_width_; ow++) {
+                        long in_col = static_cast<long>(ow * stride_ + kj) - static_cast<long>(padding_);
+                        if (in_col < 0 || in_col >= static_cast<long>(in_width_)) continue;
+                        channel[in_row * in_width_ + in_col] += row[oh * out_width_ + ow];
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace neural_network
@@ -0,0 +1,168 @@
+#ifndef CONV_LAYER_H
+#define CONV_LAYER_H
+
+#include <vector>
+#include <memory>
+#include <string>
+#include "layer.h"
+
+namespace neural_network {
+
+/**
+ * @brief 卷积计算方式枚举
+ */
+enum class ConvAlgorithm {
+    AUTO,         ///< 小卷积核使用直接卷积，其余使用im2col + GEMM
+    IM2COL_GEMM,  ///< 展开为矩阵后使用分块矩阵乘法
+    DIRECT        ///< 直接按卷积定义计算
+};
+
+/**
+ * @brief 二维卷积层
+ * 
+ * 输入和输出均按（通道，行，列）顺序展平为向量。每个输出通道共享一个
+ * inChannels x kernelSize x kernelSize的卷积核，参数量与输入尺寸无关。
+ */
+class Conv2DLayer : public Layer {
+public:
+    /**
+     * @brief 构造函数
+     * @param inChannels 输入通道数
+     * @param inHeight 输入高度
+     * @param inWidth 输入宽度
+     * @param outChannels 输出通道数（卷积核数量）
+     * @param kernelSize 卷积核边长
+     * @param stride 步长
+     * @param padding 四周补零的宽度
+     * @param activation 激活函数类型
+     */
+    Conv2DLayer(size_t inChannels, size_t inHeight, size_t inWidth, size_t outChannels,
+                size_t kernelSize, size_t stride = 1, size_t padding = 0,
+                ActivationType activation = ActivationType::SIGMOID);
+    
+    std::vector<double> forward(const std::vector<double>& inputs) override;
+    std::vector<std::vector<double>> predictBatch(const std::vector<std::vector<double>>& batch) const override;
+    std::vector<double> backward(const std::vector<double>& errors, double gradientScale = 1.0,
+                                 bool propagateErrors = true) override;
+    void updateWeights(double learningRate) override;
+    size_t parameterCount() const override;
+    void exportParameters(double* out) const override;
+    void importParameters(const double* in) override;
+    void exportGradients(double* out) const override;
+    void importGradients(const double* in) override;
+    double outputDerivative(size_t index, double output) const override;
+    size_t size() const override;
+    std::string typeName() const override;
+    void save(std::ostream& out, PrecisionType precision) const override;
+    bool loadParameters(std::istream& in) override;
+    LayerMemoryUsage memoryUsage() const override;
+    void initializeWeights(WeightInitScheme scheme, uint64_t seed) override;
+    void setPrecision(PrecisionType precision) override;
+    std::string kernelShapeKey() const override;
+    std::vector<KernelConfig> kernelCandidates(size_t maxThreads) const override;
+    
+    /**
+     * @brief 设置内核配置：DIRECT对应直接卷积，BLOCKED_GEMM对应im2col + 指定分块的GEMM
+     * 
+     * 两种计算方式的累加顺序不同，切换后输出可能有舍入级差异；配置同样作用于训练时的前向计算。
+     * @param config 内核配置
+     */
+    void setKernelConfig(const KernelConfig& config) override;
+    
+    /**
+     * @brief 从模型文件的层描述行创建卷积层（类型名已读取）
+     * @param in 输入流
+     * @return 卷积层，格式错误时返回nullptr
+     */
+    static std::shared_ptr<Conv2DLayer> fromHeader(std::istream& in);
+    
+    /**
+     * @brief 设置卷积计算方式
+     * @param algorithm 计算方式
+     */
+    void setAlgorithm(ConvAlgorithm algorithm);
+    
+    /**
+     * @brief 获取卷积核权重（outChannels x inChannels*kernelSize*kernelSize，行主序）
+     * @return 权重向量
+     */
+    const std::vector<double>& getWeights() const;
+    
+    /**
+     * @brief 设置卷积核权重
+     * @param weights 权重向量，长度必须与getWeights()一致
+     */
+    void setWeights(const std::vector<double>& weights);
+    
+    /**
+     * @brief 获取每个输出通道的偏置
+     * @return 偏置向量
+     */
+    const std::vector<double>& getBiases() const;
+    
+    /**
+     * @brief 获取输出高度
+     * @return 输出高度
+     */
+    size_t outputHeight() const;
+    
+    /**
+     * @brief 获取输出宽度
+     * @return 输出宽度
+     */
+    size_t outputWidth() const;
+    
+    /**
+     * @brief 获取输出通道数
+     * @return 输出通道数
+     */
+    size_t outputChannels() const;
+
+private:
+    size_t in_channels_;                  ///< 输入通道数
+    size_t in_height_;                    ///< 输入高度
+    size_t in_width_;                     ///< 输入宽度
+    size_t out_channels_;                 ///< 输出通道数
+    size_t kernel_size_;                  ///< 卷积核边长
+    size_t stride_;                       ///< 步长
+    size_t padding_;                      ///< 补零宽度
+    size_t out_height_;                   ///< 输出高度
+    size_t out_width_;                    ///< 输出宽度
+    ActivationType activation_;           ///< 激活函数类型
+    ConvAlgorithm algorithm_;             ///< 计算方式
+    
+    std::vector<double> weights_;         ///< 卷积核权重
+    std::vector<double> biases_;          ///< 偏置
+    std::vector<double> weight_gradients_;///< 权重梯度
+    std::vector<double> bias_gradients_;  ///< 偏置梯度
+    
+    /**
+     * @brief 卷积核展开后的长度（inChannels * kernelSize * kernelSize）
+     */
+    size_t patchSize() const;
+    
+    /**
+     * @brief 将输入展开为patchSize() x (outHeight*outWidth)的矩阵
+     * @param inputs 输入
+     * @param columns 展开结果
+     */
+    void im2col(const std::vector<double>& inputs, std::vector<double>& columns) const;
+    
+    /**
+     * @brief 将展开矩阵形式的误差累加回输入形状
+     * @param columns 展开矩阵形式的误差
+     * @param outputs 输入形状的误差
+     */
+    void col2im(const std::vector<double>& columns, std::vector<double>& outputs) const;
+    
+    /**
+     * @brief 计算卷积输出（含偏置和激活）
+     * @param inputs 输入
+     * @param outputs 输出
+     */
+    void computeOutputs(const std::vector<double>& inputs, std::vector<double>& outputs) const;
+};
+
+} // namespace neural_network
+
+#endif // CONV_LAYER_H
@@ -0,0 +1,246 @@
+#include "data_parallel_trainer.h"
+#include "tracer.h"
+#include "../neuron/philox.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
+namespace neural_network {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+} // namespace
+
+DataParallelTrainer::DataParallelTrainer(Network& network, const DataParallelOptions& options)
+    : network_(network), options_(options) {
+    if (options_.num_threads == 0) {
+        options_.num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    options_.chunk_size = std::max<size_t>(1, options_.chunk_size);
+    for (size_t t = 0; t < options_.num_threads; t++) {
+        replicas_.push_back(network_.clone());
+    }
+    for (size_t t = 0; t + 1 < options_.num_threads; t++) {
+        workers_.emplace_back(&DataParallelTrainer::workerLoop, this, t);
+    }
+}
+
+DataParallelTrainer::~DataParallelTrainer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    start_cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void DataParallelTrainer::runOnThreads(size_t count, const std::function<void(size_t)>& task) {
+    if (count > 1) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            task_ = task;
+            task_count_ = count;
+            remaining_ = count - 1;
+            generation_++;
+        }
+        start_cv_.notify_all();
+    }
+    task(count - 1);
+    if (count > 1) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cv_.wait(lock, [this] { return remaining_ == 0; });
+        task_ = nullptr;
+    }
+}
+
+void DataParallelTrainer::workerLoop(size_t index) {
+    Tracer::instance().setThreadName("data parallel worker " + std::to_string(index));
+    uint64_t seen = 0;
+    while (true) {
+        std::function<void(size_t)> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_cv_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+            if (stopping_) {
+                return;
+            }
+            seen = generation_;
+            // 本轮份数少于线程数时多余的工作线程不参与
+            if (index + 1 >= task_count_) {
+                continue;
+            }
+            task = task_;
+        }
+        
+        task(index);
+        
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--remaining_ == 0) {
+            done_cv_.notify_one();
+        }
+    }
+}
+
+size_t DataParallelTrainer::getThreadCount() const {
+    return options_.num_threads;
+}
+
+void DataParallelTrainer::accumulateSample(Network& replica,
+                                           const std::pair<std::vector<double>, std::vector<double>>& sample,
+                                           std::vector<double>& sum) {
+    std::vector<double> outputs = replica.computeGradients(sample.first, sample.second);
+    std::vector<double> gradients = replica.getGradients();
+    for (size_t p = 0; p < gradients.size(); p++) {
+        sum[p] += gradients[p];
+    }
+    sum.back() += replica.computeLoss(outputs, sample.second);
+}
+
+std::vector<double> DataParallelTrainer::reduceDeterministic(const Dataset& batch, size_t threads) {
+    const size_t width = network_.getParameterCount() + 1;
+    const size_t chunk = options_.chunk_size;
+    const size_t leaves = (batch.size() + chunk - 1) / chunk;
+    if (buffers_.size() < leaves) {
+        buffers_.resize(leaves);
+    }
+    
+    // 线程t处理编号连续的叶子，叶子内部按样本顺序累加
+    const size_t workers = std::min(threads, leaves);
+    runOnThreads(workers, [&](size_t t) {
+        NN_TRACE_SCOPE_ARG("thread", "DataParallelTrainer worker", "thread", t);
+        for (size_t leaf = t * leaves / workers; leaf < (t + 1) * leaves / workers; leaf++) {
+            std::vector<double>& sum = buffers_[leaf];
+            sum.assign(width, 0.0);
+            for (size_t s = leaf * chunk; s < std::min(batch.size(), (leaf + 1) * chunk); s++) {
+                accumulateSample(*replicas_[t], batch[s], sum);
+            }
+        }
+    });
+    
+    // 两两归约树：第k层把间隔2^k的叶子合并，形状只取决于叶子数；
+    // 各线程负责参数的一段，每个元素的加法顺序与线程数无关
+    const size_t slices = std::min(threads, width);
+    runOnThreads(slices, [&](size_t t) {
+        const size_t begin = t * width / slices;
+        const size_t end = (t + 1) * width / slices;
+        for (size_t stride = 1; stride < leaves; stride *= 2) {
+            for (size_t i = 0; i + stride < leaves; i += 2 * stride) {
+                double* target = buffers_[i].data();
+                const double* source = buffers_[i + stride].data();
+                for (size_t p = begin; p < end; p++) {
+                    target[p] += source[p];
+                }
+            }
+        }
+    });
+    return buffers_[0];
+}
+
+std::vector<double> DataParallelTrainer::reduceFast(const Dataset& batch, size_t threads) {
+    const size_t width = network_.getParameterCount() + 1;
+    const size_t workers = std::min(threads, batch.size());
+    if (buffers_.size() < workers) {
+        buffers_.resize(workers);
+    }
+    
+    // 动态领取样本，部分和按线程完成的先后加到总和上
+    std::vector<double> total(width, 0.0);
+    std::atomic<size_t> next{0};
+    std::mutex mutex;
+    runOnThreads(workers, [&](size_t t) {
+        NN_TRACE_SCOPE_ARG("thread", "DataParallelTrainer worker", "thread", t);
+        std::vector<double>& sum = buffers_[t];
+        sum.assign(width, 0.0);
+        for (size_t s = next.fetch_add(1); s < batch.size(); s = next.fetch_add(1)) {
+            accumulateSample(*replicas_[t], batch[s], sum);
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t p = 0; p < width; p++) {
+            total[p] += sum[p];
+        }
+    });
+    return total;
+}
+
+DataParallelStats DataParallelTrainer::trainBatch(const Dataset& batch, double learningRate) {
+    DataParallelStats stats;
+    if (batch.empty() || network_.getLayerCount() == 0) {
+        return stats;
+    }
+    NN_TRACE_SCOPE_ARG("network", "DataParallelTrainer::trainBatch", "samples", batch.size());
+    auto start = Clock::now();
+    
+    // 副本与网络同步：结构改变时重新复制，否则只复制参数、状态量和冻结标志
+    const std::vector<double> parameters = network_.getParameters();
+    const std::vector<double> buffers = network_.getBuffers();
+    for (auto& replica : replicas_) {
+        if (!replica || replica->getLayerCount() != network_.getLayerCount() ||
+            replica->getParameterCount() != parameters.size() || !replica->setBuffers(buffers)) {
+            replica = network_.clone();
+        } else {
+            replica->setParameters(parameters);
+        }
+        for (size_t i = 0; i < network_.getLayerCount(); i++) {
+            replica->getLayer(i)->setFrozen(network_.getLayer(i)->isFrozen());
+        }
+    }
+    
+    std::vector<double> sum = options_.deterministic ? reduceDeterministic(batch, options_.num_threads)
+                                                     : reduceFast(batch, options_.num_threads);
+    
+    // 平均梯度写回网络后统一更新
+    const double count = static_cast<double>(batch.size());
+    std::vector<double> gradients(sum.begin(), sum.end() - 1);
+    for (auto& gradient : gradients) {
+        gradient /= count;
+    }
+    network_.setGradients(gradients);
+    network_.applyGradients(learningRate);
+    
+    stats.mean_loss = sum.back() / count;
+    stats.sample_count = batch.size();
+    stats.wall_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return stats;
+}
+
+DataParallelStats DataParallelTrainer::trainEpoch(const Dataset& dataset, size_t batchSize, double learningRate) {
+    DataParallelStats stats;
+    auto start = Clock::now();
+    
+    // Fisher-Yates洗牌，第i步的随机数只取决于（种子，轮次，i）
+    std::vector<size_t> order(dataset.size());
+    std::iota(order.begin(), order.end(), 0);
+    Philox4x32 generator(options_.seed);
+    for (size_t i = order.size(); i > 1; i--) {
+        Philox4x32::Counter block = generator.generate(epoch_, i);
+        const uint64_t random = (static_cast<uint64_t>(block[0]) << 32) | block[1];
+        std::swap(order[i - 1], order[random % i]);
+    }
+    epoch_++;
+    
+    const size_t batch_size = std::max<size_t>(1, batchSize);
+    double loss_sum = 0.0;
+    Dataset batch;
+    for (size_t begin = 0; begin < order.size(); begin += batch_size) {
+        batch.clear();
+        for (size_t i = begin; i < std::min(order.size(), begin + batch_size); i++) {
+            batch.push_back(dataset[order[i]]);
+        }
+        DataParallelStats batch_stats = trainBatch(batch, learningRate);
+        loss_sum += batch_stats.mean_loss * batch_stats.sample_count;
+        stats.sample_count += batch_stats.sample_count;
+    }
+    
+    stats.mean_loss = stats.sample_count > 0 ? loss_sum / stats.sample_count : 0.0;
+    stats.wall_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return stats;
+}
+
+} // namespace neural_network
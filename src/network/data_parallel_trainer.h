@@ -0,0 +1,145 @@
+#ifndef DATA_PARALLEL_TRAINER_H
+#define DATA_PARALLEL_TRAINER_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "network.h"
+#include "evaluation.h"
+
+namespace neural_network {
+
+/**
+ * @brief 多线程数据并行训练选项
+ */
+struct DataParallelOptions {
+    size_t num_threads = 0;        ///< 线程数，0表示使用硬件并发数
+    bool deterministic = true;     ///< 确定性模式：结果与线程数无关、逐位可复现
+    size_t chunk_size = 8;         ///< 确定性模式下每个归约叶子的样本数（决定归约树的形状）
+    uint64_t seed = 0;             ///< trainEpoch打乱样本顺序使用的种子
+};
+
+/**
+ * @brief 一次批次训练的统计信息
+ */
+struct DataParallelStats {
+    double wall_seconds = 0.0;     ///< 耗时
+    double mean_loss = 0.0;        ///< 批次平均损失（更新前的权重上）
+    size_t sample_count = 0;       ///< 样本数
+};
+
+/**
+ * @brief 单进程多线程数据并行训练器
+ *
+ * 每个线程持有网络的一个副本（Network::clone），对分到的样本逐个计算梯度，
+ * 整批的平均梯度写回原网络后统一更新（同步SGD，与PipelineTrainer相同的语义）。
+ * 工作线程在构造时创建并常驻，每个批次只唤醒一次，调用线程承担最后一份工作。
+ *
+ * 确定性模式：批次按样本顺序切成固定大小的叶子，线程按编号分到连续的叶子区间，
+ * 叶子内按样本顺序累加；叶子之间按固定形状的两两归约树合并梯度和损失。
+ * 归约树只由样本数和chunk_size决定，因此任意线程数下结果逐位一致。
+ * 非确定性模式：线程动态领取样本，各线程的部分和按完成顺序相加，浮点求和顺序
+ * 随调度变化，但没有叶子缓冲区和归约树的开销。
+ *
+ * 权重初始化的随机性由Network::setSeed或Neuron::setGlobalSeed统一设置，
+ * trainEpoch的样本打乱由选项中的种子决定。不支持混合精度的损失缩放。
+ */
+class DataParallelTrainer {
+public:
+    /**
+     * @brief 构造函数，为每个线程创建网络副本
+     * @param network 待训练的网络
+     * @param options 选项
+     */
+    explicit DataParallelTrainer(Network& network, const DataParallelOptions& options = DataParallelOptions());
+    
+    /**
+     * @brief 析构函数，停止并回收工作线程
+     */
+    ~DataParallelTrainer();
+    
+    DataParallelTrainer(const DataParallelTrainer&) = delete;
+    DataParallelTrainer& operator=(const DataParallelTrainer&) = delete;
+    
+    /**
+     * @brief 在一个批次上训练一步
+     * @param batch 批次样本
+     * @param learningRate 学习率
+     * @return 统计信息
+     */
+    DataParallelStats trainBatch(const Dataset& batch, double learningRate);
+    
+    /**
+     * @brief 按种子和轮次打乱样本后，以小批次训练一轮
+     * @param dataset 数据集
+     * @param batchSize 批大小
+     * @param learningRate 学习率
+     * @return 整轮的统计信息（平均损失按样本数加权）
+     */
+    DataParallelStats trainEpoch(const Dataset& dataset, size_t batchSize, double learningRate);
+    
+    /**
+     * @brief 获取线程数
+     * @return 线程数
+     */
+    size_t getThreadCount() const;
+
+private:
+    Network& network_;                                  ///< 待训练的网络
+    DataParallelOptions options_;                       ///< 选项
+    std::vector<std::shared_ptr<Network>> replicas_;    ///< 每个线程的网络副本
+    std::vector<std::vector<double>> buffers_;          ///< 叶子（或线程）的梯度部分和，末尾一项为损失和
+    uint64_t epoch_ = 0;                                ///< 已训练的轮数
+    
+    std::vector<std::thread> workers_;                  ///< 常驻工作线程（线程数 - 1个）
+    std::mutex mutex_;                                  ///< 保护下面的调度状态
+    std::condition_variable start_cv_;                  ///< 通知工作线程开始新一轮
+    std::condition_variable done_cv_;                   ///< 通知调用线程本轮完成
+    std::function<void(size_t)> task_;                  ///< 本轮任务，参数为份编号
+    size_t task_count_ = 0;                             ///< 本轮任务份数
+    uint64_t generation_ = 0;                           ///< 已发起的轮数
+    size_t remaining_ = 0;                              ///< 本轮尚未完成的工作线程数
+    bool stopping_ = false;                             ///< 析构时置位
+    
+    /**
+     * @brief 在count份上执行task(t)：前count - 1份交给常驻工作线程，最后一份在当前线程执行
+     * @param count 份数，不超过线程数
+     * @param task 任务
+     */
+    void runOnThreads(size_t count, const std::function<void(size_t)>& task);
+    
+    /**
+     * @brief 工作线程主循环
+     * @param index 工作线程编号
+     */
+    void workerLoop(size_t index);
+    
+    /**
+     * @brief 用副本计算一个样本的梯度并累加到部分和
+     * @param replica 网络副本
+     * @param sample 样本
+     * @param sum 部分和（参数数 + 1）
+     */
+    static void accumulateSample(Network& replica, const std::pair<std::vector<double>, std::vector<double>>& sample,
+                                 std::vector<double>& sum);
+    
+    /**
+     * @brief 确定性模式：固定叶子划分 + 两两归约树
+     * @return 梯度之和，末尾一项为损失之和
+     */
+    std::vector<double> reduceDeterministic(const Dataset& batch, size_t threads);
+    
+    /**
+     * @brief 非确定性模式：动态领取样本，各线程部分和按完成顺序合并
+     * @return 梯度之和，末尾一项为损失之和
+     */
+    std::vector<double> reduceFast(const Dataset& batch, size_t threads);
+};
+
+} // namespace neural_network
+
+#endif // DATA_PARALLEL_TRAINER_H
@@ -0,0 +1,82 @@
+#include "dense_kernel.h"
+#include <algorithm>
+#include <cmath>
+
+namespace neural_network {
+
+double applyActivation(ActivationType type, double x) {
+    switch (type) {
+        case ActivationType::TANH:
+            return std::tanh(x);
+            
+        case ActivationType::RELU:
+            return std::max(0.0, x);
+            
+        case ActivationType::LINEAR:
+            return x;
+            
+        case ActivationType::SIGMOID:
+        default:
+            return 1.0 / (1.0 + std::exp(-x));
+    }
+}
+
+double activationDerivative(ActivationType type, double output) {
+    switch (type) {
+        case ActivationType::TANH:
+            return 1.0 - output * output;
+            
+        case ActivationType::RELU:
+            return output > 0 ? 1.0 : 0.0;
+            
+        case ActivationType::LINEAR:
+            return 1.0;
+            
+        case ActivationType::SIGMOID:
+        default:
+            return output * (1.0 - output);
+    }
+}
+
+const char* activationName(ActivationType type) {
+    switch (type) {
+        case ActivationType::TANH:
+            return "tanh";
+        case ActivationType::RELU:
+            return "relu";
+        case ActivationType::LINEAR:
+            return "linear";
+        case ActivationType::SIGMOID:
+        default:
+            return "sigmoid";
+    }
+}
+
+bool parseActivation(const std::string& name, ActivationType& type) {
+    if (name == "sigmoid") {
+        type = ActivationType::SIGMOID;
+    } else if (name == "tanh") {
+        type = ActivationType::TANH;
+    } else if (name == "relu") {
+        type = ActivationType::RELU;
+    } else if (name == "linear") {
+        type = ActivationType::LINEAR;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void denseForward(const double* weights, const double* biases, size_t rows, size_t cols,
+                  ActivationType activation, const double* inputs, double* outputs) {
+    for (size_t j = 0; j < rows; j++) {
+        const double* row = weights + j * cols;
+        double sum = 0.0;
+        for (size_t k = 0; k < cols; k++) {
+            sum = sum + row[k] * inputs[k];
+        }
+        outputs[j] = applyActivation(activation, sum + biases[j]);
+    }
+}
+
+} // namespace neural_network
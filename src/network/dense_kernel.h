@@ -0,0 +1,63 @@
+#ifndef DENSE_KERNEL_H
+#define DENSE_KERNEL_H
+
+#include <cstddef>
+#include <string>
+#include "../neuron/neuron.h"
+
+namespace neural_network {
+
+/**
+ * @brief 按激活函数类型计算激活值
+ * 
+ * 与Neuron内置的激活函数使用完全相同的表达式，保证结果逐位一致。
+ * @param type 激活函数类型
+ * @param x 加权输入和
+ * @return 激活值
+ */
+double applyActivation(ActivationType type, double x);
+
+/**
+ * @brief 根据输出值计算激活函数的导数
+ * 
+ * 与Neuron::computeActivationDerivative一致。
+ * @param type 激活函数类型
+ * @param output 激活函数输出值
+ * @return 导数值
+ */
+double activationDerivative(ActivationType type, double output);
+
+/**
+ * @brief 获取激活函数类型的名称（用于模型文件）
+ * @param type 激活函数类型
+ * @return 名称，如"sigmoid"
+ */
+const char* activationName(ActivationType type);
+
+/**
+ * @brief 根据名称解析激活函数类型
+ * @param name 名称
+ * @param type 解析结果
+ * @return 是否为已知名称
+ */
+bool parseActivation(const std::string& name, ActivationType& type);
+
+/**
+ * @brief 在连续存放的权重上计算一个全连接层的输出
+ * 
+ * 累加顺序与Neuron::forward相同（先按输入顺序累加乘积，再加偏置），
+ * 因此与按神经元计算的结果逐位一致。
+ * @param weights 权重矩阵，按行（神经元）连续存放，rows x cols
+ * @param biases 偏置向量，长度rows
+ * @param rows 神经元数量
+ * @param cols 输入数量
+ * @param activation 激活函数类型
+ * @param inputs 输入向量，长度cols
+ * @param outputs 输出向量，长度rows
+ */
+void denseForward(const double* weights, const double* biases, size_t rows, size_t cols,
+                  ActivationType activation, const double* inputs, double* outputs);
+
+} // namespace neural_network
+
+#endif // DENSE_KERNEL_H
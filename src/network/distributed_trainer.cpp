@@ -0,0 +1,140 @@
+#include "distributed_trainer.h"
+#include "tracer.h"
+#include <algorithm>
+
+namespace neural_network {
+
+bool ringAllreduce(Transport& transport, std::vector<double>& data) {
+    NN_TRACE_SCOPE_ARG("distributed", "ringAllreduce", "values", data.size());
+    const size_t n = transport.getWorldSize();
+    const size_t rank = transport.getRank();
+    if (n <= 1) {
+        return true;
+    }
+    
+    auto chunk_begin = [&](size_t c) { return c * data.size() / n; };
+    auto chunk_size = [&](size_t c) { return chunk_begin(c + 1) - chunk_begin(c); };
+    std::vector<double> incoming(data.size() / n + 1);
+    
+    // reduce-scatter：第s步发送块(rank - s)，接收块(rank - s - 1)并累加；
+    // 结束后rank持有块(rank + 1)的完整和
+    for (size_t s = 0; s + 1 < n; s++) {
+        size_t send_chunk = (rank + n - s) % n;
+        size_t recv_chunk = (rank + n - s - 1) % n;
+        if (!transport.ringExchange(data.data() + chunk_begin(send_chunk), chunk_size(send_chunk) * sizeof(double),
+                                    incoming.data(), chunk_size(recv_chunk) * sizeof(double))) {
+            return false;
+        }
+        double* target = data.data() + chunk_begin(recv_chunk);
+        for (size_t i = 0; i < chunk_size(recv_chunk); i++) {
+            target[i] += incoming[i];
+        }
+    }
+    
+    // allgather：第s步转发块(rank + 1 - s)，接收块(rank - s)并直接覆盖
+    for (size_t s = 0; s + 1 < n; s++) {
+        size_t send_chunk = (rank + 1 + n - s) % n;
+        size_t recv_chunk = (rank + n - s) % n;
+        if (!transport.ringExchange(data.data() + chunk_begin(send_chunk), chunk_size(send_chunk) * sizeof(double),
+                                    data.data() + chunk_begin(recv_chunk), chunk_size(recv_chunk) * sizeof(double))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+DistributedTrainer::DistributedTrainer(Network& network, Transport& transport)
+    : network_(network), transport_(transport) {}
+
+bool DistributedTrainer::broadcastParameters() {
+    // 参数后接状态量一起同步
+    std::vector<double> parameters = network_.getParameters();
+    const size_t count = parameters.size();
+    const std::vector<double> buffers = network_.getBuffers();
+    parameters.insert(parameters.end(), buffers.begin(), buffers.end());
+    if (transport_.getRank() != 0) {
+        // 其他rank贡献0，求和结果即rank 0的参数（x + 0.0 == x）
+        std::fill(parameters.begin(), parameters.end(), 0.0);
+    }
+    if (!ringAllreduce(transport_, parameters)) {
+        return false;
+    }
+    return network_.setBuffers(std::vector<double>(parameters.begin() + count, parameters.end())) &&
+           network_.setParameters(std::vector<double>(parameters.begin(), parameters.begin() + count));
+}
+
+bool DistributedTrainer::trainStep(const Dataset& batch, double learningRate, double* loss) {
+    const size_t count = network_.getParameterCount();
+    buffer_.assign(count + 2, 0.0);
+    
+    for (const auto& sample : batch) {
+        auto outputs = network_.computeGradients(sample.first, sample.second);
+        auto gradients = network_.getGradients();
+        for (size_t i = 0; i < count; i++) {
+            buffer_[i] += gradients[i];
+        }
+        buffer_[count] += network_.computeLoss(outputs, sample.second);
+        buffer_[count + 1] += 1.0;
+    }
+    
+    if (!ringAllreduce(transport_, buffer_)) {
+        return false;
+    }
+    
+    const double samples = buffer_[count + 1];
+    if (loss) {
+        *loss = samples > 0 ? buffer_[count] / samples : 0.0;
+    }
+    if (samples == 0) {
+        return true;
+    }
+    
+    buffer_.resize(count);
+    for (auto& gradient : buffer_) {
+        gradient /= samples;
+    }
+    network_.setGradients(buffer_);
+    network_.applyGradients(learningRate);
+    return true;
+}
+
+bool DistributedTrainer::trainEpoch(const Dataset& shard, size_t batchSize, double learningRate, double* loss) {
+    if (batchSize == 0) {
+        return false;
+    }
+    
+    // 交换各rank的步数，取最大值保证所有rank参与相同次数的allreduce
+    std::vector<double> steps(transport_.getWorldSize(), 0.0);
+    steps[transport_.getRank()] = static_cast<double>((shard.size() + batchSize - 1) / batchSize);
+    if (!ringAllreduce(transport_, steps)) {
+        return false;
+    }
+    const size_t total_steps = static_cast<size_t>(*std::max_element(steps.begin(), steps.end()));
+    
+    double loss_sum = 0.0;
+    Dataset batch;
+    for (size_t step = 0; step < total_steps; step++) {
+        size_t begin = std::min(shard.size(), step * batchSize);
+        size_t end = std::min(shard.size(), begin + batchSize);
+        batch.assign(shard.begin() + begin, shard.begin() + end);
+        
+        double step_loss = 0.0;
+        if (!trainStep(batch, learningRate, &step_loss)) {
+            return false;
+        }
+        loss_sum += step_loss;
+    }
+    
+    if (loss) {
+        *loss = total_steps > 0 ? loss_sum / total_steps : 0.0;
+    }
+    return true;
+}
+
+Dataset DistributedTrainer::shard(const Dataset& dataset, size_t rank, size_t worldSize) {
+    size_t begin = rank * dataset.size() / worldSize;
+    size_t end = (rank + 1) * dataset.size() / worldSize;
+    return Dataset(dataset.begin() + begin, dataset.begin() + end);
+}
+
+} // namespace neural_network
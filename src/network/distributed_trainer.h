@@ -0,0 +1,83 @@
+#ifndef DISTRIBUTED_TRAINER_H
+#define DISTRIBUTED_TRAINER_H
+
+#include <vector>
+#include "network.h"
+#include "evaluation.h"
+#include "transport.h"
+
+namespace neural_network {
+
+/**
+ * @brief 环形allreduce求和（reduce-scatter后接allgather）
+ * 
+ * 数据分成worldSize块，每块的最终和只在一个rank上按固定顺序累加，
+ * 再原样复制到其他rank，因此所有rank得到逐位相同的结果。
+ * 每个rank收发的数据量约为2 × (n-1)/n × 数据大小，与进程数基本无关。
+ * @param transport 传输对象
+ * @param data 本rank的数据，返回时替换为所有rank之和
+ * @return 通信失败时返回false
+ */
+bool ringAllreduce(Transport& transport, std::vector<double>& data);
+
+/**
+ * @brief 多进程数据并行训练器
+ * 
+ * 每个进程持有一份网络副本和自己的数据分片，逐样本计算梯度并在本地累加，
+ * 每步通过环形allreduce对梯度求和后按全局样本数取平均再更新。
+ * 所有rank从相同的参数出发并得到逐位相同的平均梯度，因此每步之后权重保持逐位一致。
+ */
+class DistributedTrainer {
+public:
+    /**
+     * @brief 构造函数
+     * @param network 本进程的网络副本
+     * @param transport 传输对象
+     */
+    DistributedTrainer(Network& network, Transport& transport);
+    
+    /**
+     * @brief 把rank 0的参数和状态量同步到所有rank
+     * @return 通信失败时返回false
+     */
+    bool broadcastParameters();
+    
+    /**
+     * @brief 执行一步同步训练
+     * @param batch 本rank在这一步的样本（可以为空）
+     * @param learningRate 学习率
+     * @param loss 若不为空，返回全局平均损失
+     * @return 通信失败时返回false
+     */
+    bool trainStep(const Dataset& batch, double learningRate, double* loss = nullptr);
+    
+    /**
+     * @brief 在本rank的数据分片上训练一轮
+     * 
+     * 各rank的步数取所有rank中的最大值，分片较小的rank在多出的步中不贡献样本。
+     * @param shard 本rank的数据分片
+     * @param batchSize 每个rank每步的样本数
+     * @param learningRate 学习率
+     * @param loss 若不为空，返回本轮各步全局平均损失的平均值
+     * @return 通信失败时返回false
+     */
+    bool trainEpoch(const Dataset& shard, size_t batchSize, double learningRate, double* loss = nullptr);
+    
+    /**
+     * @brief 按连续区间切分数据集
+     * @param dataset 完整数据集
+     * @param rank rank
+     * @param worldSize 进程总数
+     * @return 该rank的分片
+     */
+    static Dataset shard(const Dataset& dataset, size_t rank, size_t worldSize);
+
+private:
+    Network& network_;          ///< 本进程的网络副本
+    Transport& transport_;      ///< 传输对象
+    std::vector<double> buffer_;///< 梯度累加缓冲区（末尾两个元素为损失和与样本数）
+};
+
+} // namespace neural_network
+
+#endif // DISTRIBUTED_TRAINER_H
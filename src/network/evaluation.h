@@ -0,0 +1,59 @@
+#ifndef EVALUATION_H
+#define EVALUATION_H
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+namespace neural_network {
+
+/**
+ * @brief 数据集类型：每个样本为（输入，目标）对
+ */
+using Dataset = std::vector<std::pair<std::vector<double>, std::vector<double>>>;
+
+/**
+ * @brief 评估指标（可按位组合）
+ */
+enum class EvaluationMetrics : unsigned {
+    LOSS = 1u << 0,              ///< 平均损失
+    ACCURACY = 1u << 1,          ///< 分类准确率
+    CONFUSION_MATRIX = 1u << 2,  ///< 混淆矩阵
+    PER_CLASS = 1u << 3,         ///< 每个类别的精确率、召回率和F1
+    ALL = (1u << 4) - 1
+};
+
+inline EvaluationMetrics operator|(EvaluationMetrics a, EvaluationMetrics b) {
+    return static_cast<EvaluationMetrics>(static_cast<unsigned>(a) | static_cast<unsigned>(b));
+}
+
+inline bool hasMetric(EvaluationMetrics set, EvaluationMetrics metric) {
+    return (static_cast<unsigned>(set) & static_cast<unsigned>(metric)) != 0;
+}
+
+/**
+ * @brief 单个类别的统计信息
+ */
+struct ClassStats {
+    size_t support = 0;      ///< 该类别的样本数
+    double precision = 0.0;  ///< 精确率
+    double recall = 0.0;     ///< 召回率
+    double f1 = 0.0;         ///< F1分数
+};
+
+/**
+ * @brief 数据集评估结果
+ * 
+ * 类别取目标/输出向量中最大值的下标；单输出网络按0.5阈值划分为两类。
+ */
+struct EvaluationResult {
+    size_t sample_count = 0;                              ///< 样本数
+    double mean_loss = 0.0;                               ///< 平均损失
+    double accuracy = 0.0;                                ///< 准确率
+    std::vector<std::vector<size_t>> confusion_matrix;    ///< 混淆矩阵[实际类别][预测类别]
+    std::vector<ClassStats> per_class;                    ///< 每个类别的统计信息
+};
+
+} // namespace neural_network
+
+#endif // EVALUATION_H
@@ -0,0 +1,37 @@
+#include "gemm.h"
+#include <algorithm>
+
+namespace neural_network {
+
+void gemmBlocked(size_t M, size_t N, size_t K, const double* A, const double* B, double* C) {
+    gemmBlocked(M, N, K, A, B, C, GemmBlocking());
+}
+
+void gemmBlocked(size_t M, size_t N, size_t K, const double* A, const double* B, double* C,
+                 const GemmBlocking& blocking) {
+    const size_t block_rows = std::max<size_t>(1, blocking.rows);
+    const size_t block_depth = std::max<size_t>(1, blocking.depth);
+    const size_t block_cols = std::max<size_t>(1, blocking.cols);
+    for (size_t i0 = 0; i0 < M; i0 += block_rows) {
+        const size_t i1 = std::min(i0 + block_rows, M);
+        for (size_t k0 = 0; k0 < K; k0 += block_depth) {
+            const size_t k1 = std::min(k0 + block_depth, K);
+            for (size_t j0 = 0; j0 < N; j0 += block_cols) {
+                const size_t j1 = std::min(j0 + block_cols, N);
+                
+                for (size_t i = i0; i < i1; i++) {
+                    double* c_row = C + i * N;
+                    for (size_t k = k0; k < k1; k++) {
+                        const double a = A[i * K + k];
+                        const double* b_row = B + k * N;
+                        for (size_t j = j0; j < j1; j++) {
+                            c_row[j] += a * b_row[j];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace neural_network
@@ -0,0 +1,42 @@
+#ifndef GEMM_H
+#define GEMM_H
+
+#include <cstddef>
+
+namespace neural_network {
+
+/**
+ * @brief 分块矩阵乘法的分块大小
+ */
+struct GemmBlocking {
+    size_t rows = 64;     ///< 行分块大小
+    size_t depth = 128;   ///< 归约维分块大小
+    size_t cols = 256;    ///< 列分块大小
+};
+
+/**
+ * @brief 分块矩阵乘法 C += A * B（行主序）
+ * 
+ * 按行、归约维和列三级分块，使A的一块行、B的一块行在缓存中复用，
+ * 最内层沿C和B的连续列遍历以便编译器向量化。
+ * @param M A和C的行数
+ * @param N B和C的列数
+ * @param K A的列数、B的行数
+ * @param A M x K矩阵
+ * @param B K x N矩阵
+ * @param C M x N矩阵（累加结果）
+ */
+void gemmBlocked(size_t M, size_t N, size_t K, const double* A, const double* B, double* C);
+
+/**
+ * @brief 使用指定分块大小的分块矩阵乘法 C += A * B
+ * 
+ * 对每个C元素，归约维总是按升序累加，因此结果与分块大小无关。
+ * @param blocking 分块大小
+ */
+void gemmBlocked(size_t M, size_t N, size_t K, const double* A, const double* B, double* C,
+                 const GemmBlocking& blocking);
+
+} // namespace neural_network
+
+#endif // GEMM_H
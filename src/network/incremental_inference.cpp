@@ -0,0 +1,198 @@
+#include "incremental_inference.h"
+#include "network.h"
+#include "dense_kernel.h"
+#include <cmath>
+
+namespace neural_network {
+
+std::shared_ptr<IncrementalInference> IncrementalInference::fromNetwork(const Network& network, double tolerance,
+                                                                        size_t resyncInterval) {
+    std::shared_ptr<IncrementalInference> model(new IncrementalInference());
+    model->tolerance_ = tolerance;
+    model->resync_interval_ = resyncInterval;
+    
+    for (size_t i = 0; i < network.getLayerCount(); i++) {
+        auto layer = network.getLayer(i);
+        if (layer->typeName() != "dense") {
+            return nullptr;
+        }
+        // 每层只按一个激活函数传播变化，神经元激活函数不一致的层不支持
+        const auto& neurons = layer->getNeurons();
+        for (const auto& neuron : neurons) {
+            if (neuron->getActivationType() != neurons[0]->getActivationType()) {
+                return nullptr;
+            }
+        }
+        LayerState state;
+        state.rows = layer->size();
+        state.cols = layer->inputSize();
+        state.activation = state.rows > 0 ? neurons[0]->getActivationType() : ActivationType::SIGMOID;
+        state.weights_t.resize(state.rows * state.cols);
+        state.biases.resize(state.rows);
+        for (size_t j = 0; j < state.rows; j++) {
+            const auto& row = neurons[j]->getWeights();
+            for (size_t k = 0; k < state.cols; k++) {
+                state.weights_t[k * state.rows + j] = row[k];
+            }
+            state.biases[j] = neurons[j]->getBias();
+        }
+        state.sums.assign(state.rows, 0.0);
+        state.outputs.assign(state.rows, 0.0);
+        state.propagated.assign(state.rows, 0.0);
+        model->full_cost_ += state.rows * state.cols;
+        model->layers_.push_back(std::move(state));
+    }
+    
+    return model;
+}
+
+bool IncrementalInference::reset(const std::vector<double>& inputs) {
+    if (layers_.empty() || inputs.size() != layers_.front().cols) {
+        return false;
+    }
+    inputs_ = inputs;
+    recomputeAll();
+    primed_ = true;
+    return true;
+}
+
+void IncrementalInference::recomputeAll() {
+    const std::vector<double>* current = &inputs_;
+    for (LayerState& layer : layers_) {
+        // 按输入顺序累加，与Neuron::forward的求和顺序一致
+        for (size_t j = 0; j < layer.rows; j++) {
+            double sum = 0.0;
+            for (size_t k = 0; k < layer.cols; k++) {
+                sum += (*current)[k] * layer.weights_t[k * layer.rows + j];
+            }
+            layer.sums[j] = sum + layer.biases[j];
+            layer.outputs[j] = applyActivation(layer.activation, layer.sums[j]);
+        }
+        layer.propagated = layer.outputs;
+        current = &layer.outputs;
+    }
+    last_cost_ = full_cost_;
+    updates_since_resync_ = 0;
+}
+
+void IncrementalInference::applyColumn(LayerState& layer, size_t column, double delta) {
+    const double* weights = layer.weights_t.data() + column * layer.rows;
+    double* sums = layer.sums.data();
+    for (size_t j = 0; j < layer.rows; j++) {
+        sums[j] += weights[j] * delta;
+    }
+    last_cost_ += layer.rows;
+}
+
+bool IncrementalInference::update(const std::vector<size_t>& indices, const std::vector<double>& deltas) {
+    if (!primed_ || indices.size() != deltas.size()) {
+        return false;
+    }
+    for (size_t index : indices) {
+        if (index >= inputs_.size()) {
+            return false;
+        }
+    }
+    
+    if (resync_interval_ > 0 && ++updates_since_resync_ >= resync_interval_) {
+        for (size_t i = 0; i < indices.size(); i++) {
+            inputs_[indices[i]] += deltas[i];
+        }
+        recomputeAll();
+        return true;
+    }
+    
+    last_cost_ = 0;
+    changed_.clear();
+    changed_deltas_.clear();
+    for (size_t i = 0; i < indices.size(); i++) {
+        if (deltas[i] != 0.0) {
+            inputs_[indices[i]] += deltas[i];
+            changed_.push_back(indices[i]);
+            changed_deltas_.push_back(deltas[i]);
+        }
+    }
+    
+    for (size_t l = 0; l < layers_.size() && !changed_.empty(); l++) {
+        LayerState& layer = layers_[l];
+        for (size_t i = 0; i < changed_.size(); i++) {
+            applyColumn(layer, changed_[i], changed_deltas_[i]);
+        }
+        
+        next_changed_.clear();
+        next_deltas_.clear();
+        bool last = l + 1 == layers_.size();
+        for (size_t j = 0; j < layer.rows; j++) {
+            layer.outputs[j] = applyActivation(layer.activation, layer.sums[j]);
+            if (last) {
+                continue;
+            }
+            // 只传播与下游已见值相差超过容差的激活值，误差因此不会累积
+            double delta = layer.outputs[j] - layer.propagated[j];
+            if (delta != 0.0 && std::fabs(delta) > tolerance_) {
+                layer.propagated[j] = layer.outputs[j];
+                next_changed_.push_back(j);
+                next_deltas_.push_back(delta);
+            }
+        }
+        changed_.swap(next_changed_);
+        changed_deltas_.swap(next_deltas_);
+    }
+    
+    return true;
+}
+
+bool IncrementalInference::update(const std::vector<double>& inputs) {
+    if (!primed_ || inputs.size() != inputs_.size()) {
+        return false;
+    }
+    
+    // 本次触发重新同步时先采用精确的新值再完整重算，结果与全新的前向传播逐位一致
+    if (resync_interval_ > 0 && updates_since_resync_ + 1 >= resync_interval_) {
+        inputs_ = inputs;
+        recomputeAll();
+        return true;
+    }
+    
+    std::vector<size_t> indices;
+    std::vector<double> deltas;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        if (inputs[i] != inputs_[i]) {
+            indices.push_back(i);
+            deltas.push_back(inputs[i] - inputs_[i]);
+        }
+    }
+    if (!update(indices, deltas)) {
+        return false;
+    }
+    // 直接采用新值，避免输入本身累积舍入误差
+    inputs_ = inputs;
+    return true;
+}
+
+const std::vector<double>& IncrementalInference::getOutputs() const {
+    static const std::vector<double> empty;
+    return layers_.empty() ? empty : layers_.back().outputs;
+}
+
+const std::vector<double>& IncrementalInference::getInputs() const {
+    return inputs_;
+}
+
+void IncrementalInference::setTolerance(double tolerance) {
+    tolerance_ = tolerance;
+}
+
+double IncrementalInference::getTolerance() const {
+    return tolerance_;
+}
+
+size_t IncrementalInference::getLastUpdateCost() const {
+    return last_cost_;
+}
+
+size_t IncrementalInference::getFullForwardCost() const {
+    return full_cost_;
+}
+
+} // namespace neural_network
@@ -0,0 +1,137 @@
+#ifndef INCREMENTAL_INFERENCE_H
+#define INCREMENTAL_INFERENCE_H
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include "../neuron/neuron.h"
+
+namespace neural_network {
+
+class Network;
+
+/**
+ * @brief 增量前向推理（适用于相邻输入只有少数特征变化的流式场景）
+ * 
+ * 缓存每个全连接层的加权和（激活前的值）。输入变化时，第一层只按变化的
+ * 输入列更新加权和，代价为O(变化数 × 层宽度)；后续层只传播变化量超过
+ * 容差的激活值。每个神经元下游所见的激活值与真实值之差不超过容差，
+ * 容差为0时结果与完整前向传播只差浮点舍入误差。
+ * 
+ * 权重在创建时复制并按列存放，之后修改原网络不会影响本对象。
+ * 仅支持以ActivationType设置激活函数的全连接层。不是线程安全的。
+ */
+class IncrementalInference {
+public:
+    /**
+     * @brief 从网络创建增量推理对象
+     * @param network 源网络
+     * @param tolerance 激活值变化的传播容差
+     * @param resyncInterval 每隔多少次增量更新做一次完整重算以消除累积舍入误差，0表示从不
+     * @return 增量推理对象，网络包含不支持的层类型或神经元激活函数不一致的层时返回nullptr
+     */
+    static std::shared_ptr<IncrementalInference> fromNetwork(const Network& network, double tolerance = 0.0,
+                                                             size_t resyncInterval = 0);
+    
+    /**
+     * @brief 以完整前向传播设置当前输入并重建所有缓存
+     * @param inputs 输入值向量
+     * @return 输入长度与第一层不符时返回false
+     */
+    bool reset(const std::vector<double>& inputs);
+    
+    /**
+     * @brief 按输入变化量增量更新输出
+     * @param indices 变化的输入下标
+     * @param deltas 对应的变化量（新值减旧值）
+     * @return 尚未reset、长度不一致或下标越界时返回false，此时状态不变
+     */
+    bool update(const std::vector<size_t>& indices, const std::vector<double>& deltas);
+    
+    /**
+     * @brief 对新的完整输入向量做增量更新（自动找出变化的特征）
+     * @param inputs 新的输入值向量
+     * @return 尚未reset或输入长度不符时返回false
+     */
+    bool update(const std::vector<double>& inputs);
+    
+    /**
+     * @brief 获取当前输出
+     * @return 输出值向量
+     */
+    const std::vector<double>& getOutputs() const;
+    
+    /**
+     * @brief 获取当前输入
+     * @return 输入值向量
+     */
+    const std::vector<double>& getInputs() const;
+    
+    /**
+     * @brief 设置激活值变化的传播容差
+     * @param tolerance 容差
+     */
+    void setTolerance(double tolerance);
+    
+    /**
+     * @brief 获取传播容差
+     * @return 容差
+     */
+    double getTolerance() const;
+    
+    /**
+     * @brief 获取最近一次更新执行的乘加次数
+     * @return 乘加次数
+     */
+    size_t getLastUpdateCost() const;
+    
+    /**
+     * @brief 获取一次完整前向传播所需的乘加次数
+     * @return 乘加次数
+     */
+    size_t getFullForwardCost() const;
+
+private:
+    /**
+     * @brief 层缓存
+     */
+    struct LayerState {
+        size_t rows;                       ///< 神经元数量
+        size_t cols;                       ///< 输入数量
+        ActivationType activation;         ///< 激活函数类型
+        std::vector<double> weights_t;     ///< 转置后的权重，cols x rows，每列输入的权重连续存放
+        std::vector<double> biases;        ///< 偏置
+        std::vector<double> sums;          ///< 加权和缓存
+        std::vector<double> outputs;       ///< 当前激活值
+        std::vector<double> propagated;    ///< 下一层加权和中已反映的激活值
+    };
+    
+    IncrementalInference() = default;
+    
+    /**
+     * @brief 从当前输入完整重算所有层
+     */
+    void recomputeAll();
+    
+    /**
+     * @brief 把一列输入变化量累加到某层的加权和
+     */
+    void applyColumn(LayerState& layer, size_t column, double delta);
+    
+    std::vector<LayerState> layers_;       ///< 各层缓存
+    std::vector<double> inputs_;           ///< 当前输入
+    std::vector<size_t> changed_;          ///< 本层变化的下标（临时）
+    std::vector<double> changed_deltas_;   ///< 本层变化量（临时）
+    std::vector<size_t> next_changed_;     ///< 下一层变化的下标（临时）
+    std::vector<double> next_deltas_;      ///< 下一层变化量（临时）
+    double tolerance_ = 0.0;               ///< 传播容差
+    size_t resync_interval_ = 0;           ///< 完整重算间隔
+    size_t updates_since_resync_ = 0;      ///< 上次完整重算后的增量更新次数
+    size_t last_cost_ = 0;                 ///< 最近一次更新的乘加次数
+    size_t full_cost_ = 0;                 ///< 完整前向传播的乘加次数
+    bool primed_ = false;                  ///< 是否已reset
+};
+
+} // namespace neural_network
+
+#endif // INCREMENTAL_INFERENCE_H
@@ -0,0 +1,162 @@
+#include "inference_cache.h"
+#include <cstring>
+
+namespace neural_network {
+
+namespace {
+
+constexpr size_t kDefaultShards = 16;
+
+inline uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t fmix64(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+inline bool sameInputs(const std::vector<double>& a, const std::vector<double>& b) {
+    // 按字节比较，使-0.0与0.0、NaN的处理与哈希一致
+    return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(double)) == 0);
+}
+
+} // namespace
+
+InferenceCache::InferenceCache(size_t capacityBytes, size_t numShards)
+    : shards_(nullptr), num_shards_(numShards == 0 ? kDefaultShards : numShards),
+      capacity_(capacityBytes), shard_capacity_(0), generation_(0) {
+    shards_.reset(new Shard[num_shards_]);
+    shard_capacity_ = capacity_ / num_shards_;
+}
+
+uint64_t InferenceCache::hashInputs(const double* data, size_t count) {
+    // MurmurHash3风格的逐字混合，每个double一次乘法和旋转
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ (count * 0xff51afd7ed558ccdULL);
+    for (size_t i = 0; i < count; i++) {
+        uint64_t k;
+        std::memcpy(&k, data + i, sizeof(k));
+        k *= 0x87c37b91114253d5ULL;
+        k = rotl(k, 31);
+        k *= 0x4cf5ad432745937fULL;
+        h ^= k;
+        h = rotl(h, 27) * 5 + 0x52dce729;
+    }
+    return fmix64(h);
+}
+
+InferenceCache::Shard& InferenceCache::shardFor(uint64_t hash) {
+    return shards_[(hash >> 32) % num_shards_];
+}
+
+void InferenceCache::Shard::erase(std::unordered_map<uint64_t, std::list<Entry>::iterator>::iterator it) {
+    bytes -= it->second->bytes;
+    lru.erase(it->second);
+    index.erase(it);
+}
+
+bool InferenceCache::lookup(const std::vector<double>& inputs, std::vector<double>& outputs, uint64_t& generation) {
+    uint64_t hash = hashInputs(inputs.data(), inputs.size());
+    generation = generation_.load(std::memory_order_acquire);
+    Shard& shard = shardFor(hash);
+    
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(hash);
+    if (it == shard.index.end()) {
+        shard.misses++;
+        return false;
+    }
+    if (it->second->generation != generation) {
+        // 权重已改变，顺便回收过期条目
+        shard.erase(it);
+        shard.misses++;
+        return false;
+    }
+    if (!sameInputs(it->second->inputs, inputs)) {
+        shard.misses++;
+        return false;
+    }
+    
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    outputs = it->second->outputs;
+    shard.hits++;
+    return true;
+}
+
+void InferenceCache::insert(const std::vector<double>& inputs, const std::vector<double>& outputs,
+                            uint64_t generation) {
+    size_t bytes = sizeof(Entry) + (inputs.size() + outputs.size()) * sizeof(double) +
+                   sizeof(std::pair<const uint64_t, std::list<Entry>::iterator>) + 4 * sizeof(void*);
+    if (bytes > shard_capacity_) {
+        return;
+    }
+    
+    uint64_t hash = hashInputs(inputs.data(), inputs.size());
+    Shard& shard = shardFor(hash);
+    
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    
+    // 计算期间权重已改变：丢弃结果。此后再失效的条目带有旧代数，查找时同样视为未命中
+    if (generation != generation_.load(std::memory_order_acquire)) {
+        return;
+    }
+    auto it = shard.index.find(hash);
+    if (it != shard.index.end()) {
+        // 相同输入的旧结果或哈希冲突的条目，由新结果取代
+        shard.erase(it);
+    }
+    
+    while (shard.bytes + bytes > shard_capacity_ && !shard.lru.empty()) {
+        shard.erase(shard.index.find(shard.lru.back().hash));
+        shard.evictions++;
+    }
+    
+    shard.lru.push_front(Entry{hash, generation, inputs, outputs, bytes});
+    shard.index[hash] = shard.lru.begin();
+    shard.bytes += bytes;
+}
+
+void InferenceCache::invalidate() {
+    generation_.fetch_add(1, std::memory_order_acq_rel);
+}
+
+uint64_t InferenceCache::getGeneration() const {
+    return generation_.load(std::memory_order_acquire);
+}
+
+void InferenceCache::clear() {
+    for (size_t i = 0; i < num_shards_; i++) {
+        Shard& shard = shards_[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.lru.clear();
+        shard.index.clear();
+        shard.bytes = 0;
+        shard.hits = 0;
+        shard.misses = 0;
+        shard.evictions = 0;
+    }
+}
+
+InferenceCacheStats InferenceCache::getStats() const {
+    InferenceCacheStats stats;
+    for (size_t i = 0; i < num_shards_; i++) {
+        const Shard& shard = shards_[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.hits += shard.hits;
+        stats.misses += shard.misses;
+        stats.evictions += shard.evictions;
+        stats.entries += shard.lru.size();
+        stats.bytes += shard.bytes;
+    }
+    return stats;
+}
+
+size_t InferenceCache::getCapacity() const {
+    return capacity_;
+}
+
+} // namespace neural_network
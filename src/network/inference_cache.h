@@ -0,0 +1,147 @@
+#ifndef INFERENCE_CACHE_H
+#define INFERENCE_CACHE_H
+
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+namespace neural_network {
+
+/**
+ * @brief 推理缓存统计信息
+ */
+struct InferenceCacheStats {
+    uint64_t hits = 0;          ///< 命中次数
+    uint64_t misses = 0;        ///< 未命中次数
+    uint64_t evictions = 0;     ///< 因容量不足淘汰的条目数
+    size_t entries = 0;         ///< 当前条目数（可能包含已失效但尚未淘汰的条目）
+    size_t bytes = 0;           ///< 当前占用字节数
+};
+
+/**
+ * @brief 线程安全的分片LRU推理结果缓存
+ * 
+ * 以输入向量字节的64位哈希为键，命中时再逐字节比较完整输入，
+ * 因此哈希冲突不会返回错误结果。每个分片有独立的互斥锁和LRU链表，
+ * 容量按字节计算并平均分配到各分片。
+ * 
+ * invalidate()只递增代数，旧代数的条目在查找时视为未命中并被回收，
+ * 因此每次训练后使缓存失效的代价为O(1)。
+ */
+class InferenceCache {
+public:
+    /**
+     * @brief 构造函数
+     * @param capacityBytes 总容量（字节）
+     * @param numShards 分片数量，0表示16
+     */
+    explicit InferenceCache(size_t capacityBytes, size_t numShards = 0);
+    
+    InferenceCache(const InferenceCache&) = delete;
+    InferenceCache& operator=(const InferenceCache&) = delete;
+    
+    /**
+     * @brief 查找缓存结果
+     * @param inputs 输入值向量
+     * @param outputs 命中时写入缓存的输出
+     * @param generation 写入查找时的代数，未命中时计算出的结果应以此代数插入
+     * @return 是否命中
+     */
+    bool lookup(const std::vector<double>& inputs, std::vector<double>& outputs, uint64_t& generation);
+    
+    /**
+     * @brief 插入推理结果，必要时淘汰最久未使用的条目
+     * 
+     * 计算期间发生过invalidate()时，结果可能来自旧权重，不会被插入。
+     * @param inputs 输入值向量
+     * @param outputs 输出值向量
+     * @param generation 开始计算前观察到的代数（lookup或getGeneration的返回值）
+     */
+    void insert(const std::vector<double>& inputs, const std::vector<double>& outputs, uint64_t generation);
+    
+    /**
+     * @brief 使所有现有条目失效（权重改变后调用）
+     */
+    void invalidate();
+    
+    /**
+     * @brief 获取当前代数
+     * @return 代数
+     */
+    uint64_t getGeneration() const;
+    
+    /**
+     * @brief 清空缓存并重置统计
+     */
+    void clear();
+    
+    /**
+     * @brief 获取统计信息
+     * @return 各分片统计之和
+     */
+    InferenceCacheStats getStats() const;
+    
+    /**
+     * @brief 获取总容量
+     * @return 容量（字节）
+     */
+    size_t getCapacity() const;
+    
+    /**
+     * @brief 计算输入向量字节的哈希值
+     * @param data 输入数据
+     * @param count 元素数量
+     * @return 64位哈希值
+     */
+    static uint64_t hashInputs(const double* data, size_t count);
+
+private:
+    /**
+     * @brief 缓存条目
+     */
+    struct Entry {
+        uint64_t hash;                  ///< 输入哈希
+        uint64_t generation;            ///< 计算结果时的代数
+        std::vector<double> inputs;     ///< 完整输入（用于确认命中）
+        std::vector<double> outputs;    ///< 输出
+        size_t bytes;                   ///< 条目占用字节数
+    };
+    
+    /**
+     * @brief 缓存分片
+     */
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> lru;   ///< 表头为最近使用
+        std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+        size_t bytes = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        
+        /**
+         * @brief 移除一个条目（调用者持有锁）
+         */
+        void erase(std::unordered_map<uint64_t, std::list<Entry>::iterator>::iterator it);
+    };
+    
+    /**
+     * @brief 根据哈希值选择分片
+     */
+    Shard& shardFor(uint64_t hash);
+    
+    std::unique_ptr<Shard[]> shards_;       ///< 分片数组
+    size_t num_shards_;                     ///< 分片数量
+    size_t capacity_;                       ///< 总容量
+    size_t shard_capacity_;                 ///< 每个分片的容量
+    std::atomic<uint64_t> generation_;      ///< 当前代数
+};
+
+} // namespace neural_network
+
+#endif // INFERENCE_CACHE_H
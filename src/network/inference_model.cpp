@@ -0,0 +1,84 @@
+#include "inference_model.h"
+#include "network.h"
+#include "dense_kernel.h"
+#include <algorithm>
+
+namespace neural_network {
+
+std::shared_ptr<InferenceModel> InferenceModel::fromNetwork(const Network& network) {
+    std::shared_ptr<InferenceModel> model(new InferenceModel());
+    
+    size_t total = 0;
+    for (size_t i = 0; i < network.getLayerCount(); i++) {
+        auto layer = network.getLayer(i);
+        if (layer->typeName() != "dense") {
+            return nullptr;
+        }
+        // 每层只记录一个激活函数，神经元激活函数不一致的层无法导出
+        const auto& neurons = layer->getNeurons();
+        for (const auto& neuron : neurons) {
+            if (neuron->getActivationType() != neurons[0]->getActivationType()) {
+                return nullptr;
+            }
+        }
+        LayerInfo info;
+        info.rows = layer->size();
+        info.cols = layer->inputSize();
+        info.offset = total;
+        info.activation = layer->size() > 0 ? layer->getNeurons()[0]->getActivationType() : ActivationType::SIGMOID;
+        total += info.rows * info.cols + info.rows;
+        model->max_width_ = std::max(model->max_width_, std::max(info.rows, info.cols));
+        model->layers_.push_back(info);
+    }
+    
+    model->data_.resize(total);
+    for (size_t i = 0; i < model->layers_.size(); i++) {
+        const LayerInfo& info = model->layers_[i];
+        const auto& neurons = network.getLayer(i)->getNeurons();
+        double* weights = model->data_.data() + info.offset;
+        double* biases = weights + info.rows * info.cols;
+        for (size_t j = 0; j < info.rows; j++) {
+            const auto& row = neurons[j]->getWeights();
+            std::copy(row.begin(), row.end(), weights + j * info.cols);
+            biases[j] = neurons[j]->getBias();
+        }
+    }
+    
+    return model;
+}
+
+std::vector<double> InferenceModel::predict(const std::vector<double>& inputs) const {
+    std::vector<double> current = inputs;
+    current.resize(std::max(current.size(), max_width_), 0.0);
+    std::vector<double> next(max_width_);
+    
+    size_t width = inputs.size();
+    for (const LayerInfo& info : layers_) {
+        const double* weights = data_.data() + info.offset;
+        denseForward(weights, weights + info.rows * info.cols, info.rows, info.cols,
+                     info.activation, current.data(), next.data());
+        current.swap(next);
+        width = info.rows;
+    }
+    
+    current.resize(width);
+    return current;
+}
+
+size_t InferenceModel::getLayerCount() const {
+    return layers_.size();
+}
+
+std::vector<LayerMemoryUsage> InferenceModel::getMemoryUsage() const {
+    std::vector<LayerMemoryUsage> usage;
+    for (const LayerInfo& info : layers_) {
+        LayerMemoryUsage layer;
+        layer.type = "dense";
+        layer.parameter_bytes = (info.rows * info.cols + info.rows) * sizeof(double);
+        layer.overhead_bytes = sizeof(LayerInfo);
+        usage.push_back(layer);
+    }
+    return usage;
+}
+
+} // namespace neural_network
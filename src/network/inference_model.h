@@ -0,0 +1,71 @@
+#ifndef INFERENCE_MODEL_H
+#define INFERENCE_MODEL_H
+
+#include <vector>
+#include <memory>
+#include <string>
+#include "../neuron/neuron.h"
+#include "layer.h"
+
+namespace neural_network {
+
+class Network;
+
+/**
+ * @brief 只用于推理的冻结模型
+ * 
+ * 只保留连续存放的权重、偏置和每层的激活函数类型，不含梯度、
+ * 前向缓存、神经元对象和std::function，内存约等于参数本身。
+ * 推理结果与FLOAT64精度网络的predict逐位一致（bfloat16层导出其double主副本），
+ * 且可在多线程中并发调用。
+ * 仅支持以ActivationType设置激活函数的全连接层。
+ */
+class InferenceModel {
+public:
+    /**
+     * @brief 从网络导出冻结模型
+     * @param network 源网络
+     * @return 冻结模型，网络包含不支持的层类型或神经元激活函数不一致的层时返回nullptr
+     */
+    static std::shared_ptr<InferenceModel> fromNetwork(const Network& network);
+    
+    /**
+     * @brief 前向推理
+     * @param inputs 输入值向量
+     * @return 输出值向量
+     */
+    std::vector<double> predict(const std::vector<double>& inputs) const;
+    
+    /**
+     * @brief 获取层数
+     * @return 层数
+     */
+    size_t getLayerCount() const;
+    
+    /**
+     * @brief 获取每层的内存占用
+     * @return 每层内存占用
+     */
+    std::vector<LayerMemoryUsage> getMemoryUsage() const;
+
+private:
+    /**
+     * @brief 层描述
+     */
+    struct LayerInfo {
+        size_t rows;                 ///< 神经元数量
+        size_t cols;                 ///< 输入数量
+        size_t offset;               ///< 权重在data_中的偏移，偏置紧随其后
+        ActivationType activation;   ///< 激活函数类型
+    };
+    
+    InferenceModel() = default;
+    
+    std::vector<LayerInfo> layers_;  ///< 各层描述
+    std::vector<double> data_;       ///< 所有层的权重和偏置
+    size_t max_width_ = 0;           ///< 最大层宽度
+};
+
+} // namespace neural_network
+
+#endif // INFERENCE_MODEL_H
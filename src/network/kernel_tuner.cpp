@@ -0,0 +1,248 @@
+#include "kernel_tuner.h"
+#include "network.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+namespace neural_network {
+
+namespace {
+
+const char* variantName(KernelVariant variant) {
+    switch (variant) {
+        case KernelVariant::NEURON_MAJOR: return "neuron_major";
+        case KernelVariant::PACKED_ROWS:  return "packed_rows";
+        case KernelVariant::BLOCKED_GEMM: return "blocked_gemm";
+        case KernelVariant::DIRECT:       return "direct";
+        default:                          return "default";
+    }
+}
+
+bool parseVariant(const std::string& name, KernelVariant& variant) {
+    const KernelVariant variants[] = {KernelVariant::DEFAULT, KernelVariant::NEURON_MAJOR,
+                                      KernelVariant::PACKED_ROWS, KernelVariant::BLOCKED_GEMM,
+                                      KernelVariant::DIRECT};
+    for (KernelVariant candidate : variants) {
+        if (name == variantName(candidate)) {
+            variant = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+KernelTuner::KernelTuner(const std::string& cacheFile)
+    : cache_file_(cacheFile), cpu_model_(cpuModel()) {
+    load();
+}
+
+size_t KernelTuner::tune(const Network& network, size_t batchSize, bool force) {
+    return run(network, batchSize, true, force);
+}
+
+size_t KernelTuner::apply(const Network& network, size_t batchSize) {
+    return run(network, batchSize, false, false);
+}
+
+size_t KernelTuner::run(const Network& network, size_t batchSize, bool benchmark, bool force) {
+    if (network.getLayerCount() == 0) {
+        return 0;
+    }
+    
+    // 用固定种子的随机输入逐层前向，使每层都在实际形状的批次上测试
+    std::vector<std::vector<double>> batch;
+    if (benchmark) {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+        batch.assign(std::max<size_t>(1, batchSize), std::vector<double>(network.getLayer(0)->inputSize()));
+        for (auto& sample : batch) {
+            for (auto& value : sample) {
+                value = dist(rng);
+            }
+        }
+    }
+    
+    size_t count = 0;
+    bool updated = false;
+    for (size_t i = 0; i < network.getLayerCount(); i++) {
+        std::shared_ptr<Layer> layer = network.getLayer(i);
+        const std::string shape = layer->kernelShapeKey();
+        if (!shape.empty()) {
+            const std::string key = entryKey(shape, batchSize);
+            TunedKernel tuned;
+            bool found = false;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = entries_.find(key);
+                if (it != entries_.end() && !(benchmark && force)) {
+                    tuned = it->second;
+                    found = true;
+                }
+            }
+            if (found) {
+                layer->setKernelConfig(tuned.config);
+                if (!benchmark) {
+                    count++;
+                }
+            } else if (benchmark) {
+                tuned = benchmarkLayer(*layer, batch);
+                layer->setKernelConfig(tuned.config);
+                std::lock_guard<std::mutex> lock(mutex_);
+                entries_[key] = tuned;
+                updated = true;
+                count++;
+            }
+        }
+        if (benchmark) {
+            batch = layer->predictBatch(batch);
+        }
+    }
+    
+    if (updated && !cache_file_.empty()) {
+        save();
+    }
+    return count;
+}
+
+TunedKernel KernelTuner::benchmarkLayer(Layer& layer, const std::vector<std::vector<double>>& batch) {
+    using Clock = std::chrono::steady_clock;
+    const size_t max_threads = std::max<unsigned>(1, std::thread::hardware_concurrency());
+    
+    TunedKernel best;
+    best.config = layer.getKernelConfig();
+    best.nanoseconds = std::numeric_limits<double>::infinity();
+    for (const KernelConfig& config : layer.kernelCandidates(max_threads)) {
+        layer.setKernelConfig(config);
+        layer.predictBatch(batch);  // 预热
+        
+        // 取多次运行的最小值，减少调度和缓存状态的干扰
+        double fastest = std::numeric_limits<double>::infinity();
+        double total = 0.0;
+        for (size_t run = 0; run < kMinBenchmarkRuns || total < kMinBenchmarkSeconds; run++) {
+            const auto start = Clock::now();
+            layer.predictBatch(batch);
+            const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            fastest = std::min(fastest, seconds);
+            total += seconds;
+        }
+        if (fastest * 1e9 < best.nanoseconds) {
+            best.config = config;
+            best.nanoseconds = fastest * 1e9;
+        }
+    }
+    return best;
+}
+
+bool KernelTuner::load() {
+    if (cache_file_.empty()) {
+        return false;
+    }
+    std::ifstream file(cache_file_);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    // 每行：CPU型号\t形状\t批大小\t变体\t行分块\t归约分块\t列分块\t线程数\t纳秒；
+    // 格式错误的行只跳过该行，其余调优结果仍然有效
+    std::map<std::string, TunedKernel> loaded;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::vector<std::string> fields;
+        std::istringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, '\t')) {
+            fields.push_back(field);
+        }
+        if (fields.size() != 9) {
+            continue;
+        }
+        
+        TunedKernel tuned;
+        std::istringstream numbers(fields[2] + " " + fields[4] + " " + fields[5] + " " + fields[6] + " " +
+                                   fields[7] + " " + fields[8]);
+        size_t batch_size = 0;
+        if (!parseVariant(fields[3], tuned.config.variant) ||
+            !(numbers >> batch_size >> tuned.config.blocking.rows >> tuned.config.blocking.depth >>
+              tuned.config.blocking.cols >> tuned.config.threads >> tuned.nanoseconds)) {
+            continue;
+        }
+        loaded[fields[0] + "|" + fields[1] + "|" + std::to_string(batch_size)] = tuned;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& entry : loaded) {
+        entries_[entry.first] = entry.second;
+    }
+    return true;
+}
+
+bool KernelTuner::save() const {
+    if (cache_file_.empty()) {
+        return false;
+    }
+    // 先写临时文件再原子改名，同时启动的进程不会读到或留下写了一半的缓存文件
+    const std::string temp_name = cache_file_ + ".tmp." + std::to_string(getpid());
+    std::ofstream file(temp_name);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    file << "# cpu\tshape\tbatch\tvariant\tblock_rows\tblock_depth\tblock_cols\tthreads\tns\n";
+    for (const auto& entry : entries_) {
+        // 键为"CPU型号|形状|批大小"，形状中不含'|'，CPU型号可能含有
+        const std::string& key = entry.first;
+        const size_t batch_pos = key.rfind('|');
+        const size_t shape_pos = key.rfind('|', batch_pos - 1);
+        const KernelConfig& config = entry.second.config;
+        file << key.substr(0, shape_pos) << '\t' << key.substr(shape_pos + 1, batch_pos - shape_pos - 1) << '\t'
+             << key.substr(batch_pos + 1) << '\t' << variantName(config.variant) << '\t'
+             << config.blocking.rows << '\t' << config.blocking.depth << '\t' << config.blocking.cols << '\t'
+             << config.threads << '\t' << entry.second.nanoseconds << '\n';
+    }
+    file.close();
+    if (!file || std::rename(temp_name.c_str(), cache_file_.c_str()) != 0) {
+        std::remove(temp_name.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::map<std::string, TunedKernel> KernelTuner::getEntries() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_;
+}
+
+std::string KernelTuner::cpuModel() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.compare(0, 10, "model name") == 0) {
+            const size_t colon = line.find(':');
+            if (colon != std::string::npos) {
+                const size_t begin = line.find_first_not_of(" \t", colon + 1);
+                if (begin != std::string::npos) {
+                    return line.substr(begin);
+                }
+            }
+        }
+    }
+    return "unknown";
+}
+
+std::string KernelTuner::entryKey(const std::string& shape, size_t batchSize) const {
+    return cpu_model_ + "|" + shape + "|" + std::to_string(batchSize);
+}
+
+} // namespace neural_network
@@ -0,0 +1,119 @@
+#ifndef KERNEL_TUNER_H
+#define KERNEL_TUNER_H
+
+#include "layer.h"
+#include <map>
+#include <mutex>
+#include <string>
+#include <cstddef>
+
+namespace neural_network {
+
+class Network;
+
+/**
+ * @brief 调优结果
+ */
+struct TunedKernel {
+    KernelConfig config;        ///< 选中的内核配置
+    double nanoseconds = 0.0;   ///< 选中配置每批次的耗时（纳秒）
+};
+
+/**
+ * @brief 运行时内核调优器
+ * 
+ * 对网络中每个可调优层的每个候选内核配置（计算变体、GEMM分块大小、线程数）
+ * 在实际形状的随机批次上做微基准测试，选择最快者并写入层。结果以
+ * （CPU型号，层形状，批大小）为键缓存，并可持久化到文本文件，
+ * 之后在同一台机器上加载同样形状的网络时无需重新测试。
+ * 
+ * 全连接层的各候选配置结果逐位一致；卷积层在直接卷积与im2col之间切换时
+ * 输出可能有舍入级差异。调优器本身是线程安全的。
+ */
+class KernelTuner {
+public:
+    /**
+     * @brief 构造函数，缓存文件存在时立即加载
+     * @param cacheFile 调优缓存文件路径，空字符串表示只在内存中缓存
+     */
+    explicit KernelTuner(const std::string& cacheFile = "");
+    
+    KernelTuner(const KernelTuner&) = delete;
+    KernelTuner& operator=(const KernelTuner&) = delete;
+    
+    /**
+     * @brief 为网络的每个可调优层选择内核配置
+     * 
+     * 缓存中已有的形状直接应用缓存结果，其余形状做微基准测试；
+     * 有新结果且设置了缓存文件时自动保存。
+     * @param network 网络
+     * @param batchSize 调优使用的批大小
+     * @param force 是否忽略缓存重新测试
+     * @return 本次做了基准测试的层数
+     */
+    size_t tune(const Network& network, size_t batchSize = 64, bool force = false);
+    
+    /**
+     * @brief 只应用缓存中已有的结果，不做基准测试
+     * @param network 网络
+     * @param batchSize 批大小
+     * @return 应用了缓存结果的层数
+     */
+    size_t apply(const Network& network, size_t batchSize = 64);
+    
+    /**
+     * @brief 从缓存文件加载调优结果（与内存中的结果合并），格式错误的行被跳过
+     * @return 缓存文件无法打开时返回false
+     */
+    bool load();
+    
+    /**
+     * @brief 将调优结果保存到缓存文件（写入临时文件后原子改名）
+     * @return 是否保存成功
+     */
+    bool save() const;
+    
+    /**
+     * @brief 获取所有调优结果
+     * @return 以"CPU型号|形状|批大小"为键的调优结果
+     */
+    std::map<std::string, TunedKernel> getEntries() const;
+    
+    /**
+     * @brief 获取当前CPU型号（读取/proc/cpuinfo，无法读取时返回"unknown"）
+     * @return CPU型号
+     */
+    static std::string cpuModel();
+
+private:
+    std::string cache_file_;                         ///< 缓存文件路径
+    std::string cpu_model_;                          ///< 当前CPU型号
+    std::map<std::string, TunedKernel> entries_;     ///< 调优结果
+    mutable std::mutex mutex_;                       ///< 保护entries_
+    
+    static constexpr double kMinBenchmarkSeconds = 0.005;  ///< 每个候选配置的最短测试时间
+    static constexpr size_t kMinBenchmarkRuns = 3;          ///< 每个候选配置的最少测试次数
+    
+    /**
+     * @brief 生成缓存键
+     */
+    std::string entryKey(const std::string& shape, size_t batchSize) const;
+    
+    /**
+     * @brief 对一个层的所有候选配置做基准测试
+     * @param layer 层
+     * @param batch 该层的实际输入批次
+     * @return 最快的配置
+     */
+    static TunedKernel benchmarkLayer(Layer& layer, const std::vector<std::vector<double>>& batch);
+    
+    /**
+     * @brief 应用缓存结果，benchmark为true时对缺失（或force时全部）形状做基准测试
+     * @return 应用或测试的层数
+     */
+    size_t run(const Network& network, size_t batchSize, bool benchmark, bool force);
+};
+
+} // namespace neural_network
+
+#endif // KERNEL_TUNER_H
@@ -1,24 +1,52 @@
 #include "layer.h"
 #include "../neuron/neuron.h"
+#include "../neuron/philox.h"
+#include "dense_kernel.h"
+#include "tracer.h"
 #include <algorithm>
+#include <cmath>
+#include <thread>
 
 namespace neural_network {
     
 Layer::Layer(size_t numNeurons, size_t numInputs) 
-    : last_inputs_(numInputs), last_outputs_(numNeurons) {
+    : num_inputs_(numInputs), last_inputs_(numInputs), last_outputs_(numNeurons),
+      init_scheme_(WeightInitScheme::UNIFORM), frozen_(false), precision_(PrecisionType::FLOAT64) {
     // 创建指定数量的神经元
     for (size_t i = 0; i < numNeurons; i++) {
         neurons_.push_back(std::make_shared<Neuron>(numInputs));
     }
 }
 
+Layer::Layer(size_t numOutputs, size_t numInputs, WeightInitScheme scheme)
+    : num_inputs_(numInputs), last_inputs_(numInputs), last_outputs_(numOutputs),
+      init_scheme_(scheme), frozen_(false), precision_(PrecisionType::FLOAT64) {}
+
 std::vector<double> Layer::forward(const std::vector<double>& inputs) {
-    // 存储输入和输出用于反向传播
-    last_inputs_ = inputs;
-    
+    NN_TRACE_SCOPE_ARG("layer", "Layer::forward", "neurons", neurons_.size());
     std::vector<double> outputs;
     outputs.reserve(neurons_.size());
     
+    if (precision_ == PrecisionType::BFLOAT16) {
+        // 输入以bfloat16缓存，权重使用bfloat16副本，累加使用float
+        last_inputs_bf16_.resize(inputs.size());
+        for (size_t k = 0; k < inputs.size(); k++) {
+            last_inputs_bf16_[k] = BFloat16::fromDouble(inputs[k]);
+        }
+        
+        // 缓存未舍入的输出供反向传播求导，传给下一层的输出舍入到bfloat16
+        last_outputs_.resize(neurons_.size());
+        for (size_t j = 0; j < neurons_.size(); j++) {
+            last_outputs_[j] = neurons_[j]->activate(packedSum(j, last_inputs_bf16_));
+            outputs.push_back(roundToBFloat16(last_outputs_[j]));
+        }
+        
+        return outputs;
+    }
+    
+    // 存储输入和输出用于反向传播
+    last_inputs_ = inputs;
+    
     // 对每个神经元执行前向传播
     for (auto& neuron : neurons_) {
         outputs.push_back(neuron->forward(inputs));
@@ -28,6 +56,262 @@ std::vector<double> Layer::forward(const std::vector<double>& inputs) {
     return outputs;
 }
 
+std::vector<double> Layer::predict(const std::vector<double>& inputs) const {
+    return predictBatch({inputs}).front();
+}
+
+std::vector<std::vector<double>> Layer::predictBatch(const std::vector<std::vector<double>>& batch) const {
+    std::vector<std::vector<double>> outputs(batch.size(), std::vector<double>(neurons_.size()));
+    
+    if (precision_ == PrecisionType::BFLOAT16) {
+        std::vector<std::vector<BFloat16>> packed_batch(batch.size());
+        for (size_t s = 0; s < batch.size(); s++) {
+            packed_batch[s].resize(batch[s].size());
+            for (size_t k = 0; k < batch[s].size(); k++) {
+                packed_batch[s][k] = BFloat16::fromDouble(batch[s][k]);
+            }
+        }
+        for (size_t j = 0; j < neurons_.size(); j++) {
+            for (size_t s = 0; s < batch.size(); s++) {
+                outputs[s][j] = roundToBFloat16(neurons_[j]->applyActivation(packedSum(j, packed_batch[s])));
+            }
+        }
+        return outputs;
+    }
+    
+    const size_t threads = std::max<size_t>(1, std::min(kernel_config_.threads, batch.size()));
+    if (threads == 1) {
+        predictRange(batch, 0, batch.size(), outputs);
+        return outputs;
+    }
+    
+    // 样本按连续区间分给各线程，每个样本的结果与单线程相同
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            NN_TRACE_SCOPE_ARG("thread", "Layer::predictBatch worker", "thread", t);
+            predictRange(batch, t * batch.size() / threads, (t + 1) * batch.size() / threads, outputs);
+        });
+    }
+    predictRange(batch, 0, batch.size() / threads, outputs);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return outputs;
+}
+
+void Layer::predictRange(const std::vector<std::vector<double>>& batch, size_t begin, size_t end,
+                         std::vector<std::vector<double>>& outputs) const {
+    const size_t rows = neurons_.size();
+    const size_t cols = num_inputs_;
+    KernelVariant variant = kernel_config_.variant;
+    for (size_t s = begin; s < end && variant != KernelVariant::NEURON_MAJOR; s++) {
+        // 打包变体要求输入长度与层一致，否则退回逐神经元计算
+        if (batch[s].size() != cols) {
+            variant = KernelVariant::NEURON_MAJOR;
+        }
+    }
+    
+    if (variant != KernelVariant::PACKED_ROWS && variant != KernelVariant::BLOCKED_GEMM) {
+        for (size_t j = 0; j < rows; j++) {
+            for (size_t s = begin; s < end; s++) {
+                outputs[s][j] = neurons_[j]->predict(batch[s]);
+            }
+        }
+        return;
+    }
+    
+    std::vector<double> weights(rows * cols);
+    std::vector<double> biases(rows);
+    for (size_t j = 0; j < rows; j++) {
+        const auto& row = neurons_[j]->getWeights();
+        std::copy(row.begin(), row.end(), weights.begin() + j * cols);
+        biases[j] = neurons_[j]->getBias();
+    }
+    const ActivationType activation = rows > 0 ? neurons_[0]->getActivationType() : ActivationType::SIGMOID;
+    
+    if (variant == KernelVariant::PACKED_ROWS) {
+        for (size_t s = begin; s < end; s++) {
+            denseForward(weights.data(), biases.data(), rows, cols, activation, batch[s].data(), outputs[s].data());
+        }
+        return;
+    }
+    
+    // 整批矩阵乘法：输入转置为cols x n，每个元素仍按输入顺序累加，与Neuron::predict逐位一致
+    const size_t n = end - begin;
+    std::vector<double> inputs_t(cols * n);
+    for (size_t s = 0; s < n; s++) {
+        for (size_t k = 0; k < cols; k++) {
+            inputs_t[k * n + s] = batch[begin + s][k];
+        }
+    }
+    std::vector<double> sums(rows * n, 0.0);
+    gemmBlocked(rows, n, cols, weights.data(), inputs_t.data(), sums.data(), kernel_config_.blocking);
+    for (size_t j = 0; j < rows; j++) {
+        for (size_t s = 0; s < n; s++) {
+            outputs[begin + s][j] = applyActivation(activation, sums[j * n + s] + biases[j]);
+        }
+    }
+}
+
+std::vector<double> Layer::backward(const std::vector<double>& errors, double gradientScale,
+                                    bool propagateErrors) {
+    NN_TRACE_SCOPE_ARG("layer", "Layer::backward", "neurons", neurons_.size());
+    std::vector<double> scratch;
+    const std::vector<double>& layer_inputs = inputsForBackprop(scratch);
+    
+    std::vector<std::vector<double>> weight_gradients(neurons_.size());
+    std::vector<double> bias_gradients(neurons_.size());
+    
+    std::vector<double> prev_errors;
+    if (propagateErrors) {
+        prev_errors.resize(num_inputs_, 0.0);
+    }
+    
+    for (size_t j = 0; j < neurons_.size(); j++) {
+        const auto& neuron = neurons_[j];
+        double derivative = neuron->computeActivationDerivative(last_outputs_[j]);
+        
+        // 计算梯度（去除梯度缩放）
+        double error_term = errors[j] * derivative;
+        bias_gradients[j] = error_term / gradientScale;
+        
+        // 计算权重梯度
+        const auto& weights = neuron->getWeights();
+        weight_gradients[j].resize(weights.size());
+        for (size_t k = 0; k < weights.size(); k++) {
+            weight_gradients[j][k] = error_term * layer_inputs[k] / gradientScale;
+        }
+        
+        // 传播误差到前一层
+        if (propagateErrors) {
+            for (size_t k = 0; k < weights.size(); k++) {
+                prev_errors[k] += errors[j] * weights[k];
+            }
+        }
+    }
+    
+    setGradients(weight_gradients, bias_gradients);
+    return prev_errors;
+}
+
+std::vector<std::vector<double>> Layer::forwardBatch(const std::vector<std::vector<double>>& batch) {
+    std::vector<std::vector<double>> outputs(batch.size());
+    batch_caches_.resize(batch.size());
+    for (size_t s = 0; s < batch.size(); s++) {
+        outputs[s] = forward(batch[s]);
+        takeCache(batch_caches_[s]);
+    }
+    return outputs;
+}
+
+std::vector<std::vector<double>> Layer::backwardBatch(const std::vector<std::vector<double>>& errors,
+                                                      bool propagateErrors) {
+    const size_t count = parameterCount();
+    std::vector<double> sum(count, 0.0);
+    std::vector<double> gradients(count);
+    std::vector<std::vector<double>> prev_errors(propagateErrors ? errors.size() : 0);
+    
+    for (size_t s = 0; s < errors.size() && s < batch_caches_.size(); s++) {
+        restoreCache(batch_caches_[s]);
+        std::vector<double> sample_errors = backward(errors[s], 1.0, propagateErrors);
+        if (propagateErrors) {
+            prev_errors[s] = std::move(sample_errors);
+        }
+        exportGradients(gradients.data());
+        for (size_t p = 0; p < count; p++) {
+            sum[p] += gradients[p];
+        }
+    }
+    
+    if (!errors.empty()) {
+        for (auto& value : sum) {
+            value /= static_cast<double>(errors.size());
+        }
+    }
+    importGradients(sum.data());
+    batch_caches_.clear();
+    return prev_errors;
+}
+
+double Layer::outputDerivative(size_t index, double output) const {
+    return neurons_[index]->computeActivationDerivative(output);
+}
+
+std::string Layer::typeName() const {
+    return "dense";
+}
+
+void Layer::save(std::ostream& out, PrecisionType precision) const {
+    auto convert = [precision](double value) {
+        return precision == PrecisionType::BFLOAT16 ? roundToBFloat16(value) : value;
+    };
+    
+    // 全部使用Sigmoid的层沿用旧格式，其余写出类型和激活函数
+    ActivationType activation = neurons_.empty() ? ActivationType::SIGMOID : neurons_[0]->getActivationType();
+    if (activation == ActivationType::SIGMOID) {
+        out << neurons_.size() << " " << num_inputs_ << std::endl;
+    } else {
+        out << typeName() << " " << neurons_.size() << " " << num_inputs_ << " "
+            << activationName(activation) << std::endl;
+    }
+    
+    // 写入每个神经元的信息
+    for (const auto& neuron : neurons_) {
+        // 写入偏置
+        out << convert(neuron->getBias()) << std::endl;
+        
+        // 写入权重
+        const auto& weights = neuron->getWeights();
+        for (size_t k = 0; k < weights.size(); k++) {
+            out << convert(weights[k]);
+            if (k < weights.size() - 1) {
+                out << " ";
+            }
+        }
+        out << std::endl;
+    }
+}
+
+bool Layer::loadParameters(std::istream& in) {
+    for (auto& neuron : neurons_) {
+        // 读取偏置
+        double bias;
+        in >> bias;
+        neuron->setBias(bias);
+        
+        // 读取权重
+        std::vector<double> weights(num_inputs_);
+        for (size_t k = 0; k < num_inputs_; k++) {
+            in >> weights[k];
+        }
+        neuron->setWeights(weights);
+    }
+    
+    if (precision_ == PrecisionType::BFLOAT16) {
+        syncPackedWeights();
+    }
+    return !in.fail();
+}
+
+LayerMemoryUsage Layer::memoryUsage() const {
+    LayerMemoryUsage usage;
+    usage.type = typeName();
+    usage.parameter_bytes = neurons_.size() * (num_inputs_ + 1) * sizeof(double);
+    
+    // 层对象、缓存和bfloat16副本
+    size_t total = sizeof(Layer) + cacheBytes() + neurons_.capacity() * sizeof(std::shared_ptr<Neuron>) +
+                   (packed_weights_.capacity() + packed_biases_.capacity()) * sizeof(BFloat16);
+    
+    // 每个神经元：对象本身（含std::function）、make_shared控制块、权重和梯度
+    for (const auto& neuron : neurons_) {
+        total += sizeof(Neuron) + 2 * sizeof(long) +
+                 (neuron->getWeights().capacity() + neuron->getWeightGradients().capacity()) * sizeof(double);
+    }
+    usage.overhead_bytes = total - usage.parameter_bytes;
+    return usage;
+}
+
 const std::vector<std::shared_ptr<Neuron>>& Layer::getNeurons() const {
     return neurons_;
 }
@@ -49,8 +333,66 @@ void Layer::updateWeights(double learningRate) {
     for (auto& neuron : neurons_) {
         neuron->updateWeights(learningRate);
     }
+    
+    if (precision_ == PrecisionType::BFLOAT16) {
+        syncPackedWeights();
+    }
 }
 
+size_t Layer::parameterCount() const {
+    return neurons_.size() * (num_inputs_ + 1);
+}
+
+void Layer::exportParameters(double* out) const {
+    for (const auto& neuron : neurons_) {
+        const auto& weights = neuron->getWeights();
+        out = std::copy(weights.begin(), weights.end(), out);
+        *out++ = neuron->getBias();
+    }
+}
+
+void Layer::importParameters(const double* in) {
+    std::vector<double> weights(num_inputs_);
+    for (auto& neuron : neurons_) {
+        std::copy(in, in + num_inputs_, weights.begin());
+        neuron->setWeights(weights);
+        neuron->setBias(in[num_inputs_]);
+        in += num_inputs_ + 1;
+    }
+    
+    if (precision_ == PrecisionType::BFLOAT16) {
+        syncPackedWeights();
+    }
+}
+
+void Layer::exportGradients(double* out) const {
+    for (const auto& neuron : neurons_) {
+        const auto& gradients = neuron->getWeightGradients();
+        // 尚未反向传播的神经元梯度为空，按0导出
+        std::fill(out, out + num_inputs_, 0.0);
+        std::copy(gradients.begin(), gradients.begin() + std::min(gradients.size(), num_inputs_), out);
+        out[num_inputs_] = neuron->getBiasGradient();
+        out += num_inputs_ + 1;
+    }
+}
+
+void Layer::importGradients(const double* in) {
+    std::vector<double> gradients(num_inputs_);
+    for (auto& neuron : neurons_) {
+        std::copy(in, in + num_inputs_, gradients.begin());
+        neuron->setGradients(gradients, in[num_inputs_]);
+        in += num_inputs_ + 1;
+    }
+}
+
+size_t Layer::bufferCount() const {
+    return 0;
+}
+
+void Layer::exportBuffers(double* /*out*/) const {}
+
+void Layer::importBuffers(const double* /*in*/) {}
+
 const std::vector<double>& Layer::getLastInputs() const {
     return last_inputs_;
 }
@@ -59,4 +401,204 @@ const std::vector<double>& Layer::getLastOutputs() const {
     return last_outputs_;
 }
 
+size_t Layer::inputSize() const {
+    return num_inputs_;
+}
+
+void Layer::releaseCache() {
+    // 交换到空向量以真正归还内存
+    std::vector<double>().swap(last_inputs_);
+    std::vector<double>().swap(last_outputs_);
+    std::vector<BFloat16>().swap(last_inputs_bf16_);
+}
+
+std::string Layer::kernelShapeKey() const {
+    return "dense:" + std::to_string(num_inputs_) + "x" + std::to_string(neurons_.size());
+}
+
+std::vector<KernelConfig> Layer::kernelCandidates(size_t maxThreads) const {
+    std::vector<KernelConfig> candidates;
+    
+    // 打包变体使用层统一的激活函数类型，神经元类型不一致时只保留逐神经元计算
+    bool uniform = true;
+    for (const auto& neuron : neurons_) {
+        uniform = uniform && neuron->getActivationType() == neurons_[0]->getActivationType();
+    }
+    
+    const GemmBlocking blockings[] = {{32, 64, 128}, {64, 128, 256}, {128, 256, 512}};
+    for (size_t threads = 1; threads <= std::max<size_t>(1, maxThreads); threads *= 2) {
+        KernelConfig config;
+        config.threads = threads;
+        config.variant = KernelVariant::NEURON_MAJOR;
+        candidates.push_back(config);
+        if (!uniform) {
+            continue;
+        }
+        config.variant = KernelVariant::PACKED_ROWS;
+        candidates.push_back(config);
+        config.variant = KernelVariant::BLOCKED_GEMM;
+        for (const auto& blocking : blockings) {
+            config.blocking = blocking;
+            candidates.push_back(config);
+        }
+    }
+    return candidates;
+}
+
+void Layer::setKernelConfig(const KernelConfig& config) {
+    kernel_config_ = config;
+}
+
+const KernelConfig& Layer::getKernelConfig() const {
+    return kernel_config_;
+}
+
+void Layer::takeCache(LayerCache& cache) {
+    cache.inputs.clear();
+    cache.outputs.clear();
+    cache.inputs_bf16.clear();
+    restoreCache(cache);
+}
+
+void Layer::restoreCache(LayerCache& cache) {
+    last_inputs_.swap(cache.inputs);
+    last_outputs_.swap(cache.outputs);
+    last_inputs_bf16_.swap(cache.inputs_bf16);
+}
+
+bool Layer::swapBatchCache(size_t sample) {
+    if (sample >= batch_caches_.size()) {
+        return false;
+    }
+    restoreCache(batch_caches_[sample]);
+    return true;
+}
+
+bool Layer::hasCache() const {
+    if (precision_ == PrecisionType::BFLOAT16) {
+        return last_inputs_bf16_.size() == num_inputs_;
+    }
+    return last_inputs_.size() == num_inputs_;
+}
+
+size_t Layer::cacheBytes() const {
+    return (last_inputs_.capacity() + last_outputs_.capacity()) * sizeof(double) +
+           last_inputs_bf16_.capacity() * sizeof(BFloat16);
+}
+
+void Layer::initializeWeights(WeightInitScheme scheme, uint64_t seed) {
+    init_scheme_ = scheme;
+    
+    double limit = 0.5;
+    switch (scheme) {
+        case WeightInitScheme::XAVIER:
+            limit = std::sqrt(6.0 / static_cast<double>(num_inputs_ + neurons_.size()));
+            break;
+        case WeightInitScheme::HE:
+            limit = std::sqrt(6.0 / static_cast<double>(std::max<size_t>(num_inputs_, 1)));
+            break;
+        case WeightInitScheme::UNIFORM:
+        default:
+            break;
+    }
+    
+    // 每个神经元占一个Philox流：前num_inputs_个值为权重，最后一个为偏置
+    auto fill_range = [&](size_t begin, size_t end) {
+        std::vector<double> values(num_inputs_ + 1);
+        for (size_t j = begin; j < end; j++) {
+            philoxFillUniform(seed, j, values.data(), values.size(), -limit, limit);
+            double bias = scheme == WeightInitScheme::UNIFORM ? values[num_inputs_] : 0.0;
+            values.resize(num_inputs_);
+            neurons_[j]->setWeights(values);
+            neurons_[j]->setBias(bias);
+            values.resize(num_inputs_ + 1);
+        }
+    };
+    
+    // 小层串行填充，大层按神经元区间分配给多个线程
+    const size_t parallel_threshold = 1 << 16;
+    size_t num_threads = 1;
+    if (neurons_.size() * (num_inputs_ + 1) >= parallel_threshold) {
+        num_threads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), neurons_.size());
+    }
+    
+    std::vector<std::thread> threads;
+    size_t chunk = (neurons_.size() + num_threads - 1) / num_threads;
+    for (size_t t = 1; t < num_threads; t++) {
+        size_t begin = std::min(t * chunk, neurons_.size());
+        threads.emplace_back(fill_range, begin, std::min(begin + chunk, neurons_.size()));
+    }
+    fill_range(0, std::min(chunk, neurons_.size()));
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    if (precision_ == PrecisionType::BFLOAT16) {
+        syncPackedWeights();
+    }
+}
+
+WeightInitScheme Layer::getInitScheme() const {
+    return init_scheme_;
+}
+
+void Layer::setFrozen(bool frozen) {
+    frozen_ = frozen;
+}
+
+bool Layer::isFrozen() const {
+    return frozen_;
+}
+
+void Layer::setPrecision(PrecisionType precision) {
+    precision_ = precision;
+    
+    if (precision_ == PrecisionType::BFLOAT16) {
+        syncPackedWeights();
+        std::vector<double>().swap(last_inputs_);
+    } else {
+        std::vector<BFloat16>().swap(packed_weights_);
+        std::vector<BFloat16>().swap(packed_biases_);
+        std::vector<BFloat16>().swap(last_inputs_bf16_);
+    }
+}
+
+PrecisionType Layer::getPrecision() const {
+    return precision_;
+}
+
+void Layer::syncPackedWeights() {
+    packed_weights_.resize(neurons_.size() * num_inputs_);
+    packed_biases_.resize(neurons_.size());
+    
+    for (size_t j = 0; j < neurons_.size(); j++) {
+        const auto& weights = neurons_[j]->getWeights();
+        for (size_t k = 0; k < num_inputs_; k++) {
+            packed_weights_[j * num_inputs_ + k] = BFloat16::fromDouble(weights[k]);
+        }
+        packed_biases_[j] = BFloat16::fromDouble(neurons_[j]->getBias());
+    }
+}
+
+float Layer::packedSum(size_t neuron, const std::vector<BFloat16>& inputs) const {
+    const BFloat16* row = packed_weights_.data() + neuron * num_inputs_;
+    float sum = 0.0f;
+    for (size_t k = 0; k < num_inputs_ && k < inputs.size(); k++) {
+        sum += row[k].toFloat() * inputs[k].toFloat();
+    }
+    return sum + packed_biases_[neuron].toFloat();
+}
+
+const std::vector<double>& Layer::inputsForBackprop(std::vector<double>& scratch) const {
+    if (precision_ != PrecisionType::BFLOAT16) {
+        return last_inputs_;
+    }
+    
+    scratch.resize(last_inputs_bf16_.size());
+    for (size_t k = 0; k < last_inputs_bf16_.size(); k++) {
+        scratch[k] = last_inputs_bf16_[k].toFloat();
+    }
+    return scratch;
+}
+
 } // namespace neural_network
\ No newline at end of file
@@ -4,14 +4,71 @@
 #include <vector>
 #include <memory>
 #include <iostream>
+#include <string>
 #include "../neuron/neuron.h"
+#include "bfloat16.h"
+#include "gemm.h"
 
 namespace neural_network {
+
+/**
+ * @brief 权重初始化方案枚举
+ */
+enum class WeightInitScheme {
+    UNIFORM,  ///< [-0.5, 0.5]均匀分布（神经元默认方式）
+    XAVIER,   ///< Xavier/Glorot均匀分布，适合Sigmoid/Tanh
+    HE        ///< He均匀分布，适合ReLU
+};
+    
+/**
+ * @brief 单层内存占用统计
+ */
+struct LayerMemoryUsage {
+    std::string type;                ///< 层类型名称
+    size_t parameter_bytes = 0;      ///< 权重和偏置本身占用的字节数
+    size_t overhead_bytes = 0;       ///< 训练状态、缓存和对象开销占用的字节数
     
+    /**
+     * @brief 总字节数
+     */
+    size_t totalBytes() const { return parameter_bytes + overhead_bytes; }
+};
+
+/**
+ * @brief 批量推理的计算内核变体
+ */
+enum class KernelVariant {
+    DEFAULT,        ///< 层的默认实现
+    NEURON_MAJOR,   ///< 全连接层：逐神经元遍历样本（神经元对象上的内积）
+    PACKED_ROWS,    ///< 全连接层：权重打包为连续矩阵，逐样本计算
+    BLOCKED_GEMM,   ///< 全连接层：整批作为矩阵乘法；卷积层：im2col + 分块GEMM
+    DIRECT          ///< 卷积层：直接卷积
+};
+
+/**
+ * @brief 计算内核配置（由KernelTuner选择）
+ */
+struct KernelConfig {
+    KernelVariant variant = KernelVariant::DEFAULT;  ///< 内核变体
+    GemmBlocking blocking;                           ///< BLOCKED_GEMM的分块大小
+    size_t threads = 1;                              ///< 批量推理的线程数
+};
+
+/**
+ * @brief 从层中取出的前向缓存（用于流水线训练中多个样本同时在途）
+ */
+struct LayerCache {
+    std::vector<double> inputs;          ///< 输入缓存
+    std::vector<double> outputs;         ///< 输出缓存
+    std::vector<BFloat16> inputs_bf16;   ///< bfloat16模式下的输入缓存
+};
+
 /**
  * @brief 网络层类（深度学习版本）
  * 
- * 表示神经网络中的一层，包含多个神经元
+ * 表示神经网络中的一层。Layer本身是全连接层，包含多个神经元；
+ * 同时也是所有层类型的基类，卷积层、池化层等通过重写虚函数接入
+ * Network的前向传播、反向传播和模型保存加载。
  */
 class Layer {
 public:
@@ -25,14 +82,98 @@ public:
     /**
      * @brief 析构函数
      */
-    ~Layer() = default;
+    virtual ~Layer() = default;
     
     /**
      * @brief 前向传播
      * @param inputs 输入值向量
      * @return 该层输出值向量
      */
-    std::vector<double> forward(const std::vector<double>& inputs);
+    virtual std::vector<double> forward(const std::vector<double>& inputs);
+    
+    /**
+     * @brief 只读前向传播，不修改任何缓存（可在多线程中并发调用）
+     * @param inputs 输入值向量
+     * @return 该层输出值向量
+     */
+    std::vector<double> predict(const std::vector<double>& inputs) const;
+    
+    /**
+     * @brief 批量只读前向传播
+     * 
+     * 按神经元外层、样本内层的顺序计算，使每个神经元的权重在整批样本间复用。
+     * @param batch 输入样本集合
+     * @return 每个样本的输出值向量
+     */
+    virtual std::vector<std::vector<double>> predictBatch(const std::vector<std::vector<double>>& batch) const;
+    
+    /**
+     * @brief 反向传播：根据输出误差计算并记录本层梯度（不更新权重）
+     * 
+     * 使用最近一次前向传播缓存的输入输出。
+     * @param errors 本层每个输出的误差
+     * @param gradientScale 梯度缩放因子，记录的梯度会除以该值
+     * @param propagateErrors 是否计算传给前一层的误差
+     * @return 前一层（即本层输入）的误差，propagateErrors为false时为空
+     */
+    virtual std::vector<double> backward(const std::vector<double>& errors, double gradientScale = 1.0,
+                                         bool propagateErrors = true);
+    
+    /**
+     * @brief 批量训练前向传播：依次计算每个样本并保存各自的前向缓存
+     * 
+     * 默认实现逐样本调用forward并取出缓存（与PipelineTrainer暂存样本的方式相同），
+     * 需要整批统计量的层（如批归一化层）重写该函数。
+     * @param batch 输入样本集合
+     * @return 每个样本的输出值向量
+     */
+    virtual std::vector<std::vector<double>> forwardBatch(const std::vector<std::vector<double>>& batch);
+    
+    /**
+     * @brief 批量训练反向传播：记录整批的平均梯度（不更新权重）
+     * 
+     * 必须紧接在同一批次的forwardBatch之后调用。默认实现逐样本放回缓存并调用backward，
+     * 梯度按样本顺序累加后取平均。
+     * @param errors 每个样本在本层输出上的误差
+     * @param propagateErrors 是否计算传给前一层的误差
+     * @return 每个样本在本层输入上的误差，propagateErrors为false时为空
+     */
+    virtual std::vector<std::vector<double>> backwardBatch(const std::vector<std::vector<double>>& errors,
+                                                           bool propagateErrors = true);
+    
+    /**
+     * @brief 计算指定输出关于其加权输入和的导数
+     * @param index 输出索引
+     * @param output 输出值
+     * @return 导数值
+     */
+    virtual double outputDerivative(size_t index, double output) const;
+    
+    /**
+     * @brief 获取层类型名称（用于模型文件）
+     * @return 类型名称
+     */
+    virtual std::string typeName() const;
+    
+    /**
+     * @brief 将层结构和参数写入模型文件
+     * @param out 输出流
+     * @param precision 导出精度
+     */
+    virtual void save(std::ostream& out, PrecisionType precision) const;
+    
+    /**
+     * @brief 从模型文件读取参数（结构已由构造函数确定）
+     * @param in 输入流
+     * @return 是否读取成功
+     */
+    virtual bool loadParameters(std::istream& in);
+    
+    /**
+     * @brief 统计该层的内存占用（参数与训练状态分开计算）
+     * @return 内存占用
+     */
+    virtual LayerMemoryUsage memoryUsage() const;
     
     /**
      * @brief 获取该层所有神经元
@@ -41,10 +182,10 @@ public:
     const std::vector<std::shared_ptr<Neuron>>& getNeurons() const;
     
     /**
-     * @brief 获取该层神经元数量
-     * @return 神经元数量
+     * @brief 获取该层输出数量（全连接层即神经元数量）
+     * @return 输出数量
      */
-    size_t size() const;
+    virtual size_t size() const;
     
     /**
      * @brief 设置该层所有神经元的梯度
@@ -58,7 +199,55 @@ public:
      * @brief 更新该层所有神经元的权重
      * @param learningRate 学习率
      */
-    void updateWeights(double learningRate);
+    virtual void updateWeights(double learningRate);
+    
+    /**
+     * @brief 获取可训练参数数量
+     * @return 参数数量（全连接层为每个神经元的权重加偏置）
+     */
+    virtual size_t parameterCount() const;
+    
+    /**
+     * @brief 把参数按固定顺序展平写出（全连接层为逐神经元的权重后接偏置）
+     * @param out 输出缓冲区，长度至少为parameterCount()
+     */
+    virtual void exportParameters(double* out) const;
+    
+    /**
+     * @brief 从展平的缓冲区读入参数，顺序与exportParameters相同
+     * @param in 输入缓冲区
+     */
+    virtual void importParameters(const double* in);
+    
+    /**
+     * @brief 把最近一次反向传播的梯度展平写出，顺序与exportParameters相同
+     * @param out 输出缓冲区
+     */
+    virtual void exportGradients(double* out) const;
+    
+    /**
+     * @brief 从展平的缓冲区读入梯度，供随后的updateWeights使用
+     * @param in 输入缓冲区
+     */
+    virtual void importGradients(const double* in);
+    
+    /**
+     * @brief 获取不参与梯度更新的状态量数量（如批归一化的滑动统计量）
+     * @return 状态量数量，默认0
+     */
+    virtual size_t bufferCount() const;
+    
+    /**
+     * @brief 把状态量按固定顺序展平写出
+     * @param out 输出缓冲区，长度至少为bufferCount()
+     */
+    virtual void exportBuffers(double* out) const;
+    
+    /**
+     * @brief 从展平的缓冲区读入状态量，顺序与exportBuffers相同
+     * @param in 输入缓冲区
+     */
+    virtual void importBuffers(const double* in);
     
     /**
      * @brief 获取最近一次的输入
@@ -71,11 +260,176 @@ public:
      * @return 输出值向量
      */
     const std::vector<double>& getLastOutputs() const;
+    
+    /**
+     * @brief 获取该层输入数量
+     * @return 输入数量
+     */
+    size_t inputSize() const;
+    
+    /**
+     * @brief 释放为反向传播缓存的输入输出（用于激活值检查点）
+     */
+    void releaseCache();
+    
+    /**
+     * @brief 把前向缓存移出到cache中（不复制），层随后不再持有缓存
+     * @param cache 接收缓存
+     */
+    void takeCache(LayerCache& cache);
+    
+    /**
+     * @brief 把之前取出的缓存移回层中，随后即可对该样本调用backward
+     * @param cache 缓存，调用后内容被交换为层原有的缓存
+     */
+    void restoreCache(LayerCache& cache);
+    
+    /**
+     * @brief 与最近一次默认forwardBatch暂存的某个样本的缓存互换，再次调用即换回
+     * 
+     * 用于在批量反向传播之前按样本计算依赖缓存的输出导数（如二值层的直通估计）。
+     * @param sample 样本序号
+     * @return 没有该样本的暂存缓存时返回false且不做修改
+     */
+    bool swapBatchCache(size_t sample);
+    
+    /**
+     * @brief 判断是否持有可用于反向传播的输入缓存
+     * @return 是否持有缓存
+     */
+    bool hasCache() const;
+    
+    /**
+     * @brief 获取当前缓存占用的字节数
+     * @return 字节数
+     */
+    size_t cacheBytes() const;
+    
+    /**
+     * @brief 按指定方案批量初始化该层权重
+     * 
+     * 使用Philox计数器随机数，第j个神经元的第k个权重只取决于（seed, j, k），
+     * 大层按神经元区间并行填充，结果与线程数无关、可逐位复现。
+     * XAVIER和HE方案的偏置初始化为0。
+     * @param scheme 初始化方案
+     * @param seed 种子
+     */
+    virtual void initializeWeights(WeightInitScheme scheme, uint64_t seed);
+    
+    /**
+     * @brief 获取最近一次使用的初始化方案
+     * @return 初始化方案
+     */
+    WeightInitScheme getInitScheme() const;
+    
+    /**
+     * @brief 设置是否冻结该层
+     * 
+     * 冻结的层不更新权重；位于网络开头连续冻结的层也不再计算梯度，
+     * 反向传播在第一个未冻结的层停止。冻结标志不随模型文件保存。
+     * @param frozen 是否冻结
+     */
+    void setFrozen(bool frozen);
+    
+    /**
+     * @brief 该层是否被冻结
+     * @return 是否冻结
+     */
+    bool isFrozen() const;
+    
+    /**
+     * @brief 设置权重与激活值的存储精度
+     * 
+     * BFLOAT16模式下，前向传播使用bfloat16权重副本并以float累加，
+     * 输入缓存以bfloat16保存；神经元中的double权重作为主副本由优化器更新。
+     * 仅全连接层支持，其他层类型忽略该设置。
+     * @param precision 存储精度
+     */
+    virtual void setPrecision(PrecisionType precision);
+    
+    /**
+     * @brief 获取存储精度
+     * @return 存储精度
+     */
+    PrecisionType getPrecision() const;
+    
+    /**
+     * @brief 获取用于内核调优的层形状键（不可调优的层返回空字符串）
+     * @return 形状键，如"dense:64x32"
+     */
+    virtual std::string kernelShapeKey() const;
+    
+    /**
+     * @brief 列出可供调优比较的内核配置
+     * @param maxThreads 最大线程数
+     * @return 候选配置，不可调优的层返回空列表
+     */
+    virtual std::vector<KernelConfig> kernelCandidates(size_t maxThreads) const;
+    
+    /**
+     * @brief 设置批量推理使用的内核配置
+     * 
+     * 全连接层的各变体累加顺序相同，结果逐位一致；仅对FLOAT64精度生效。
+     * @param config 内核配置
+     */
+    virtual void setKernelConfig(const KernelConfig& config);
+    
+    /**
+     * @brief 获取当前内核配置
+     * @return 内核配置
+     */
+    const KernelConfig& getKernelConfig() const;
+    
+    /**
+     * @brief 根据主副本权重重新生成bfloat16权重副本
+     */
+    void syncPackedWeights();
+    
+    /**
+     * @brief 获取反向传播使用的输入
+     * @param scratch bfloat16模式下用于解码的临时缓冲区
+     * @return 输入值向量（引用last_inputs_或scratch）
+     */
+    const std::vector<double>& inputsForBackprop(std::vector<double>& scratch) const;
 
-private:
-    std::vector<std::shared_ptr<Neuron>> neurons_; ///< 层中的神经元
+protected:
+    /**
+     * @brief 供其他层类型使用的构造函数（不创建神经元），参数顺序与公有构造函数一致
+     * @param numOutputs 输出数量
+     * @param numInputs 输入数量
+     * @param scheme 权重初始化方案
+     */
+    Layer(size_t numOutputs, size_t numInputs, WeightInitScheme scheme);
+    
+    size_t num_inputs_;                            ///< 输入数量
     std::vector<double> last_inputs_;              ///< 最近一次的输入
     std::vector<double> last_outputs_;             ///< 最近一次的输出
+    WeightInitScheme init_scheme_;                 ///< 权重初始化方案
+    KernelConfig kernel_config_;                   ///< 批量推理的内核配置
+    bool frozen_;                                  ///< 是否冻结（不更新权重）
+    std::vector<LayerCache> batch_caches_;         ///< 批量训练中每个样本的前向缓存
+
+private:
+    std::vector<std::shared_ptr<Neuron>> neurons_; ///< 层中的神经元
+    
+    PrecisionType precision_;                      ///< 存储精度
+    std::vector<BFloat16> packed_weights_;         ///< bfloat16权重副本（按神经元连续存放）
+    std::vector<BFloat16> packed_biases_;          ///< bfloat16偏置副本
+    std::vector<BFloat16> last_inputs_bf16_;       ///< bfloat16模式下的输入缓存
+    
+    /**
+     * @brief 使用bfloat16权重副本计算指定神经元的加权输入和
+     * @param neuron 神经元索引
+     * @param inputs bfloat16输入
+     * @return float累加的加权输入和（含偏置）
+     */
+    float packedSum(size_t neuron, const std::vector<BFloat16>& inputs) const;
+    
+    /**
+     * @brief 按内核配置对样本区间[begin, end)执行FLOAT64批量推理
+     */
+    void predictRange(const std::vector<std::vector<double>>& batch, size_t begin, size_t end,
+                      std::vector<std::vector<double>>& outputs) const;
     
     friend class Network;
 };
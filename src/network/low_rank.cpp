@@ -0,0 +1,387 @@
+#include "low_rank.h"
+#include "network.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace neural_network {
+
+namespace {
+
+/**
+ * @brief 全连接层权重矩阵及其较小维度上Gram矩阵的特征分解
+ */
+struct Decomposition {
+    size_t rows = 0;                  ///< 输出数
+    size_t cols = 0;                  ///< 输入数
+    std::vector<double> weights;      ///< rows x cols权重矩阵（行主序）
+    std::vector<double> biases;       ///< 偏置
+    ActivationType activation = ActivationType::SIGMOID;  ///< 激活函数
+    bool uniform = true;              ///< 所有神经元的激活函数是否一致
+    bool right = true;                ///< true：特征向量为右奇异向量（WᵀW），false：左奇异向量（WWᵀ）
+    std::vector<double> eigenvalues;  ///< 降序特征值（奇异值的平方）
+    std::vector<double> eigenvectors; ///< 第i行为第i个特征向量
+};
+
+/**
+ * @brief 对称矩阵的循环Jacobi特征分解
+ * @param matrix n x n对称矩阵（行主序），返回时被破坏
+ * @param n 维数
+ * @param eigenvalues 降序特征值
+ * @param eigenvectors n x n矩阵，第i行为第i个特征值对应的单位特征向量
+ */
+void symmetricEigen(std::vector<double>& matrix, size_t n, std::vector<double>& eigenvalues,
+                    std::vector<double>& eigenvectors) {
+    std::vector<double> v(n * n, 0.0);
+    for (size_t i = 0; i < n; i++) {
+        v[i * n + i] = 1.0;
+    }
+    
+    const size_t kMaxSweeps = 64;
+    for (size_t sweep = 0; sweep < kMaxSweeps; sweep++) {
+        double off = 0.0;
+        double diag = 0.0;
+        for (size_t p = 0; p < n; p++) {
+            diag += matrix[p * n + p] * matrix[p * n + p];
+            for (size_t q = p + 1; q < n; q++) {
+                off += matrix[p * n + q] * matrix[p * n + q];
+            }
+        }
+        if (off <= std::numeric_limits<double>::epsilon() * std::numeric_limits<double>::epsilon() * diag) {
+            break;
+        }
+        
+        for (size_t p = 0; p < n; p++) {
+            for (size_t q = p + 1; q < n; q++) {
+                const double apq = matrix[p * n + q];
+                if (apq == 0.0) {
+                    continue;
+                }
+                // 选取旋转角使(p, q)元素归零
+                const double theta = (matrix[q * n + q] - matrix[p * n + p]) / (2.0 * apq);
+                const double t = (theta >= 0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                const double c = 1.0 / std::sqrt(t * t + 1.0);
+                const double s = t * c;
+                for (size_t k = 0; k < n; k++) {
+                    const double akp = matrix[k * n + p];
+                    const double akq = matrix[k * n + q];
+                    matrix[k * n + p] = c * akp - s * akq;
+                    matrix[k * n + q] = s * akp + c * akq;
+                }
+                for (size_t k = 0; k < n; k++) {
+                    const double apk = matrix[p * n + k];
+                    const double aqk = matrix[q * n + k];
+                    matrix[p * n + k] = c * apk - s * aqk;
+                    matrix[q * n + k] = s * apk + c * aqk;
+                }
+                for (size_t k = 0; k < n; k++) {
+                    const double vkp = v[k * n + p];
+                    const double vkq = v[k * n + q];
+                    v[k * n + p] = c * vkp - s * vkq;
+                    v[k * n + q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+    
+    // 按特征值降序输出，特征向量为v的列
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return matrix[a * n + a] > matrix[b * n + b];
+    });
+    eigenvalues.resize(n);
+    eigenvectors.resize(n * n);
+    for (size_t i = 0; i < n; i++) {
+        eigenvalues[i] = std::max(0.0, matrix[order[i] * n + order[i]]);
+        for (size_t k = 0; k < n; k++) {
+            eigenvectors[i * n + k] = v[k * n + order[i]];
+        }
+    }
+}
+
+Decomposition decompose(const Layer& layer, const std::vector<std::vector<double>>& calibration) {
+    Decomposition d;
+    d.rows = layer.size();
+    d.cols = layer.inputSize();
+    const auto& neurons = layer.getNeurons();
+    d.weights.resize(d.rows * d.cols);
+    d.biases.resize(d.rows);
+    for (size_t j = 0; j < d.rows; j++) {
+        const auto& row = neurons[j]->getWeights();
+        std::copy(row.begin(), row.end(), d.weights.begin() + j * d.cols);
+        d.biases[j] = neurons[j]->getBias();
+        d.uniform = d.uniform && neurons[j]->getActivationType() == neurons[0]->getActivationType();
+    }
+    if (d.rows > 0) {
+        d.activation = neurons[0]->getActivationType();
+    }
+    
+    // 有校准输入时对输出z = Wx做主成分分析（Gram矩阵为平均的zzᵀ），
+    // 否则在较小的维度上对W本身构造Gram矩阵
+    d.right = calibration.empty() && d.cols <= d.rows;
+    const size_t n = calibration.empty() ? std::min(d.rows, d.cols) : d.rows;
+    std::vector<double> gram(n * n, 0.0);
+    if (!calibration.empty()) {
+        std::vector<double> z(d.rows);
+        for (const auto& x : calibration) {
+            for (size_t j = 0; j < d.rows; j++) {
+                double sum = 0.0;
+                for (size_t k = 0; k < d.cols && k < x.size(); k++) {
+                    sum += d.weights[j * d.cols + k] * x[k];
+                }
+                z[j] = sum;
+            }
+            for (size_t a = 0; a < n; a++) {
+                for (size_t b = a; b < n; b++) {
+                    gram[a * n + b] += z[a] * z[b] / calibration.size();
+                }
+            }
+        }
+        for (size_t a = 0; a < n; a++) {
+            for (size_t b = 0; b < a; b++) {
+                gram[a * n + b] = gram[b * n + a];
+            }
+        }
+    } else {
+        for (size_t a = 0; a < n; a++) {
+            for (size_t b = a; b < n; b++) {
+                double sum = 0.0;
+                if (d.right) {
+                    for (size_t j = 0; j < d.rows; j++) {
+                        sum += d.weights[j * d.cols + a] * d.weights[j * d.cols + b];
+                    }
+                } else {
+                    for (size_t k = 0; k < d.cols; k++) {
+                        sum += d.weights[a * d.cols + k] * d.weights[b * d.cols + k];
+                    }
+                }
+                gram[a * n + b] = sum;
+                gram[b * n + a] = sum;
+            }
+        }
+    }
+    symmetricEigen(gram, n, d.eigenvalues, d.eigenvectors);
+    return d;
+}
+
+std::vector<double> toSingularValues(const std::vector<double>& eigenvalues) {
+    std::vector<double> sigma(eigenvalues.size());
+    for (size_t i = 0; i < sigma.size(); i++) {
+        sigma[i] = std::sqrt(eigenvalues[i]);
+    }
+    return sigma;
+}
+
+std::vector<std::shared_ptr<Layer>> buildFactors(const Decomposition& d, size_t rank) {
+    const size_t n = d.eigenvalues.size();
+    if (!d.uniform || n == 0) {
+        return {};
+    }
+    const size_t r = std::max<size_t>(1, std::min(rank, n));
+    
+    // W ≈ B * A：右奇异向量时A的行为v_iᵀ、B的列为W v_i；
+    // 左奇异向量（或输出主成分）时A的行为u_iᵀ W、B的列为u_i
+    std::vector<double> first((d.cols + 1) * r, 0.0);
+    std::vector<double> second((r + 1) * d.rows, 0.0);
+    std::vector<double> a_row(d.cols);
+    std::vector<double> b_col(d.rows);
+    for (size_t i = 0; i < r; i++) {
+        const double* basis = d.eigenvectors.data() + i * n;
+        for (size_t j = 0; j < d.rows; j++) {
+            const double* w_row = d.weights.data() + j * d.cols;
+            if (d.right) {
+                double sum = 0.0;
+                for (size_t k = 0; k < d.cols; k++) {
+                    sum += w_row[k] * basis[k];
+                }
+                b_col[j] = sum;
+            } else {
+                b_col[j] = basis[j];
+            }
+        }
+        if (d.right) {
+            std::copy(basis, basis + d.cols, a_row.begin());
+        } else {
+            std::fill(a_row.begin(), a_row.end(), 0.0);
+            for (size_t j = 0; j < d.rows; j++) {
+                for (size_t k = 0; k < d.cols; k++) {
+                    a_row[k] += basis[j] * d.weights[j * d.cols + k];
+                }
+            }
+        }
+        
+        // 两侧缩放到相同的范数，微调时两层的步长相当
+        double a_norm = 0.0;
+        double b_norm = 0.0;
+        for (double value : a_row) {
+            a_norm += value * value;
+        }
+        for (double value : b_col) {
+            b_norm += value * value;
+        }
+        a_norm = std::sqrt(a_norm);
+        b_norm = std::sqrt(b_norm);
+        if (a_norm == 0.0 || b_norm == 0.0) {
+            continue;
+        }
+        const double a_scale = std::sqrt(b_norm / a_norm);
+        for (size_t k = 0; k < d.cols; k++) {
+            first[i * (d.cols + 1) + k] = a_row[k] * a_scale;
+        }
+        for (size_t j = 0; j < d.rows; j++) {
+            second[j * (r + 1) + i] = b_col[j] / a_scale;
+        }
+    }
+    for (size_t j = 0; j < d.rows; j++) {
+        second[j * (r + 1) + r] = d.biases[j];
+    }
+    
+    auto projection = std::make_shared<Layer>(r, d.cols);
+    auto output = std::make_shared<Layer>(d.rows, r);
+    for (const auto& neuron : projection->getNeurons()) {
+        neuron->setActivationFunction(ActivationType::LINEAR);
+    }
+    for (const auto& neuron : output->getNeurons()) {
+        neuron->setActivationFunction(d.activation);
+    }
+    projection->importParameters(first.data());
+    output->importParameters(second.data());
+    return {projection, output};
+}
+
+size_t denseFlops(const Network& network) {
+    size_t flops = 0;
+    for (size_t i = 0; i < network.getLayerCount(); i++) {
+        auto layer = network.getLayer(i);
+        if (layer->typeName() == "dense") {
+            flops += layer->size() * layer->inputSize();
+        }
+    }
+    return flops;
+}
+
+} // namespace
+
+LowRankCompressor::LowRankCompressor(const LowRankOptions& options) : options_(options) {}
+
+std::vector<double> LowRankCompressor::singularValues(const Layer& layer) {
+    return toSingularValues(decompose(layer, {}).eigenvalues);
+}
+
+size_t LowRankCompressor::chooseRank(const std::vector<double>& singularValues, size_t inputs, size_t outputs) const {
+    const size_t n = std::max<size_t>(1, std::min(inputs, outputs));
+    if (options_.target_speedup > 0.0) {
+        const double rank = static_cast<double>(inputs) * outputs / (options_.target_speedup * (inputs + outputs));
+        return std::max<size_t>(1, std::min(n, static_cast<size_t>(rank)));
+    }
+    
+    double total = 0.0;
+    for (double sigma : singularValues) {
+        total += sigma * sigma;
+    }
+    double kept = 0.0;
+    for (size_t r = 0; r < singularValues.size(); r++) {
+        kept += singularValues[r] * singularValues[r];
+        if (kept >= options_.energy_threshold * total) {
+            return std::max<size_t>(1, std::min(n, r + 1));
+        }
+    }
+    return n;
+}
+
+std::vector<std::shared_ptr<Layer>> LowRankCompressor::factorLayer(const Layer& layer, size_t rank) {
+    if (layer.typeName() != "dense") {
+        return {};
+    }
+    return buildFactors(decompose(layer, {}), rank);
+}
+
+LowRankReport LowRankCompressor::compress(Network& network, const Dataset& validation,
+                                          const Dataset& trainingData) const {
+    const EvaluationMetrics metrics = EvaluationMetrics::LOSS | EvaluationMetrics::ACCURACY;
+    LowRankReport report;
+    report.flops_before = denseFlops(network);
+    if (!validation.empty()) {
+        report.evaluation_before = network.evaluate(validation, metrics, 1);
+        report.latency_before = measureLatency(network, validation);
+    }
+    
+    // 按数据分解时先记录每层在训练样本上的输入
+    std::vector<std::vector<std::vector<double>>> layer_inputs;
+    if (options_.data_aware && !trainingData.empty()) {
+        std::vector<std::vector<double>> batch;
+        for (const auto& sample : trainingData) {
+            batch.push_back(sample.first);
+        }
+        for (size_t i = 0; i < network.getLayerCount(); i++) {
+            layer_inputs.push_back(batch);
+            batch = network.getLayer(i)->predictBatch(batch);
+        }
+    }
+    
+    // 从后向前替换，前面各层的索引保持不变
+    for (size_t i = network.getLayerCount(); i-- > 0;) {
+        auto layer = network.getLayer(i);
+        if (layer->typeName() != "dense" || layer->size() == 0) {
+            continue;
+        }
+        const bool eligible = options_.include_output_layer || i + 1 < network.getLayerCount();
+        Decomposition d = decompose(*layer, layer_inputs.empty() ? std::vector<std::vector<double>>() : layer_inputs[i]);
+        std::vector<double> sigma = toSingularValues(d.eigenvalues);
+        
+        LowRankLayerReport layer_report;
+        layer_report.layer_index = i;
+        layer_report.inputs = d.cols;
+        layer_report.outputs = d.rows;
+        layer_report.rank = std::min(d.rows, d.cols);
+        
+        const size_t rank = chooseRank(sigma, d.cols, d.rows);
+        if (eligible && d.uniform && rank * (d.cols + d.rows) < d.cols * d.rows) {
+            double total = 0.0;
+            double kept = 0.0;
+            for (size_t r = 0; r < d.eigenvalues.size(); r++) {
+                total += d.eigenvalues[r];
+                kept += r < rank ? d.eigenvalues[r] : 0.0;
+            }
+            layer_report.rank = rank;
+            layer_report.energy_retained = total > 0 ? kept / total : 1.0;
+            layer_report.factored = network.replaceLayer(i, buildFactors(d, rank));
+        }
+        report.layers.insert(report.layers.begin(), layer_report);
+    }
+    report.flops_after = denseFlops(network);
+    
+    for (size_t epoch = 0; epoch < options_.fine_tune_epochs; epoch++) {
+        for (const auto& sample : trainingData) {
+            network.train(sample.first, sample.second, options_.fine_tune_learning_rate);
+        }
+    }
+    
+    if (!validation.empty()) {
+        report.evaluation_after = network.evaluate(validation, metrics, 1);
+        report.latency_after = measureLatency(network, validation);
+    }
+    return report;
+}
+
+double LowRankCompressor::measureLatency(const Network& network, const Dataset& dataset) {
+    using Clock = std::chrono::steady_clock;
+    std::vector<std::vector<double>> inputs;
+    inputs.reserve(dataset.size());
+    for (const auto& sample : dataset) {
+        inputs.push_back(sample.first);
+    }
+    
+    double fastest = std::numeric_limits<double>::infinity();
+    for (int run = 0; run < 5; run++) {
+        const auto start = Clock::now();
+        network.predictBatch(inputs);
+        fastest = std::min(fastest, std::chrono::duration<double>(Clock::now() - start).count());
+    }
+    return fastest / inputs.size();
+}
+
+} // namespace neural_network
@@ -0,0 +1,116 @@
+#ifndef LOW_RANK_H
+#define LOW_RANK_H
+
+#include "layer.h"
+#include "evaluation.h"
+#include <memory>
+#include <vector>
+#include <cstddef>
+
+namespace neural_network {
+
+class Network;
+
+/**
+ * @brief 低秩分解压缩选项
+ */
+struct LowRankOptions {
+    double energy_threshold = 0.99;      ///< 保留的奇异值能量比例（sum σ²），按能量选秩时使用
+    double target_speedup = 0.0;         ///< 大于0时改为按目标加速比选秩：in*out / (r*(in+out))
+    bool data_aware = false;             ///< 按训练样本上各层输出的主成分分解（而非权重矩阵本身）
+    bool include_output_layer = false;   ///< 是否也分解输出层（输出层通常很窄，分解收益小而损失大）
+    size_t fine_tune_epochs = 0;         ///< 压缩后微调的轮数，0表示不微调
+    double fine_tune_learning_rate = 0.002; ///< 微调学习率（宜远小于训练学习率）
+};
+
+/**
+ * @brief 单个全连接层的分解结果
+ */
+struct LowRankLayerReport {
+    size_t layer_index = 0;        ///< 原网络中的层索引
+    size_t inputs = 0;             ///< 输入数
+    size_t outputs = 0;            ///< 输出数
+    size_t rank = 0;               ///< 选定的秩（未分解时等于min(inputs, outputs)）
+    double energy_retained = 1.0;  ///< 保留的能量比例（按数据分解时为输出能量）
+    bool factored = false;         ///< 是否被分解（秩不能减少计算量时保持原层）
+};
+
+/**
+ * @brief 压缩报告
+ */
+struct LowRankReport {
+    std::vector<LowRankLayerReport> layers;  ///< 每个全连接层的结果
+    size_t flops_before = 0;                 ///< 压缩前全连接层每个样本的乘加次数
+    size_t flops_after = 0;                  ///< 压缩后全连接层每个样本的乘加次数
+    double latency_before = 0.0;             ///< 压缩前每个样本的推理耗时（秒）
+    double latency_after = 0.0;              ///< 压缩后（含微调）每个样本的推理耗时（秒）
+    EvaluationResult evaluation_before;      ///< 压缩前在验证集上的评估结果
+    EvaluationResult evaluation_after;       ///< 压缩后（含微调）在验证集上的评估结果
+};
+
+/**
+ * @brief 全连接层的截断SVD低秩分解压缩
+ *
+ * 将out x in的权重矩阵W分解为W ≈ B * A，其中A（r x in）由W的前r个右奇异向量
+ * （或左奇异向量张成的投影）构成，对应一个线性激活、无偏置的r神经元层；
+ * B（out x r）加上原偏置和原激活函数构成第二层。每个样本的乘加次数
+ * 从in*out降为r*(in+out)。
+ *
+ * 奇异向量由较小维度上Gram矩阵（WᵀW或WWᵀ）的Jacobi特征分解求得。
+ * 权重中从未被训练数据激活的方向（如初始化残留）也会占用能量，因此可选
+ * data_aware：对训练样本上的输出z = Wx做主成分分析，保留输出方差最大的r个方向，
+ * 即W ≈ U_r U_rᵀ W。分解得到的两层是普通的dense层，可以像其他模型一样保存和加载。
+ */
+class LowRankCompressor {
+public:
+    /**
+     * @brief 构造函数
+     * @param options 压缩选项
+     */
+    explicit LowRankCompressor(const LowRankOptions& options = LowRankOptions());
+    
+    /**
+     * @brief 原地压缩网络中所有激活函数一致的全连接层
+     * @param network 网络（被分解的层替换为两层）
+     * @param validation 用于报告评估结果和推理耗时的验证集，可以为空
+     * @param trainingData 训练样本，用于按数据分解和微调，可以为空
+     * @return 压缩报告
+     */
+    LowRankReport compress(Network& network, const Dataset& validation, const Dataset& trainingData = Dataset()) const;
+    
+    /**
+     * @brief 计算全连接层权重矩阵的奇异值（降序）
+     * @param layer 全连接层
+     * @return 奇异值
+     */
+    static std::vector<double> singularValues(const Layer& layer);
+    
+    /**
+     * @brief 按选项为给定奇异值选择秩
+     * @param singularValues 降序奇异值
+     * @param inputs 输入数
+     * @param outputs 输出数
+     * @return 秩（至少为1）
+     */
+    size_t chooseRank(const std::vector<double>& singularValues, size_t inputs, size_t outputs) const;
+    
+    /**
+     * @brief 将全连接层分解为两个秩为rank的层
+     * @param layer 全连接层（所有神经元的激活函数须一致）
+     * @param rank 秩
+     * @return 两个层（线性投影层和输出层），层不支持分解时返回空
+     */
+    static std::vector<std::shared_ptr<Layer>> factorLayer(const Layer& layer, size_t rank);
+
+private:
+    LowRankOptions options_;   ///< 压缩选项
+    
+    /**
+     * @brief 测量网络在数据集上每个样本的推理耗时（多次取最小）
+     */
+    static double measureLatency(const Network& network, const Dataset& dataset);
+};
+
+} // namespace neural_network
+
+#endif // LOW_RANK_H
@@ -0,0 +1,156 @@
+#include "model_handle.h"
+#include <algorithm>
+#include <thread>
+#include <functional>
+#include <cstdint>
+
+namespace neural_network {
+
+struct ModelHandle::Entry {
+    std::unique_ptr<Network> network;  ///< 模型
+    uint64_t version;                  ///< 版本号
+};
+
+ModelHandle::ReadGuard::ReadGuard(std::atomic<uint64_t>* slot, const void* entry)
+    : slot_(slot), entry_(entry) {}
+
+ModelHandle::ReadGuard::ReadGuard(ReadGuard&& other) noexcept
+    : slot_(other.slot_), entry_(other.entry_) {
+    other.slot_ = nullptr;
+    other.entry_ = nullptr;
+}
+
+ModelHandle::ReadGuard::~ReadGuard() {
+    if (slot_) {
+        slot_->store(0);
+    }
+}
+
+ModelHandle::ReadGuard::operator bool() const {
+    return entry_ != nullptr;
+}
+
+const Network& ModelHandle::ReadGuard::operator*() const {
+    return *static_cast<const Entry*>(entry_)->network;
+}
+
+const Network* ModelHandle::ReadGuard::operator->() const {
+    return static_cast<const Entry*>(entry_)->network.get();
+}
+
+uint64_t ModelHandle::ReadGuard::version() const {
+    return entry_ ? static_cast<const Entry*>(entry_)->version : 0;
+}
+
+ModelHandle::ModelHandle(size_t maxReaders)
+    : current_(nullptr), epoch_(1), next_version_(1) {
+    if (maxReaders == 0) {
+        maxReaders = 4 * std::max(1u, std::thread::hardware_concurrency());
+    }
+    slot_count_ = maxReaders;
+    slots_.reset(new std::atomic<uint64_t>[slot_count_]);
+    for (size_t i = 0; i < slot_count_; i++) {
+        slots_[i].store(0);
+    }
+}
+
+ModelHandle::~ModelHandle() {
+    delete current_.load();
+    for (auto& retired : retired_) {
+        delete retired.first;
+    }
+}
+
+ModelHandle::ReadGuard ModelHandle::acquire() const {
+    // 从与线程相关的位置开始找空闲槽，减少读者之间的竞争
+    size_t start = std::hash<std::thread::id>()(std::this_thread::get_id()) % slot_count_;
+    
+    for (size_t attempt = 0;; attempt++) {
+        std::atomic<uint64_t>& slot = slots_[(start + attempt) % slot_count_];
+        uint64_t idle = 0;
+        uint64_t epoch = epoch_.load();
+        if (slot.compare_exchange_strong(idle, epoch)) {
+            // 槽登记之后再读取指针：写者若未看到该槽，则这里一定读到新模型
+            return ReadGuard(&slot, current_.load());
+        }
+        if (attempt > 0 && attempt % slot_count_ == 0) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+std::vector<double> ModelHandle::predict(const std::vector<double>& inputs) const {
+    ReadGuard guard = acquire();
+    if (!guard) {
+        return {};
+    }
+    return guard->predict(inputs);
+}
+
+uint64_t ModelHandle::publish(std::unique_ptr<Network> model) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    
+    Entry* entry = new Entry{std::move(model), next_version_++};
+    Entry* old = current_.exchange(entry);
+    
+    // 交换之后推进纪元：纪元不晚于retire_epoch的读者可能仍在使用旧模型
+    uint64_t retire_epoch = epoch_.fetch_add(1);
+    if (old) {
+        retired_.push_back({old, retire_epoch});
+    }
+    reclaimLocked();
+    return entry->version;
+}
+
+bool ModelHandle::loadAndPublish(const std::string& filename) {
+    auto model = std::make_unique<Network>();
+    if (!model->loadModel(filename)) {
+        return false;
+    }
+    publish(std::move(model));
+    return true;
+}
+
+size_t ModelHandle::reclaim() {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    return reclaimLocked();
+}
+
+size_t ModelHandle::reclaimLocked() {
+    if (retired_.empty()) {
+        return 0;
+    }
+    
+    // 找到仍在读取中的最早纪元
+    uint64_t oldest_reader = UINT64_MAX;
+    for (size_t i = 0; i < slot_count_; i++) {
+        uint64_t epoch = slots_[i].load();
+        if (epoch != 0) {
+            oldest_reader = std::min(oldest_reader, epoch);
+        }
+    }
+    
+    size_t freed = 0;
+    auto it = std::remove_if(retired_.begin(), retired_.end(), [&](const std::pair<Entry*, uint64_t>& retired) {
+        if (retired.second < oldest_reader) {
+            delete retired.first;
+            freed++;
+            return true;
+        }
+        return false;
+    });
+    retired_.erase(it, retired_.end());
+    return freed;
+}
+
+uint64_t ModelHandle::getVersion() const {
+    ReadGuard guard = acquire();
+    return guard.version();
+}
+
+size_t ModelHandle::getRetiredCount() const {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    return retired_.size();
+}
+
+} // namespace neural_network
@@ -0,0 +1,139 @@
+#ifndef MODEL_HANDLE_H
+#define MODEL_HANDLE_H
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include "network.h"
+
+namespace neural_network {
+
+/**
+ * @brief 支持无锁热替换的在线推理模型句柄（RCU风格）
+ * 
+ * 新模型在推理路径之外加载和准备，然后通过一次原子指针交换发布。
+ * 读者进入时在读者槽中登记当前纪元，退出时清除；读者从不等待写者。
+ * 被替换的旧模型带着替换时的纪元进入待回收列表，
+ * 当没有任何读者登记不晚于该纪元时才释放，因此正在进行的推理总是在旧版本上完成。
+ * 
+ * 读者并发数超过读者槽数量时，多出的读者会自旋等待空闲槽。
+ */
+class ModelHandle {
+public:
+    /**
+     * @brief 读保护对象：持有期间所引用的模型不会被释放
+     */
+    class ReadGuard {
+    public:
+        ReadGuard(ReadGuard&& other) noexcept;
+        ReadGuard& operator=(ReadGuard&& other) = delete;
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ~ReadGuard();
+        
+        /**
+         * @brief 是否引用了有效模型
+         */
+        explicit operator bool() const;
+        
+        const Network& operator*() const;
+        const Network* operator->() const;
+        
+        /**
+         * @brief 获取所引用模型的版本号
+         * @return 版本号（从1开始，每次发布加1）
+         */
+        uint64_t version() const;
+
+    private:
+        friend class ModelHandle;
+        ReadGuard(std::atomic<uint64_t>* slot, const void* entry);
+        
+        std::atomic<uint64_t>* slot_;   ///< 占用的读者槽
+        const void* entry_;             ///< 所引用的模型版本
+    };
+    
+    /**
+     * @brief 构造函数
+     * @param maxReaders 读者槽数量，0表示硬件并发数的4倍
+     */
+    explicit ModelHandle(size_t maxReaders = 0);
+    
+    /**
+     * @brief 析构函数，调用前所有读保护对象必须已释放
+     */
+    ~ModelHandle();
+    
+    ModelHandle(const ModelHandle&) = delete;
+    ModelHandle& operator=(const ModelHandle&) = delete;
+    
+    /**
+     * @brief 获取当前模型的读保护对象（不阻塞于写者）
+     * @return 读保护对象，尚未发布任何模型时为空
+     */
+    ReadGuard acquire() const;
+    
+    /**
+     * @brief 在当前模型上执行只读推理
+     * @param inputs 输入值向量
+     * @return 网络输出，尚未发布模型时返回空向量
+     */
+    std::vector<double> predict(const std::vector<double>& inputs) const;
+    
+    /**
+     * @brief 原子发布新模型，旧模型在读者退出后回收
+     * @param model 已准备好的新模型
+     * @return 新模型的版本号
+     */
+    uint64_t publish(std::unique_ptr<Network> model);
+    
+    /**
+     * @brief 从文件加载模型并发布（加载在调用线程中完成，不影响读者）
+     * @param filename 模型文件名
+     * @return 是否加载并发布成功
+     */
+    bool loadAndPublish(const std::string& filename);
+    
+    /**
+     * @brief 回收已没有读者的旧模型
+     * @return 本次释放的模型数量
+     */
+    size_t reclaim();
+    
+    /**
+     * @brief 获取当前模型版本号
+     * @return 版本号，尚未发布时为0
+     */
+    uint64_t getVersion() const;
+    
+    /**
+     * @brief 获取等待回收的旧模型数量
+     * @return 数量
+     */
+    size_t getRetiredCount() const;
+
+private:
+    struct Entry;
+    
+    /**
+     * @brief 在持有写锁时回收旧模型
+     * @return 释放的数量
+     */
+    size_t reclaimLocked();
+    
+    std::atomic<Entry*> current_;                        ///< 当前发布的模型
+    std::atomic<uint64_t> epoch_;                        ///< 全局纪元，每次替换加1
+    std::unique_ptr<std::atomic<uint64_t>[]> slots_;     ///< 读者槽，0表示空闲，否则为进入时的纪元
+    size_t slot_count_;                                  ///< 读者槽数量
+    
+    mutable std::mutex writer_mutex_;                    ///< 串行化写者（读者不使用）
+    std::vector<std::pair<Entry*, uint64_t>> retired_;   ///< 待回收模型及其退役纪元
+    uint64_t next_version_;                              ///< 下一个版本号
+};
+
+} // namespace neural_network
+
+#endif // MODEL_HANDLE_H
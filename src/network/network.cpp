@@ -1,101 +1,519 @@
 #include "network.h"
+#include "conv_layer.h"
+#include "pooling_layer.h"
+#include "binary_layer.h"
+#include "batch_norm_layer.h"
+#include "dense_kernel.h"
+#include "inference_model.h"
+#include "incremental_inference.h"
+#include "inference_cache.h"
+#include "kernel_tuner.h"
+#include "tracer.h"
 #include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <cassert>
+#include <cctype>
 #include <sstream>
+#include <iomanip>
+#include <limits>
+#include <thread>
+#include <mutex>
+#include <atomic>
 
 namespace neural_network {
 
-Network::Network() : loss_function_type_(LossFunctionType::MEAN_SQUARED_ERROR) {}
+/**
+ * @brief 自动调优状态（以shared_ptr持有，使Network保持可复制）
+ */
+struct Network::AutotuneState {
+    std::shared_ptr<KernelTuner> tuner;   ///< 调优器
+    size_t batch_size = 64;               ///< 调优使用的批大小
+    std::mutex mutex;                     ///< 串行化调优过程
+    std::atomic<bool> tuned{false};       ///< 当前各层是否已调优
+};
+
+Network::Network() 
+    : loss_function_type_(LossFunctionType::MEAN_SQUARED_ERROR), checkpoint_interval_(0), peak_activation_bytes_(0),
+      has_seed_(false), seed_(0), mixed_precision_(false), loss_scale_(kInitialLossScale), good_steps_(0),
+      weights_version_(0) {}
 
 Network::~Network() = default;
 
 void Network::addLayer(std::shared_ptr<Layer> layer) {
+    if (has_seed_) {
+        layer->initializeWeights(layer->getInitScheme(), layerSeed(layers_.size()));
+    }
+    if (mixed_precision_) {
+        layer->setPrecision(PrecisionType::BFLOAT16);
+    }
     layers_.push_back(layer);
+    weightsChanged();
+    if (autotune_) {
+        autotune_->tuned = false;
+    }
 }
 
 std::vector<double> Network::forward(const std::vector<double>& inputs) {
+    std::vector<double> outputs;
+    uint64_t generation = 0;
+    if (inference_cache_ && inference_cache_->lookup(inputs, outputs, generation)) {
+        return outputs;
+    }
+    
+    outputs = forwardPass(inputs);
+    if (inference_cache_) {
+        inference_cache_->insert(inputs, outputs, generation);
+    }
+    return outputs;
+}
+
+std::vector<double> Network::forwardPass(const std::vector<double>& inputs) {
+    NN_TRACE_SCOPE("network", "Network::forward");
     std::vector<double> outputs = inputs;
     
-    // 逐层进行前向传播
-    for (auto& layer : layers_) {
-        outputs = layer->forward(outputs);
+    // 逐层进行前向传播，检查点模式下非检查点层的缓存算完即释放，只保留检查点层的缓存
+    if (checkpoint_interval_ <= 1) {
+        for (const auto& layer : layers_) {
+            outputs = layer->forward(outputs);
+        }
+        // 各层缓存大小不随样本变化，前向结束时的占用即本次峰值
+        recordActivationPeak();
+        return outputs;
+    }
+    
+    // 按各层缓存的变化增量更新占用，不必每层重新遍历整个网络
+    size_t activation_bytes = getActivationMemoryUsage();
+    for (size_t i = 0; i < layers_.size(); i++) {
+        activation_bytes -= layers_[i]->cacheBytes();
+        outputs = layers_[i]->forward(outputs);
+        activation_bytes += layers_[i]->cacheBytes();
+        peak_activation_bytes_ = std::max(peak_activation_bytes_, activation_bytes);
+        if (!isCheckpointLayer(i)) {
+            activation_bytes -= layers_[i]->cacheBytes();
+            layers_[i]->releaseCache();
+        }
     }
     
     return outputs;
 }
 
+std::vector<double> Network::predict(const std::vector<double>& inputs) const {
+    std::vector<double> outputs;
+    uint64_t generation = 0;
+    if (inference_cache_ && inference_cache_->lookup(inputs, outputs, generation)) {
+        return outputs;
+    }
+    
+    ensureKernelsTuned();
+    outputs = inputs;
+    for (const auto& layer : layers_) {
+        outputs = layer->predict(outputs);
+    }
+    if (inference_cache_) {
+        inference_cache_->insert(inputs, outputs, generation);
+    }
+    return outputs;
+}
+
+std::vector<std::vector<double>> Network::predictBatch(const std::vector<std::vector<double>>& batch) const {
+    ensureKernelsTuned();
+    std::vector<std::vector<double>> outputs = batch;
+    for (const auto& layer : layers_) {
+        outputs = layer->predictBatch(outputs);
+    }
+    return outputs;
+}
+
+namespace {
+
+/**
+ * @brief 取向量中最大值的下标作为类别；单值向量按0.5阈值划分
+ */
+size_t classIndex(const std::vector<double>& values) {
+    if (values.size() == 1) {
+        return values[0] >= 0.5 ? 1 : 0;
+    }
+    return std::max_element(values.begin(), values.end()) - values.begin();
+}
+
+} // namespace
+
+EvaluationResult Network::evaluate(const Dataset& dataset, EvaluationMetrics metrics, size_t numThreads) const {
+    EvaluationResult result;
+    result.sample_count = dataset.size();
+    if (dataset.empty() || layers_.empty()) {
+        return result;
+    }
+    ensureKernelsTuned();
+    
+    const size_t output_size = layers_.back()->size();
+    const size_t num_classes = output_size == 1 ? 2 : output_size;
+    const size_t batch_size = 64;
+    
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    numThreads = std::min(numThreads, dataset.size());
+    
+    // 每个线程的局部混淆矩阵；损失逐样本记录，最后按样本顺序求和，加法顺序与线程划分无关
+    std::vector<std::vector<std::vector<size_t>>> partials(numThreads);
+    std::vector<double> losses;
+    if (hasMetric(metrics, EvaluationMetrics::LOSS)) {
+        losses.resize(dataset.size());
+    }
+    
+    auto worker = [&](size_t thread_index, size_t begin, size_t end) {
+        NN_TRACE_SCOPE_ARG("thread", "Network::evaluate worker", "samples", end - begin);
+        std::vector<std::vector<size_t>>& partial = partials[thread_index];
+        partial.assign(num_classes, std::vector<size_t>(num_classes, 0));
+        
+        std::vector<std::vector<double>> batch;
+        for (size_t start = begin; start < end; start += batch_size) {
+            size_t stop = std::min(start + batch_size, end);
+            batch.clear();
+            for (size_t i = start; i < stop; i++) {
+                batch.push_back(dataset[i].first);
+            }
+            
+            std::vector<std::vector<double>> outputs = predictBatch(batch);
+            for (size_t i = start; i < stop; i++) {
+                const auto& output = outputs[i - start];
+                const auto& target = dataset[i].second;
+                if (!losses.empty()) {
+                    losses[i] = computeLoss(output, target);
+                }
+                partial[classIndex(target)][classIndex(output)]++;
+            }
+        }
+    };
+    
+    std::vector<std::thread> threads;
+    size_t chunk = (dataset.size() + numThreads - 1) / numThreads;
+    for (size_t t = 0; t < numThreads; t++) {
+        size_t begin = std::min(t * chunk, dataset.size());
+        size_t end = std::min(begin + chunk, dataset.size());
+        if (t + 1 == numThreads) {
+            worker(t, begin, end);  // 当前线程处理最后一段
+        } else {
+            threads.emplace_back(worker, t, begin, end);
+        }
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    // 计数的合并与顺序无关；损失按样本顺序累加
+    std::vector<std::vector<size_t>> confusion(num_classes, std::vector<size_t>(num_classes, 0));
+    for (const auto& partial : partials) {
+        for (size_t a = 0; a < num_classes; a++) {
+            for (size_t p = 0; p < num_classes; p++) {
+                confusion[a][p] += partial[a][p];
+            }
+        }
+    }
+    
+    if (hasMetric(metrics, EvaluationMetrics::LOSS)) {
+        double total_loss = 0.0;
+        for (double loss : losses) {
+            total_loss += loss;
+        }
+        result.mean_loss = total_loss / dataset.size();
+    }
+    if (hasMetric(metrics, EvaluationMetrics::ACCURACY)) {
+        size_t correct = 0;
+        for (size_t c = 0; c < num_classes; c++) {
+            correct += confusion[c][c];
+        }
+        result.accuracy = static_cast<double>(correct) / dataset.size();
+    }
+    if (hasMetric(metrics, EvaluationMetrics::PER_CLASS)) {
+        result.per_class.resize(num_classes);
+        for (size_t c = 0; c < num_classes; c++) {
+            size_t predicted = 0;
+            size_t actual = 0;
+            for (size_t k = 0; k < num_classes; k++) {
+                predicted += confusion[k][c];
+                actual += confusion[c][k];
+            }
+            ClassStats& stats = result.per_class[c];
+            stats.support = actual;
+            stats.precision = predicted > 0 ? static_cast<double>(confusion[c][c]) / predicted : 0.0;
+            stats.recall = actual > 0 ? static_cast<double>(confusion[c][c]) / actual : 0.0;
+            double denominator = stats.precision + stats.recall;
+            stats.f1 = denominator > 0 ? 2.0 * stats.precision * stats.recall / denominator : 0.0;
+        }
+    }
+    if (hasMetric(metrics, EvaluationMetrics::CONFUSION_MATRIX)) {
+        result.confusion_matrix = std::move(confusion);
+    }
+    
+    return result;
+}
+
 void Network::train(const std::vector<double>& inputs, const std::vector<double>& targets, double learningRate) {
     // 前向传播
-    std::vector<double> outputs = forward(inputs);
+    std::vector<double> outputs = forwardPass(inputs);
     
     // 反向传播
     backpropagate(targets, learningRate);
+    weightsChanged();
 }
 
-void Network::backpropagate(const std::vector<double>& targets, double learningRate) {
+void Network::backpropagate(const std::vector<double>& targets, double learningRate, size_t firstLayer) {
     if (layers_.empty()) return;
+    NN_TRACE_SCOPE("network", "Network::backpropagate");
     
-    // 从最后一层获取输出
-    std::vector<double> outputs;
-    auto output_neurons = layers_.back()->getNeurons();
-    outputs.reserve(output_neurons.size());
-    for (const auto& neuron : output_neurons) {
-        outputs.push_back(neuron->getOutput());
+    bool overflow = computeLayerGradients(targets, firstLayer);
+    
+    if (mixed_precision_ && overflow) {
+        // 梯度溢出：跳过本次更新并减小损失缩放因子
+        loss_scale_ = std::max(1.0, loss_scale_ / 2.0);
+        good_steps_ = 0;
+    } else {
+        NN_TRACE_SCOPE("optimizer", "Network::updateWeights");
+        updateTrainableLayers(learningRate);
+        if (mixed_precision_ && ++good_steps_ >= kLossScaleGrowthInterval) {
+            loss_scale_ = std::min(kMaxLossScale, loss_scale_ * 2.0);
+            good_steps_ = 0;
+        }
     }
     
-    // 计算输出层误差
-    std::vector<double> output_errors = computeOutputLayerErrors(outputs, targets);
+    releaseNonCheckpointCaches();
+}
+
+bool Network::computeLayerGradients(const std::vector<double>& targets, size_t firstLayer) {
+    // 只在需要重新计算时统计一次激活值占用，之后按各层缓存的变化增量更新
+    size_t activation_bytes = 0;
+    bool tracking = false;
+    auto recompute = [&](size_t index) {
+        if (!tracking) {
+            activation_bytes = getActivationMemoryUsage();
+            tracking = true;
+        }
+        recomputeSegment(index, activation_bytes);
+    };
+    
+    // 检查点模式下输出层缓存可能已释放
+    if (!layers_.back()->hasCache()) {
+        recompute(layers_.size() - 1);
+    }
     
-    // 从输出层开始反向传播误差
-    std::vector<double> errors = output_errors;
+    // 从最后一层获取输出并计算输出层误差
+    const std::vector<double> outputs = layers_.back()->getLastOutputs();
+    std::vector<double> errors = computeOutputLayerErrors(outputs, targets);
     
-    // 从最后一层向前遍历
-    for (int i = layers_.size() - 1; i >= 0; --i) {
+    // 混合精度模式下先乘以损失缩放因子
+    const double scale = mixed_precision_ ? loss_scale_ : 1.0;
+    for (auto& error : errors) {
+        error *= scale;
+    }
+    bool overflow = false;
+    
+    // 从最后一层向前遍历到冻结边界，记录各层梯度，由调用者统一更新
+    const size_t stop = std::max(firstLayer, getFrozenPrefixLength());
+    for (size_t i = layers_.size(); i-- > stop;) {
         auto layer = layers_[i];
-        auto neurons = layer->getNeurons();
-        const std::vector<double>& layer_inputs = layer->getLastInputs();
-        
-        // 计算当前层的梯度
-        std::vector<std::vector<double>> weight_gradients(neurons.size());
-        std::vector<double> bias_gradients(neurons.size());
-        
-        std::vector<double> new_errors;
-        if (i > 0) { // 非输入层
-            new_errors.resize(layers_[i-1]->size(), 0.0);
+        if (!layer->hasCache()) {
+            recompute(i);
         }
         
-        for (size_t j = 0; j < neurons.size(); j++) {
-            auto neuron = neurons[j];
-            double output = neuron->getOutput();
-            double derivative = neuron->computeActivationDerivative(output);
-            
-            // 计算梯度
-            double error_term = errors[j] * derivative;
-            bias_gradients[j] = error_term;
-            
-            // 计算权重梯度
-            weight_gradients[j].resize(neuron->getWeights().size());
-            for (size_t k = 0; k < weight_gradients[j].size(); k++) {
-                weight_gradients[j][k] = error_term * layer_inputs[k];
-            }
-            
-            // 传播误差到前一层
-            if (i > 0) {
-                const auto& weights = neuron->getWeights();
-                for (size_t k = 0; k < weights.size() && k < new_errors.size(); k++) {
-                    new_errors[k] += errors[j] * weights[k];
-                }
+        for (double error : errors) {
+            if (!std::isfinite(error)) {
+                overflow = true;
             }
         }
         
-        // 设置梯度并更新权重
-        layer->setGradients(weight_gradients, bias_gradients);
-        layer->updateWeights(learningRate);
+        errors = layer->backward(errors, scale, i > stop);
         
-        errors = new_errors;
+        // 重新计算的缓存用完即释放，峰值不超过常驻的检查点缓存加最长一段
+        if (checkpoint_interval_ > 1 && !isCheckpointLayer(i)) {
+            if (tracking) {
+                activation_bytes -= layer->cacheBytes();
+            }
+            layer->releaseCache();
+        }
+        
+        // 混合精度模式下层间传递的误差以bfloat16精度保存
+        if (mixed_precision_) {
+            for (auto& error : errors) {
+                error = roundToBFloat16(error);
+            }
+        }
     }
+    
+    return overflow;
+}
+
+double Network::trainBatch(const Dataset& batch, double learningRate) {
+    if (layers_.empty() || batch.empty()) {
+        return 0.0;
+    }
+    NN_TRACE_SCOPE_ARG("network", "Network::trainBatch", "samples", batch.size());
+    
+    std::vector<std::vector<double>> activations(batch.size());
+    for (size_t s = 0; s < batch.size(); s++) {
+        activations[s] = batch[s].first;
+    }
+    
+    // 冻结前缀不参与反向传播，只做只读推理
+    const size_t stop = getFrozenPrefixLength();
+    for (size_t i = 0; i < layers_.size(); i++) {
+        activations = i < stop ? layers_[i]->predictBatch(activations) : layers_[i]->forwardBatch(activations);
+    }
+    
+    // 输出导数可能依赖层缓存，计算每个样本的误差时换入该样本的缓存
+    double loss = 0.0;
+    std::vector<std::vector<double>> errors(batch.size());
+    for (size_t s = 0; s < batch.size(); s++) {
+        const bool swapped = layers_.back()->swapBatchCache(s);
+        errors[s] = computeOutputLayerErrors(activations[s], batch[s].second);
+        if (swapped) {
+            layers_.back()->swapBatchCache(s);
+        }
+        loss += computeLoss(activations[s], batch[s].second);
+    }
+    
+    for (size_t i = layers_.size(); i-- > stop;) {
+        errors = layers_[i]->backwardBatch(errors, i > stop);
+    }
+    {
+        NN_TRACE_SCOPE("optimizer", "Network::updateWeights");
+        updateTrainableLayers(learningRate);
+    }
+    weightsChanged();
+    return loss / static_cast<double>(batch.size());
+}
+
+std::vector<double> Network::computeGradients(const std::vector<double>& inputs,
+                                              const std::vector<double>& targets) {
+    if (layers_.empty()) return inputs;
+    std::vector<double> outputs = forwardPass(inputs);
+    computeLayerGradients(targets);
+    releaseNonCheckpointCaches();
+    return outputs;
+}
+
+void Network::applyGradients(double learningRate) {
+    NN_TRACE_SCOPE("optimizer", "Network::applyGradients");
+    updateTrainableLayers(learningRate);
+    weightsChanged();
+}
+
+void Network::updateTrainableLayers(double learningRate) {
+    for (auto& layer : layers_) {
+        if (!layer->isFrozen()) {
+            layer->updateWeights(learningRate);
+        }
+    }
+}
+
+std::vector<double> Network::forwardFrom(size_t layerIndex, const std::vector<double>& activations) {
+    if (layerIndex >= layers_.size() || activations.size() != layers_[layerIndex]->inputSize()) {
+        return {};
+    }
+    NN_TRACE_SCOPE_ARG("network", "Network::forwardFrom", "layer", layerIndex);
+    
+    // 不释放检查点之外的缓存：起始层之前的检查点缓存属于其他样本，不能用于重新计算
+    std::vector<double> outputs = activations;
+    for (size_t i = layerIndex; i < layers_.size(); i++) {
+        outputs = layers_[i]->forward(outputs);
+    }
+    return outputs;
+}
+
+bool Network::trainFrom(size_t layerIndex, const std::vector<double>& activations,
+                        const std::vector<double>& targets, double learningRate) {
+    if (forwardFrom(layerIndex, activations).empty()) {
+        return false;
+    }
+    backpropagate(targets, learningRate, layerIndex);
+    weightsChanged();
+    return true;
+}
+
+size_t Network::getParameterCount() const {
+    size_t count = 0;
+    for (const auto& layer : layers_) {
+        count += layer->parameterCount();
+    }
+    return count;
+}
+
+std::vector<double> Network::getParameters() const {
+    std::vector<double> parameters(getParameterCount());
+    double* out = parameters.data();
+    for (const auto& layer : layers_) {
+        layer->exportParameters(out);
+        out += layer->parameterCount();
+    }
+    return parameters;
+}
+
+bool Network::setParameters(const std::vector<double>& parameters) {
+    if (parameters.size() != getParameterCount()) {
+        return false;
+    }
+    const double* in = parameters.data();
+    for (auto& layer : layers_) {
+        layer->importParameters(in);
+        in += layer->parameterCount();
+    }
+    weightsChanged();
+    return true;
+}
+
+std::vector<double> Network::getBuffers() const {
+    size_t count = 0;
+    for (const auto& layer : layers_) {
+        count += layer->bufferCount();
+    }
+    std::vector<double> buffers(count);
+    double* out = buffers.data();
+    for (const auto& layer : layers_) {
+        layer->exportBuffers(out);
+        out += layer->bufferCount();
+    }
+    return buffers;
+}
+
+bool Network::setBuffers(const std::vector<double>& buffers) {
+    size_t count = 0;
+    for (const auto& layer : layers_) {
+        count += layer->bufferCount();
+    }
+    if (buffers.size() != count) {
+        return false;
+    }
+    const double* in = buffers.data();
+    for (auto& layer : layers_) {
+        layer->importBuffers(in);
+        in += layer->bufferCount();
+    }
+    weightsChanged();
+    return true;
+}
+
+std::vector<double> Network::getGradients() const {
+    std::vector<double> gradients(getParameterCount());
+    double* out = gradients.data();
+    for (const auto& layer : layers_) {
+        layer->exportGradients(out);
+        out += layer->parameterCount();
+    }
+    return gradients;
+}
+
+bool Network::setGradients(const std::vector<double>& gradients) {
+    if (gradients.size() != getParameterCount()) {
+        return false;
+    }
+    const double* in = gradients.data();
+    for (auto& layer : layers_) {
+        layer->importGradients(in);
+        in += layer->parameterCount();
+    }
+    return true;
 }
 
 std::vector<double> Network::computeOutputLayerErrors(const std::vector<double>& outputs, 
@@ -118,8 +536,7 @@ std::vector<double> Network::computeOutputLayerErrors(const std::vector<double>&
             for (size_t i = 0; i < outputs.size(); i++) {
                 double error = outputs[i] - targets[i];
                 // 乘以激活函数的导数
-                auto output_neuron = layers_.back()->getNeurons()[i];
-                double derivative = output_neuron->computeActivationDerivative(outputs[i]);
+                double derivative = layers_.back()->outputDerivative(i, outputs[i]);
                 errors[i] = error * derivative;
             }
             break;
@@ -170,46 +587,135 @@ std::shared_ptr<Layer> Network::getLayer(size_t index) const {
     return nullptr;
 }
 
+bool Network::replaceLayer(size_t index, const std::vector<std::shared_ptr<Layer>>& replacement) {
+    if (index >= layers_.size() || replacement.empty() ||
+        replacement.front()->inputSize() != layers_[index]->inputSize() ||
+        replacement.back()->size() != layers_[index]->size()) {
+        return false;
+    }
+    for (size_t i = 1; i < replacement.size(); i++) {
+        if (replacement[i]->inputSize() != replacement[i - 1]->size()) {
+            return false;
+        }
+    }
+    
+    for (const auto& layer : replacement) {
+        if (mixed_precision_) {
+            layer->setPrecision(PrecisionType::BFLOAT16);
+        }
+    }
+    layers_.erase(layers_.begin() + index);
+    layers_.insert(layers_.begin() + index, replacement.begin(), replacement.end());
+    weightsChanged();
+    if (autotune_) {
+        autotune_->tuned = false;
+    }
+    return true;
+}
+
+void Network::freezeLayers(size_t count) {
+    for (size_t i = 0; i < layers_.size(); i++) {
+        layers_[i]->setFrozen(i < count);
+    }
+}
+
+size_t Network::getFrozenPrefixLength() const {
+    size_t count = 0;
+    while (count < layers_.size() && layers_[count]->isFrozen()) {
+        count++;
+    }
+    return count;
+}
+
 void Network::setLossFunctionType(LossFunctionType type) {
     loss_function_type_ = type;
 }
 
-bool Network::saveModel(const std::string& filename) const {
+bool Network::saveModel(const std::string& filename, PrecisionType precision) const {
+    NN_TRACE_SCOPE("io", "Network::saveModel");
     std::ofstream file(filename);
     if (!file.is_open()) {
         return false;
     }
     
-    // 写入网络结构信息
-    file << layers_.size() << std::endl;
+    // bfloat16导出时由各层先舍入，4位有效数字足以唯一确定bfloat16数值，加载时再舍入回去
+    file << std::setprecision(precision == PrecisionType::BFLOAT16 ? 4 : std::numeric_limits<double>::max_digits10);
+    
+    // 写入网络结构信息：层数，bfloat16导出时后接精度标记（FLOAT64保持旧格式）
+    file << layers_.size();
+    if (precision == PrecisionType::BFLOAT16) {
+        file << " bfloat16";
+    }
+    file << std::endl;
     
     // 写入每层的信息
     for (const auto& layer : layers_) {
-        auto neurons = layer->getNeurons();
-        file << neurons.size() << " " << neurons[0]->getWeights().size() << std::endl;
-        
-        // 写入每个神经元的信息
-        for (const auto& neuron : neurons) {
-            // 写入偏置
-            file << neuron->getBias() << std::endl;
-            
-            // 写入权重
-            const auto& weights = neuron->getWeights();
-            for (size_t k = 0; k < weights.size(); k++) {
-                file << weights[k];
-                if (k < weights.size() - 1) {
-                    file << " ";
-                }
-            }
-            file << std::endl;
-        }
+        layer->save(file, precision);
     }
     
     file.close();
     return true;
 }
 
+namespace {
+
+/**
+ * @brief 读取层描述行并创建对应类型的层
+ * 
+ * 以数字开头的描述行是旧格式的全连接层（神经元数 输入数，Sigmoid激活），
+ * 否则第一个词是层类型名称。
+ */
+std::shared_ptr<Layer> readLayerHeader(std::istream& in) {
+    std::string type;
+    if (!(in >> type) || type.empty()) {
+        return nullptr;
+    }
+    
+    if (std::isdigit(static_cast<unsigned char>(type[0]))) {
+        size_t inputCount;
+        in >> inputCount;
+        if (in.fail()) {
+            return nullptr;
+        }
+        return std::make_shared<Layer>(std::stoul(type), inputCount);
+    }
+    
+    if (type == "dense") {
+        size_t neuronCount, inputCount;
+        std::string activation_name;
+        in >> neuronCount >> inputCount >> activation_name;
+        ActivationType activation;
+        if (in.fail() || !parseActivation(activation_name, activation)) {
+            return nullptr;
+        }
+        auto layer = std::make_shared<Layer>(neuronCount, inputCount);
+        for (auto& neuron : layer->getNeurons()) {
+            neuron->setActivationFunction(activation);
+        }
+        return layer;
+    }
+    if (type == "conv2d") {
+        return Conv2DLayer::fromHeader(in);
+    }
+    if (type == "maxpool") {
+        return PoolingLayer::fromHeader(PoolingType::MAX, in);
+    }
+    if (type == "avgpool") {
+        return PoolingLayer::fromHeader(PoolingType::AVERAGE, in);
+    }
+    if (type == "binary") {
+        return BinaryLayer::fromHeader(in);
+    }
+    if (type == "batchnorm") {
+        return BatchNormLayer::fromHeader(in);
+    }
+    return nullptr;
+}
+
+} // namespace
+
 bool Network::loadModel(const std::string& filename) {
+    NN_TRACE_SCOPE("io", "Network::loadModel");
     std::ifstream file(filename);
     if (!file.is_open()) {
         return false;
@@ -218,39 +724,316 @@ bool Network::loadModel(const std::string& filename) {
     // 读取网络结构信息
     size_t layerCount;
     file >> layerCount;
+    if (file.fail()) {
+        return false;
+    }
+    std::string precision_tag;
+    std::getline(file, precision_tag);
+    precision_tag.erase(0, precision_tag.find_first_not_of(" \t"));
+    precision_tag.erase(precision_tag.find_last_not_of(" \t\r") + 1);
+    const bool bfloat16_file = precision_tag == "bfloat16";
+    if (!bfloat16_file && !precision_tag.empty()) {
+        return false;
+    }
     
-    // 清空现有层
-    layers_.clear();
-    
-    // 读取每层的信息
+    // 读取每层的信息，全部成功后再替换现有层
+    std::vector<std::shared_ptr<Layer>> layers;
     for (size_t i = 0; i < layerCount; i++) {
-        size_t neuronCount, inputCount;
-        file >> neuronCount >> inputCount;
-        
-        // 创建层
-        auto layer = std::make_shared<Layer>(neuronCount, inputCount);
-        auto neurons = layer->getNeurons();
+        auto layer = readLayerHeader(file);
+        if (!layer || !layer->loadParameters(file)) {
+            return false;
+        }
         
-        // 读取每个神经元的信息
-        for (size_t j = 0; j < neuronCount; j++) {
-            // 读取偏置
-            double bias;
-            file >> bias;
-            neurons[j]->setBias(bias);
-            
-            // 读取权重
-            std::vector<double> weights(inputCount);
-            for (size_t k = 0; k < inputCount; k++) {
-                file >> weights[k];
+        // 文件中的十进制数只是bfloat16值的最短表示，舍入回bfloat16才是导出时的数值
+        if (bfloat16_file) {
+            std::vector<double> values(layer->parameterCount());
+            layer->exportParameters(values.data());
+            for (auto& value : values) {
+                value = roundToBFloat16(value);
+            }
+            layer->importParameters(values.data());
+            values.resize(layer->bufferCount());
+            layer->exportBuffers(values.data());
+            for (auto& value : values) {
+                value = roundToBFloat16(value);
             }
-            neurons[j]->setWeights(weights);
+            layer->importBuffers(values.data());
         }
         
-        layers_.push_back(layer);
+        if (mixed_precision_) {
+            layer->setPrecision(PrecisionType::BFLOAT16);
+        }
+        layers.push_back(layer);
     }
     
+    layers_ = std::move(layers);
     file.close();
+    weightsChanged();
+    if (autotune_) {
+        autotune_->tuned = false;
+    }
     return true;
 }
 
+std::unique_ptr<Network> Network::clone() const {
+    auto copy = std::make_unique<Network>();
+    copy->loss_function_type_ = loss_function_type_;
+    copy->checkpoint_interval_ = checkpoint_interval_;
+    copy->has_seed_ = has_seed_;
+    copy->seed_ = seed_;
+    copy->mixed_precision_ = mixed_precision_;
+    copy->loss_scale_ = loss_scale_;
+    copy->good_steps_ = good_steps_;
+    
+    // 按模型文件的层描述行创建同结构的层，再逐位复制参数；构造不消耗随机数流
+    Neuron::NoStreamScope no_streams;
+    std::vector<double> parameters;
+    for (const auto& layer : layers_) {
+        std::stringstream description;
+        layer->save(description, PrecisionType::FLOAT64);
+        auto layer_copy = readLayerHeader(description);
+        if (!layer_copy) {
+            return nullptr;
+        }
+        parameters.resize(layer->parameterCount());
+        layer->exportParameters(parameters.data());
+        layer_copy->importParameters(parameters.data());
+        parameters.resize(layer->bufferCount());
+        layer->exportBuffers(parameters.data());
+        layer_copy->importBuffers(parameters.data());
+        layer_copy->setFrozen(layer->isFrozen());
+        layer_copy->setKernelConfig(layer->getKernelConfig());
+        if (mixed_precision_) {
+            layer_copy->setPrecision(PrecisionType::BFLOAT16);
+        }
+        copy->layers_.push_back(layer_copy);
+    }
+    return copy;
+}
+
+std::shared_ptr<InferenceModel> Network::exportInferenceModel() const {
+    return InferenceModel::fromNetwork(*this);
+}
+
+std::shared_ptr<Network> Network::foldBatchNorm() const {
+    auto folded = clone();
+    if (!folded) {
+        return nullptr;
+    }
+    
+    // 从后向前合并，删除已折叠的批归一化层不影响尚未处理的索引
+    auto& layers = folded->layers_;
+    for (size_t i = layers.size(); i-- > 1;) {
+        auto batch_norm = std::dynamic_pointer_cast<BatchNormLayer>(layers[i]);
+        if (batch_norm && batch_norm->foldInto(*layers[i - 1])) {
+            layers[i - 1]->setFrozen(layers[i - 1]->isFrozen() && batch_norm->isFrozen());
+            layers.erase(layers.begin() + i);
+        }
+    }
+    folded->weightsChanged();
+    return folded;
+}
+
+std::shared_ptr<IncrementalInference> Network::createIncrementalInference(double tolerance,
+                                                                         size_t resyncInterval) const {
+    return IncrementalInference::fromNetwork(*this, tolerance, resyncInterval);
+}
+
+std::vector<LayerMemoryUsage> Network::getMemoryUsage() const {
+    std::vector<LayerMemoryUsage> usage;
+    for (const auto& layer : layers_) {
+        usage.push_back(layer->memoryUsage());
+    }
+    return usage;
+}
+
+void Network::enableInferenceCache(size_t capacityBytes, size_t numShards) {
+    inference_cache_ = std::make_shared<InferenceCache>(capacityBytes, numShards);
+}
+
+void Network::disableInferenceCache() {
+    inference_cache_.reset();
+}
+
+void Network::invalidateInferenceCache() {
+    if (inference_cache_) {
+        inference_cache_->invalidate();
+    }
+}
+
+InferenceCacheStats Network::getInferenceCacheStats() const {
+    return inference_cache_ ? inference_cache_->getStats() : InferenceCacheStats();
+}
+
+uint64_t Network::getWeightsVersion() const {
+    return weights_version_;
+}
+
+void Network::enableAutotune(std::shared_ptr<KernelTuner> tuner, size_t batchSize) {
+    if (!tuner) {
+        disableAutotune();
+        return;
+    }
+    autotune_ = std::make_shared<AutotuneState>();
+    autotune_->tuner = tuner;
+    autotune_->batch_size = std::max<size_t>(1, batchSize);
+}
+
+void Network::disableAutotune() {
+    autotune_.reset();
+}
+
+void Network::ensureKernelsTuned() const {
+    std::shared_ptr<AutotuneState> state = autotune_;
+    if (!state || state->tuned.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (!state->tuned.load(std::memory_order_relaxed)) {
+        state->tuner->tune(*this, state->batch_size);
+        state->tuned.store(true, std::memory_order_release);
+    }
+}
+
+void Network::weightsChanged() {
+    weights_version_++;
+    invalidateInferenceCache();
+}
+
+void Network::setSeed(uint64_t seed) {
+    has_seed_ = true;
+    seed_ = seed;
+    
+    for (size_t i = 0; i < layers_.size(); i++) {
+        layers_[i]->initializeWeights(layers_[i]->getInitScheme(), layerSeed(i));
+    }
+    weightsChanged();
+}
+
+uint64_t Network::getSeed() const {
+    return seed_;
+}
+
+uint64_t Network::layerSeed(size_t index) const {
+    // splitmix64混合，使相邻层的种子互不相关
+    uint64_t z = seed_ + 0x9E3779B97F4A7C15ull * (index + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+void Network::setMixedPrecision(bool enabled) {
+    mixed_precision_ = enabled;
+    loss_scale_ = kInitialLossScale;
+    good_steps_ = 0;
+    
+    for (auto& layer : layers_) {
+        layer->setPrecision(enabled ? PrecisionType::BFLOAT16 : PrecisionType::FLOAT64);
+    }
+    weightsChanged();
+}
+
+bool Network::isMixedPrecision() const {
+    return mixed_precision_;
+}
+
+double Network::getLossScale() const {
+    return loss_scale_;
+}
+
+void Network::setCheckpointInterval(size_t interval) {
+    checkpoint_interval_ = interval;
+}
+
+size_t Network::getCheckpointInterval() const {
+    return checkpoint_interval_;
+}
+
+size_t Network::setActivationMemoryBudget(size_t budgetBytes) {
+    // 每层缓存的字节数（输入 + 输出）
+    std::vector<size_t> layer_bytes;
+    layer_bytes.reserve(layers_.size());
+    for (const auto& layer : layers_) {
+        layer_bytes.push_back((layer->inputSize() + layer->size()) * sizeof(double));
+    }
+    
+    size_t chosen = layers_.empty() ? 1 : layers_.size();
+    for (size_t k = 1; k <= layers_.size(); k++) {
+        // 峰值 = 常驻的检查点缓存 + 反向传播时重新计算的最长一段
+        size_t resident = 0;
+        size_t max_segment = 0;
+        for (size_t start = 0; start < layer_bytes.size(); start += k) {
+            resident += layer_bytes[start];
+            size_t segment = 0;
+            for (size_t j = start + 1; j < std::min(start + k, layer_bytes.size()); j++) {
+                segment += layer_bytes[j];
+            }
+            max_segment = std::max(max_segment, segment);
+        }
+        if (resident + max_segment <= budgetBytes) {
+            chosen = k;
+            break;
+        }
+    }
+    
+    checkpoint_interval_ = chosen;
+    return chosen;
+}
+
+size_t Network::getActivationMemoryUsage() const {
+    size_t total = 0;
+    for (const auto& layer : layers_) {
+        total += layer->cacheBytes();
+    }
+    return total;
+}
+
+size_t Network::getPeakActivationMemoryUsage() const {
+    return peak_activation_bytes_;
+}
+
+void Network::resetPeakActivationMemoryUsage() {
+    peak_activation_bytes_ = getActivationMemoryUsage();
+}
+
+void Network::recordActivationPeak() {
+    peak_activation_bytes_ = std::max(peak_activation_bytes_, getActivationMemoryUsage());
+}
+
+bool Network::isCheckpointLayer(size_t index) const {
+    return checkpoint_interval_ <= 1 || index % checkpoint_interval_ == 0;
+}
+
+void Network::recomputeSegment(size_t index, size_t& activationBytes) {
+    // 间隔为0或1时每层都是检查点层，只能从仍有缓存的最近一层开始
+    size_t start = index;
+    if (checkpoint_interval_ > 1) {
+        start = index - index % checkpoint_interval_;
+    } else {
+        while (start > 0 && !layers_[start]->hasCache()) {
+            start--;
+        }
+    }
+    
+    // 检查点层的输入一直保留，从它开始重新前向计算到目标层
+    std::vector<double> scratch;
+    std::vector<double> outputs = layers_[start]->inputsForBackprop(scratch);
+    for (size_t j = start; j <= index; j++) {
+        activationBytes -= layers_[j]->cacheBytes();
+        outputs = layers_[j]->forward(outputs);
+        activationBytes += layers_[j]->cacheBytes();
+        peak_activation_bytes_ = std::max(peak_activation_bytes_, activationBytes);
+    }
+}
+
+void Network::releaseNonCheckpointCaches() {
+    if (checkpoint_interval_ <= 1) return;
+    
+    for (size_t i = 0; i < layers_.size(); i++) {
+        if (!isCheckpointLayer(i)) {
+            layers_[i]->releaseCache();
+        }
+    }
+}
+
 } // namespace neural_network
\ No newline at end of file
@@ -7,9 +7,16 @@
 #include <fstream>
 #include "../neuron/neuron.h"
 #include "layer.h"
+#include "evaluation.h"
 
 namespace neural_network {
 
+class InferenceModel;
+class IncrementalInference;
+class InferenceCache;
+struct InferenceCacheStats;
+class KernelTuner;
+
 /**
  * @brief 损失函数类型枚举
  */
@@ -31,11 +38,43 @@ public:
     
     /**
      * @brief 前向传播
+     * 
+     * 启用推理缓存且命中时直接返回缓存结果，此时不更新层缓存。
      * @param inputs 输入值向量
      * @return 网络输出值向量
      */
     std::vector<double> forward(const std::vector<double>& inputs);
     
+    /**
+     * @brief 只读前向传播，不修改层缓存（可在多线程中并发调用）
+     * 
+     * 启用推理缓存时先查找缓存，未命中时计算并插入。
+     * @param inputs 输入值向量
+     * @return 网络输出值向量
+     */
+    std::vector<double> predict(const std::vector<double>& inputs) const;
+    
+    /**
+     * @brief 批量只读前向传播
+     * @param batch 输入样本集合
+     * @return 每个样本的网络输出
+     */
+    std::vector<std::vector<double>> predictBatch(const std::vector<std::vector<double>>& batch) const;
+    
+    /**
+     * @brief 在数据集上并行评估网络，不修改网络状态
+     * 
+     * 数据集按连续区间划分给各线程，线程内部按批次调用predictBatch。
+     * 各样本的损失按样本顺序求和，分类计数与合并顺序无关，因此结果与线程数无关。
+     * @param dataset 数据集
+     * @param metrics 需要计算的指标
+     * @param numThreads 线程数，0表示使用硬件并发数
+     * @return 评估结果
+     */
+    EvaluationResult evaluate(const Dataset& dataset, 
+                              EvaluationMetrics metrics = EvaluationMetrics::ALL,
+                              size_t numThreads = 0) const;
+    
     /**
      * @brief 训练网络（反向传播）
      * @param inputs 输入值向量
@@ -44,6 +83,98 @@ public:
      */
     void train(const std::vector<double>& inputs, const std::vector<double>& targets, double learningRate);
     
+    /**
+     * @brief 从指定层开始的训练前向传播（更新该层及之后各层的缓存）
+     * @param layerIndex 起始层索引
+     * @param activations 第layerIndex层的输入（即前一层的输出）
+     * @return 网络输出值向量，索引越界或输入长度不符时为空
+     */
+    std::vector<double> forwardFrom(size_t layerIndex, const std::vector<double>& activations);
+    
+    /**
+     * @brief 只训练指定层及之后的层，输入为第layerIndex层的输入
+     * 
+     * 与ActivationCache配合使用：冻结前缀的输出只需计算一次，之后每轮微调
+     * 只计算可训练的后缀。反向传播在layerIndex处停止，不会传到更早的层。
+     * @param layerIndex 起始层索引
+     * @param activations 第layerIndex层的输入
+     * @param targets 目标值向量
+     * @param learningRate 学习率
+     * @return 索引越界或输入长度不符时返回false
+     */
+    bool trainFrom(size_t layerIndex, const std::vector<double>& activations,
+                   const std::vector<double>& targets, double learningRate);
+    
+    /**
+     * @brief 在一个小批次上训练一步：整批前向、整批反向，用平均梯度更新一次权重
+     * 
+     * 各层通过forwardBatch/backwardBatch处理整批样本，批归一化层因此使用批统计量并更新滑动统计量。
+     * 冻结前缀只做只读推理。不支持混合精度的损失缩放，也不使用激活值检查点。
+     * @param batch 批次样本
+     * @param learningRate 学习率
+     * @return 批次平均损失（更新前的权重上），网络或批次为空时为0
+     */
+    double trainBatch(const Dataset& batch, double learningRate);
+    
+    /**
+     * @brief 计算一个样本的梯度但不更新权重（用于梯度累加和分布式训练）
+     * @param inputs 输入值向量
+     * @param targets 目标值向量
+     * @return 网络输出值向量
+     */
+    std::vector<double> computeGradients(const std::vector<double>& inputs, const std::vector<double>& targets);
+    
+    /**
+     * @brief 用各层当前保存的梯度更新权重
+     * @param learningRate 学习率
+     */
+    void applyGradients(double learningRate);
+    
+    /**
+     * @brief 获取可训练参数总数
+     * @return 参数数量
+     */
+    size_t getParameterCount() const;
+    
+    /**
+     * @brief 按层顺序展平获取所有参数
+     * @return 参数向量
+     */
+    std::vector<double> getParameters() const;
+    
+    /**
+     * @brief 从展平的参数向量设置所有参数
+     * @param parameters 参数向量，长度必须等于getParameterCount()
+     * @return 长度不符时返回false
+     */
+    bool setParameters(const std::vector<double>& parameters);
+    
+    /**
+     * @brief 按层顺序展平获取所有不参与梯度更新的状态量（如批归一化的滑动统计量）
+     * @return 状态量向量
+     */
+    std::vector<double> getBuffers() const;
+    
+    /**
+     * @brief 从展平的状态量向量设置各层状态量
+     * @param buffers 状态量向量，长度必须与getBuffers()相同
+     * @return 长度不符时返回false
+     */
+    bool setBuffers(const std::vector<double>& buffers);
+    
+    /**
+     * @brief 按层顺序展平获取最近一次计算的梯度
+     * @return 梯度向量，顺序与getParameters相同
+     */
+    std::vector<double> getGradients() const;
+    
+    /**
+     * @brief 从展平的梯度向量设置各层梯度
+     * @param gradients 梯度向量，长度必须等于getParameterCount()
+     * @return 长度不符时返回false
+     */
+    bool setGradients(const std::vector<double>& gradients);
+    
     /**
      * @brief 计算损失函数值（均方误差）
      * @param outputs 网络输出
@@ -52,6 +183,15 @@ public:
      */
     double computeLoss(const std::vector<double>& outputs, const std::vector<double>& targets) const;
     
+    /**
+     * @brief 计算输出层误差（反向传播的起点）
+     * @param outputs 网络输出
+     * @param targets 目标值
+     * @return 误差向量
+     */
+    std::vector<double> computeOutputLayerErrors(const std::vector<double>& outputs, 
+                                                 const std::vector<double>& targets) const;
+    
     /**
      * @brief 获取网络层数
      * @return 层数
@@ -65,6 +205,31 @@ public:
      */
     std::shared_ptr<Layer> getLayer(size_t index) const;
     
+    /**
+     * @brief 用一组层替换指定层（新层保留已有权重，不按种子重新初始化）
+     * 
+     * 替换层的输入数须与原层相同，最后一层的输出数须与原层相同。
+     * @param index 被替换层的索引
+     * @param replacement 替换层序列
+     * @return 是否替换成功
+     */
+    bool replaceLayer(size_t index, const std::vector<std::shared_ptr<Layer>>& replacement);
+    
+    /**
+     * @brief 冻结前count层并解冻其余各层
+     * 
+     * 冻结的层不再更新权重，反向传播在第一个未冻结的层停止。
+     * 冻结标志是训练设置，不写入saveModel保存的模型文件，加载后需要重新设置。
+     * @param count 冻结的层数（超过层数时冻结全部）
+     */
+    void freezeLayers(size_t count);
+    
+    /**
+     * @brief 获取网络开头连续冻结的层数（即第一个参与反向传播的层索引）
+     * @return 层数
+     */
+    size_t getFrozenPrefixLength() const;
+    
     /**
      * @brief 设置网络损失函数类型
      * @param type 损失函数类型
@@ -73,37 +238,285 @@ public:
     
     /**
      * @brief 保存网络模型到文件
+     * 
+     * 只保存层结构和参数，不保存冻结标志等训练设置。
      * @param filename 文件名
+     * @param precision 导出精度（BFLOAT16时权重先舍入到bfloat16，并在文件头记录精度）
      * @return 是否保存成功
      */
-    bool saveModel(const std::string& filename) const;
+    bool saveModel(const std::string& filename, PrecisionType precision = PrecisionType::FLOAT64) const;
     
     /**
      * @brief 从文件加载网络模型
+     * 
+     * bfloat16导出的文件加载后参数舍入回导出时的bfloat16数值，与是否启用混合精度无关。
      * @param filename 文件名
      * @return 是否加载成功
      */
     bool loadModel(const std::string& filename);
+    
+    /**
+     * @brief 深拷贝网络：各层为独立对象，可与原网络在不同线程中同时训练
+     * 
+     * 复制参数、层结构、冻结标志、内核配置和训练设置，不复制推理缓存、自动调优状态和层缓存；
+     * 不消耗神经元初始化的随机数流。
+     * @return 网络副本（独占所有权，可直接交给ModelHandle::publish或转为shared_ptr），复制失败时返回nullptr
+     */
+    std::unique_ptr<Network> clone() const;
+    
+    /**
+     * @brief 导出只用于推理的模型
+     * 
+     * 推理模型只保留连续存放的权重、偏置和激活函数类型，不含任何训练状态；
+     * 与冻结层（freezeLayers、Layer::setFrozen）无关。
+     * @return 推理模型，网络包含不支持的层类型或神经元激活函数不一致的层时返回nullptr
+     */
+    std::shared_ptr<InferenceModel> exportInferenceModel() const;
+    
+    /**
+     * @brief 导出把批归一化层折叠进前一个全连接层后的网络副本
+     * 
+     * 紧跟在线性激活全连接层之后的BatchNormLayer按滑动统计量并入该层的权重和偏置，
+     * 该层改用批归一化层的激活函数，推理结果在舍入误差内不变且没有额外计算；
+     * 折叠后的网络可以继续exportInferenceModel()或由nn_codegen生成代码。无法折叠的批归一化层原样保留。
+     * @return 网络副本，复制失败时返回nullptr
+     */
+    std::shared_ptr<Network> foldBatchNorm() const;
+    
+    /**
+     * @brief 创建增量推理对象（输入只有少数特征变化时只传播变化量）
+     * @param tolerance 激活值变化的传播容差
+     * @param resyncInterval 每隔多少次增量更新做一次完整重算，0表示从不
+     * @return 增量推理对象，网络包含不支持的层类型或神经元激活函数不一致的层时返回nullptr
+     */
+    std::shared_ptr<IncrementalInference> createIncrementalInference(double tolerance = 0.0,
+                                                                     size_t resyncInterval = 0) const;
+    
+    /**
+     * @brief 在forward和predict前启用线程安全的分片LRU推理结果缓存
+     * 
+     * 通过train、loadModel、addLayer、setSeed或setMixedPrecision改变权重时缓存自动失效；
+     * 直接修改层参数后需调用invalidateInferenceCache。
+     * @param capacityBytes 缓存容量（字节）
+     * @param numShards 分片数量，0表示默认值
+     */
+    void enableInferenceCache(size_t capacityBytes, size_t numShards = 0);
+    
+    /**
+     * @brief 关闭推理缓存
+     */
+    void disableInferenceCache();
+    
+    /**
+     * @brief 使推理缓存中的现有结果失效
+     */
+    void invalidateInferenceCache();
+    
+    /**
+     * @brief 获取推理缓存统计信息
+     * @return 统计信息，未启用缓存时全为0
+     */
+    InferenceCacheStats getInferenceCacheStats() const;
+    
+    /**
+     * @brief 获取权重版本号（每次通过Network接口改变权重时加1）
+     * @return 权重版本号
+     */
+    uint64_t getWeightsVersion() const;
+    
+    /**
+     * @brief 启用内核自动调优
+     * 
+     * 第一次调用predict、predictBatch或evaluate时由调优器为各层选择内核配置
+     * （命中调优缓存时不做基准测试），之后的调用直接使用选定的配置。
+     * addLayer或loadModel后会在下次推理时重新调优。
+     * @param tuner 调优器（可在多个网络间共享）
+     * @param batchSize 调优使用的批大小
+     */
+    void enableAutotune(std::shared_ptr<KernelTuner> tuner, size_t batchSize = 64);
+    
+    /**
+     * @brief 关闭内核自动调优（已选定的内核配置保持不变）
+     */
+    void disableAutotune();
+    
+    /**
+     * @brief 统计每层的内存占用
+     * @return 每层内存占用（参数与训练状态分开计算）
+     */
+    std::vector<LayerMemoryUsage> getMemoryUsage() const;
+    
+    /**
+     * @brief 设置全局随机种子并按各层的初始化方案重新初始化权重
+     * 
+     * 第i层使用由（seed, i）派生的种子，之后添加的层也会按同样规则初始化，
+     * 因此相同种子和相同结构的网络初始权重逐位一致。
+     * @param seed 全局种子
+     */
+    void setSeed(uint64_t seed);
+    
+    /**
+     * @brief 获取全局随机种子
+     * @return 种子（未设置时返回0）
+     */
+    uint64_t getSeed() const;
+    
+    /**
+     * @brief 启用或关闭混合精度训练
+     * 
+     * 启用后所有层以bfloat16存储权重和激活值、以float累加，
+     * 神经元中的double权重作为主副本由优化器更新，并使用动态损失缩放：
+     * 梯度出现非有限值时跳过本次更新并将缩放因子减半，
+     * 连续若干次正常更新后将缩放因子加倍。
+     * @param enabled 是否启用
+     */
+    void setMixedPrecision(bool enabled);
+    
+    /**
+     * @brief 是否处于混合精度模式
+     * @return 是否启用
+     */
+    bool isMixedPrecision() const;
+    
+    /**
+     * @brief 获取当前的动态损失缩放因子
+     * @return 损失缩放因子
+     */
+    double getLossScale() const;
+    
+    /**
+     * @brief 设置激活值检查点间隔（梯度检查点）
+     * 
+     * 只保留第0、k、2k...层的输入缓存，其余层在前向传播后释放缓存，
+     * 反向传播时从最近的检查点重新计算该段。0或1表示保留所有层的缓存。
+     * @param interval 检查点间隔k
+     */
+    void setCheckpointInterval(size_t interval);
+    
+    /**
+     * @brief 获取激活值检查点间隔
+     * @return 检查点间隔
+     */
+    size_t getCheckpointInterval() const;
+    
+    /**
+     * @brief 按激活值内存预算选择检查点间隔
+     * 
+     * 选择满足预算的最小间隔（即重新计算量最少的间隔），
+     * 预算过小时退化为只保留第一层。
+     * @param budgetBytes 激活值缓存的内存预算（字节）
+     * @return 选定的检查点间隔
+     */
+    size_t setActivationMemoryBudget(size_t budgetBytes);
+    
+    /**
+     * @brief 获取各层当前缓存的激活值占用的内存
+     * @return 字节数
+     */
+    size_t getActivationMemoryUsage() const;
+    
+    /**
+     * @brief 获取上次重置以来前向和反向传播过程中激活值缓存的峰值
+     * @return 字节数
+     */
+    size_t getPeakActivationMemoryUsage() const;
+    
+    /**
+     * @brief 把激活值缓存峰值重置为当前占用
+     */
+    void resetPeakActivationMemoryUsage();
 
 private:
     std::vector<std::shared_ptr<Layer>> layers_;
     LossFunctionType loss_function_type_;
+    size_t checkpoint_interval_;               ///< 激活值检查点间隔，0表示关闭
+    size_t peak_activation_bytes_;             ///< 激活值缓存峰值
+    bool has_seed_;                            ///< 是否设置了全局种子
+    uint64_t seed_;                            ///< 全局种子
+    bool mixed_precision_;                     ///< 是否启用混合精度
+    double loss_scale_;                        ///< 动态损失缩放因子
+    size_t good_steps_;                        ///< 连续未溢出的更新次数
+    uint64_t weights_version_;                 ///< 权重版本号
+    std::shared_ptr<InferenceCache> inference_cache_;  ///< 推理结果缓存，未启用时为空
+    
+    struct AutotuneState;
+    std::shared_ptr<AutotuneState> autotune_;  ///< 自动调优状态，未启用时为空
+    
+    static constexpr double kInitialLossScale = 32768.0;      ///< 初始损失缩放因子
+    static constexpr double kMaxLossScale = 16777216.0;       ///< 损失缩放因子上限
+    static constexpr size_t kLossScaleGrowthInterval = 2000;  ///< 缩放因子加倍所需的连续正常更新次数
+    
+    /**
+     * @brief 计算指定层的初始化种子
+     * @param index 层索引
+     * @return 层种子
+     */
+    uint64_t layerSeed(size_t index) const;
+    
+    /**
+     * @brief 启用自动调优且尚未调优时为各层选择内核配置（线程安全）
+     */
+    void ensureKernelsTuned() const;
+    
+    /**
+     * @brief 不经过推理缓存的前向传播（训练使用，总是更新层缓存）
+     * @param inputs 输入值向量
+     * @return 网络输出值向量
+     */
+    std::vector<double> forwardPass(const std::vector<double>& inputs);
+    
+    /**
+     * @brief 记录权重已改变：递增版本号并使推理缓存失效
+     */
+    void weightsChanged();
+    
+    /**
+     * @brief 判断指定层是否为检查点层
+     * @param index 层索引
+     * @return 是否保留该层缓存
+     */
+    bool isCheckpointLayer(size_t index) const;
+    
+    /**
+     * @brief 从最近的检查点重新计算指定层及其之前的非检查点层缓存
+     * @param index 层索引
+     * @param activationBytes 当前激活值缓存占用，按重新计算的各层缓存变化更新
+     */
+    void recomputeSegment(size_t index, size_t& activationBytes);
+    
+    /**
+     * @brief 按当前激活值缓存占用更新峰值
+     */
+    void recordActivationPeak();
+    
+    /**
+     * @brief 释放所有非检查点层的缓存
+     */
+    void releaseNonCheckpointCaches();
     
     /**
      * @brief 反向传播算法实现
      * @param targets 目标值
      * @param learningRate 学习率
+     * @param firstLayer 最早参与反向传播的层
      */
-    void backpropagate(const std::vector<double>& targets, double learningRate);
+    void backpropagate(const std::vector<double>& targets, double learningRate, size_t firstLayer = 0);
     
     /**
-     * @brief 计算输出层误差
-     * @param outputs 网络输出
+     * @brief 计算并记录各层的梯度，不更新权重
+     * 
+     * 从输出层反向传播到firstLayer和冻结前缀之后第一层中较后的一层为止。
      * @param targets 目标值
-     * @return 误差向量
+     * @param firstLayer 最早参与反向传播的层
+     * @return 混合精度模式下是否出现溢出
      */
-    std::vector<double> computeOutputLayerErrors(const std::vector<double>& outputs, 
-                                                 const std::vector<double>& targets) const;
+    bool computeLayerGradients(const std::vector<double>& targets, size_t firstLayer = 0);
+    
+    /**
+     * @brief 用各层的梯度更新未冻结层的权重
+     * @param learningRate 学习率
+     */
+    void updateTrainableLayers(double learningRate);
 };
 
 } // namespace neural_network
@@ -0,0 +1,308 @@
+#include "network_bundle.h"
+#include "layer.h"
+#include "dense_kernel.h"
+#include <algorithm>
+#include <cmath>
+
+namespace neural_network {
+
+NetworkBundle::NetworkBundle(size_t numModels, const std::vector<size_t>& topology, ActivationType activation)
+    : num_models_(numModels), topology_(topology), learning_rates_(numModels, 0.1),
+      loss_function_type_(LossFunctionType::MEAN_SQUARED_ERROR) {
+    size_t max_width = 0;
+    for (size_t i = 1; i < topology_.size(); i++) {
+        LayerState layer;
+        layer.rows = topology_[i];
+        layer.cols = topology_[i - 1];
+        layer.activation = activation;
+        layer.weights.assign(layer.rows * layer.cols * num_models_, 0.0);
+        layer.biases.assign(layer.rows * num_models_, 0.0);
+        layer.outputs.assign(layer.rows * num_models_, 0.0);
+        layers_.push_back(std::move(layer));
+    }
+    for (size_t width : topology_) {
+        max_width = std::max(max_width, width);
+    }
+    
+    inputs_.assign(topology_.empty() ? 0 : topology_.front() * num_models_, 0.0);
+    targets_.assign(topology_.empty() ? 0 : topology_.back() * num_models_, 0.0);
+    errors_.reserve(max_width * num_models_);
+    prev_errors_.reserve(max_width * num_models_);
+    lane_scratch_.assign(num_models_, 0.0);
+    
+    std::vector<uint64_t> seeds(num_models_);
+    for (size_t m = 0; m < num_models_; m++) {
+        seeds[m] = m;
+    }
+    setSeeds(seeds);
+}
+
+size_t NetworkBundle::getModelCount() const {
+    return num_models_;
+}
+
+size_t NetworkBundle::getLayerCount() const {
+    return layers_.size();
+}
+
+void NetworkBundle::setActivation(size_t layer, ActivationType activation) {
+    if (layer < layers_.size()) {
+        layers_[layer].activation = activation;
+    }
+}
+
+void NetworkBundle::setLossFunctionType(LossFunctionType type) {
+    loss_function_type_ = type;
+}
+
+bool NetworkBundle::setSeeds(const std::vector<uint64_t>& seeds) {
+    if (seeds.size() != num_models_) {
+        return false;
+    }
+    
+    // 借助同结构的Network生成初始权重，保证与单独训练的网络完全一致；
+    // 临时层的权重随后由种子重新初始化，构造时不消耗随机数流
+    Neuron::NoStreamScope no_streams;
+    for (size_t m = 0; m < num_models_; m++) {
+        Network network;
+        network.setSeed(seeds[m]);
+        for (const LayerState& state : layers_) {
+            auto layer = std::make_shared<Layer>(state.rows, state.cols);
+            for (const auto& neuron : layer->getNeurons()) {
+                neuron->setActivationFunction(state.activation);
+            }
+            network.addLayer(layer);
+        }
+        importModel(m, network);
+    }
+    return true;
+}
+
+bool NetworkBundle::setLearningRates(const std::vector<double>& learningRates) {
+    if (learningRates.size() != num_models_) {
+        return false;
+    }
+    learning_rates_ = learningRates;
+    return true;
+}
+
+const std::vector<double>& NetworkBundle::getLearningRates() const {
+    return learning_rates_;
+}
+
+void NetworkBundle::forwardLanes() {
+    const size_t K = num_models_;
+    const std::vector<double>* current = &inputs_;
+    double* sums = lane_scratch_.data();
+    
+    for (LayerState& layer : layers_) {
+        const double* in = current->data();
+        for (size_t j = 0; j < layer.rows; j++) {
+            std::fill(sums, sums + K, 0.0);
+            // 累加顺序与Neuron::forward相同：先按输入顺序累加乘积，再加偏置
+            for (size_t k = 0; k < layer.cols; k++) {
+                const double* w = layer.weights.data() + (j * layer.cols + k) * K;
+                const double* x = in + k * K;
+                for (size_t m = 0; m < K; m++) {
+                    sums[m] += x[m] * w[m];
+                }
+            }
+            const double* b = layer.biases.data() + j * K;
+            double* out = layer.outputs.data() + j * K;
+            for (size_t m = 0; m < K; m++) {
+                out[m] = applyActivation(layer.activation, sums[m] + b[m]);
+            }
+        }
+        current = &layer.outputs;
+    }
+}
+
+void NetworkBundle::backpropagateLanes() {
+    if (layers_.empty()) return;
+    const size_t K = num_models_;
+    const double* lr = learning_rates_.data();
+    double* error_terms = lane_scratch_.data();
+    
+    // 输出层误差，与Network::computeOutputLayerErrors一致
+    const LayerState& last = layers_.back();
+    errors_.resize(last.rows * K);
+    for (size_t i = 0; i < last.rows * K; i++) {
+        double error = last.outputs[i] - targets_[i];
+        if (loss_function_type_ == LossFunctionType::CROSS_ENTROPY) {
+            errors_[i] = error;
+        } else {
+            errors_[i] = error * activationDerivative(last.activation, last.outputs[i]);
+        }
+    }
+    
+    for (size_t l = layers_.size(); l-- > 0;) {
+        LayerState& layer = layers_[l];
+        const double* in = l > 0 ? layers_[l - 1].outputs.data() : inputs_.data();
+        const bool propagate = l > 0;
+        if (propagate) {
+            prev_errors_.assign(layer.cols * K, 0.0);
+        }
+        
+        // 先用更新前的权重传播误差，再更新该层；各层梯度互不依赖，结果与先计算全部梯度再统一更新相同
+        for (size_t j = 0; j < layer.rows; j++) {
+            const double* e = errors_.data() + j * K;
+            const double* out = layer.outputs.data() + j * K;
+            for (size_t m = 0; m < K; m++) {
+                error_terms[m] = e[m] * activationDerivative(layer.activation, out[m]);
+            }
+            
+            for (size_t k = 0; k < layer.cols; k++) {
+                double* w = layer.weights.data() + (j * layer.cols + k) * K;
+                const double* x = in + k * K;
+                if (propagate) {
+                    double* prev = prev_errors_.data() + k * K;
+                    for (size_t m = 0; m < K; m++) {
+                        prev[m] += e[m] * w[m];
+                    }
+                }
+                for (size_t m = 0; m < K; m++) {
+                    w[m] -= lr[m] * (error_terms[m] * x[m]);
+                }
+            }
+            
+            double* b = layer.biases.data() + j * K;
+            for (size_t m = 0; m < K; m++) {
+                b[m] -= lr[m] * error_terms[m];
+            }
+        }
+        
+        if (propagate) {
+            errors_.swap(prev_errors_);
+        }
+    }
+}
+
+std::vector<std::vector<double>> NetworkBundle::splitOutputs() const {
+    const size_t K = num_models_;
+    std::vector<std::vector<double>> outputs(K);
+    if (layers_.empty()) {
+        return outputs;
+    }
+    const LayerState& last = layers_.back();
+    for (size_t m = 0; m < K; m++) {
+        outputs[m].resize(last.rows);
+        for (size_t i = 0; i < last.rows; i++) {
+            outputs[m][i] = last.outputs[i * K + m];
+        }
+    }
+    return outputs;
+}
+
+std::vector<std::vector<double>> NetworkBundle::forward(const std::vector<double>& inputs) {
+    const size_t K = num_models_;
+    for (size_t k = 0; k < inputs.size() && k * K < inputs_.size(); k++) {
+        std::fill(inputs_.begin() + k * K, inputs_.begin() + (k + 1) * K, inputs[k]);
+    }
+    forwardLanes();
+    return splitOutputs();
+}
+
+void NetworkBundle::train(const std::vector<double>& inputs, const std::vector<double>& targets) {
+    const size_t K = num_models_;
+    for (size_t k = 0; k < inputs.size() && k * K < inputs_.size(); k++) {
+        std::fill(inputs_.begin() + k * K, inputs_.begin() + (k + 1) * K, inputs[k]);
+    }
+    for (size_t i = 0; i < targets.size() && i * K < targets_.size(); i++) {
+        std::fill(targets_.begin() + i * K, targets_.begin() + (i + 1) * K, targets[i]);
+    }
+    forwardLanes();
+    backpropagateLanes();
+}
+
+void NetworkBundle::train(const std::vector<std::vector<double>>& inputs,
+                          const std::vector<std::vector<double>>& targets) {
+    const size_t K = num_models_;
+    if (inputs.size() != K || targets.size() != K) {
+        return;
+    }
+    for (size_t m = 0; m < K; m++) {
+        for (size_t k = 0; k < inputs[m].size() && k * K < inputs_.size(); k++) {
+            inputs_[k * K + m] = inputs[m][k];
+        }
+        for (size_t i = 0; i < targets[m].size() && i * K < targets_.size(); i++) {
+            targets_[i * K + m] = targets[m][i];
+        }
+    }
+    forwardLanes();
+    backpropagateLanes();
+}
+
+std::vector<double> NetworkBundle::computeLoss(const std::vector<double>& inputs,
+                                               const std::vector<double>& targets) {
+    auto outputs = forward(inputs);
+    
+    // 借用Network的损失计算，保证公式一致
+    Network reference;
+    reference.setLossFunctionType(loss_function_type_);
+    std::vector<double> losses(num_models_);
+    for (size_t m = 0; m < num_models_; m++) {
+        losses[m] = reference.computeLoss(outputs[m], targets);
+    }
+    return losses;
+}
+
+bool NetworkBundle::importModel(size_t model, const Network& network) {
+    if (model >= num_models_ || network.getLayerCount() != layers_.size()) {
+        return false;
+    }
+    for (size_t l = 0; l < layers_.size(); l++) {
+        auto layer = network.getLayer(l);
+        if (layer->typeName() != "dense" || layer->size() != layers_[l].rows ||
+            layer->inputSize() != layers_[l].cols) {
+            return false;
+        }
+        for (const auto& neuron : layer->getNeurons()) {
+            if (neuron->getActivationType() != layers_[l].activation) {
+                return false;
+            }
+        }
+    }
+    
+    const size_t K = num_models_;
+    for (size_t l = 0; l < layers_.size(); l++) {
+        LayerState& state = layers_[l];
+        const auto& neurons = network.getLayer(l)->getNeurons();
+        for (size_t j = 0; j < state.rows; j++) {
+            const auto& weights = neurons[j]->getWeights();
+            for (size_t k = 0; k < state.cols; k++) {
+                state.weights[(j * state.cols + k) * K + model] = weights[k];
+            }
+            state.biases[j * K + model] = neurons[j]->getBias();
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<Network> NetworkBundle::exportModel(size_t model) const {
+    auto network = std::make_shared<Network>();
+    network->setLossFunctionType(loss_function_type_);
+    if (model >= num_models_) {
+        return network;
+    }
+    
+    // 权重随后被覆盖，构造时同样不消耗随机数流
+    Neuron::NoStreamScope no_streams;
+    const size_t K = num_models_;
+    for (const LayerState& state : layers_) {
+        auto layer = std::make_shared<Layer>(state.rows, state.cols);
+        const auto& neurons = layer->getNeurons();
+        std::vector<double> weights(state.cols);
+        for (size_t j = 0; j < state.rows; j++) {
+            for (size_t k = 0; k < state.cols; k++) {
+                weights[k] = state.weights[(j * state.cols + k) * K + model];
+            }
+            neurons[j]->setActivationFunction(state.activation);
+            neurons[j]->setWeights(weights);
+            neurons[j]->setBias(state.biases[j * K + model]);
+        }
+        network->addLayer(layer);
+    }
+    return network;
+}
+
+} // namespace neural_network
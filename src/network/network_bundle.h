@@ -0,0 +1,166 @@
+#ifndef NETWORK_BUNDLE_H
+#define NETWORK_BUNDLE_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "../neuron/neuron.h"
+#include "network.h"
+
+namespace neural_network {
+
+/**
+ * @brief 同结构小网络的捆绑训练（结构数组布局，每个SIMD通道对应一个模型）
+ * 
+ * K个拓扑相同的全连接网络的权重按[层][神经元][输入][模型]存放，
+ * 最内层循环在连续的K个模型上进行，编译器可将其向量化，
+ * 适合超参数搜索和集成学习中大量的小网络（如2→4→1的XOR网络）。
+ * 
+ * 每个模型的前向传播、误差计算和权重更新与单独的Network逐位一致，
+ * 各模型可使用不同的学习率和随机种子。不支持混合精度和激活值检查点。
+ */
+class NetworkBundle {
+public:
+    /**
+     * @brief 构造函数
+     * 
+     * 模型m的初始权重与调用setSeed(m)的同结构Network相同。
+     * @param numModels 模型数量K
+     * @param topology 各层宽度，第一个元素为输入数量，如{2, 4, 1}
+     * @param activation 所有层的激活函数类型
+     */
+    NetworkBundle(size_t numModels, const std::vector<size_t>& topology,
+                  ActivationType activation = ActivationType::SIGMOID);
+    
+    /**
+     * @brief 获取模型数量
+     * @return 模型数量
+     */
+    size_t getModelCount() const;
+    
+    /**
+     * @brief 获取层数（不含输入层）
+     * @return 层数
+     */
+    size_t getLayerCount() const;
+    
+    /**
+     * @brief 设置某层的激活函数类型（所有模型相同）
+     * @param layer 层索引
+     * @param activation 激活函数类型
+     */
+    void setActivation(size_t layer, ActivationType activation);
+    
+    /**
+     * @brief 设置损失函数类型（所有模型相同）
+     * @param type 损失函数类型
+     */
+    void setLossFunctionType(LossFunctionType type);
+    
+    /**
+     * @brief 按种子重新初始化各模型，与调用Network::setSeed的同结构网络一致
+     * @param seeds 每个模型的种子，长度必须为K
+     * @return 长度不符时返回false
+     */
+    bool setSeeds(const std::vector<uint64_t>& seeds);
+    
+    /**
+     * @brief 设置各模型的学习率
+     * @param learningRates 每个模型的学习率，长度必须为K
+     * @return 长度不符时返回false
+     */
+    bool setLearningRates(const std::vector<double>& learningRates);
+    
+    /**
+     * @brief 获取各模型的学习率
+     * @return 学习率
+     */
+    const std::vector<double>& getLearningRates() const;
+    
+    /**
+     * @brief 所有模型在同一样本上前向传播
+     * @param inputs 输入值向量
+     * @return 每个模型的输出
+     */
+    std::vector<std::vector<double>> forward(const std::vector<double>& inputs);
+    
+    /**
+     * @brief 所有模型在同一样本上训练一步，各自使用自己的学习率
+     * @param inputs 输入值向量
+     * @param targets 目标值向量
+     */
+    void train(const std::vector<double>& inputs, const std::vector<double>& targets);
+    
+    /**
+     * @brief 每个模型在各自的样本上训练一步
+     * @param inputs 每个模型的输入值向量，长度为K
+     * @param targets 每个模型的目标值向量，长度为K
+     */
+    void train(const std::vector<std::vector<double>>& inputs, const std::vector<std::vector<double>>& targets);
+    
+    /**
+     * @brief 计算各模型在一个样本上的损失
+     * @param inputs 输入值向量
+     * @param targets 目标值向量
+     * @return 每个模型的损失，与Network::computeLoss一致
+     */
+    std::vector<double> computeLoss(const std::vector<double>& inputs, const std::vector<double>& targets);
+    
+    /**
+     * @brief 从网络复制某个模型的参数
+     * @param model 模型索引
+     * @param network 源网络，拓扑和激活函数必须与捆绑一致
+     * @return 不一致时返回false
+     */
+    bool importModel(size_t model, const Network& network);
+    
+    /**
+     * @brief 把某个模型导出为独立的网络
+     * @param model 模型索引
+     * @return 网络
+     */
+    std::shared_ptr<Network> exportModel(size_t model) const;
+
+private:
+    /**
+     * @brief 单层参数和缓存，均按[...][模型]布局
+     */
+    struct LayerState {
+        size_t rows;                     ///< 神经元数量
+        size_t cols;                     ///< 输入数量
+        ActivationType activation;       ///< 激活函数类型
+        std::vector<double> weights;     ///< [神经元][输入][模型]
+        std::vector<double> biases;      ///< [神经元][模型]
+        std::vector<double> outputs;     ///< [神经元][模型]
+    };
+    
+    /**
+     * @brief 对inputs_中的交错输入执行前向传播
+     */
+    void forwardLanes();
+    
+    /**
+     * @brief 根据targets_中的交错目标反向传播并更新所有模型
+     */
+    void backpropagateLanes();
+    
+    /**
+     * @brief 把最后一层的交错输出拆分为每个模型的输出
+     */
+    std::vector<std::vector<double>> splitOutputs() const;
+    
+    size_t num_models_;                  ///< 模型数量K
+    std::vector<size_t> topology_;       ///< 各层宽度
+    std::vector<LayerState> layers_;     ///< 各层
+    std::vector<double> learning_rates_; ///< 各模型学习率
+    std::vector<double> inputs_;         ///< 交错输入[输入][模型]
+    std::vector<double> targets_;        ///< 交错目标[输出][模型]
+    std::vector<double> errors_;         ///< 当前层误差（临时）
+    std::vector<double> prev_errors_;    ///< 前一层误差（临时）
+    std::vector<double> lane_scratch_;   ///< 按模型的累加器（临时）
+    LossFunctionType loss_function_type_;
+};
+
+} // namespace neural_network
+
+#endif // NETWORK_BUNDLE_H
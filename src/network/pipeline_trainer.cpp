@@ -0,0 +1,289 @@
+#include "pipeline_trainer.h"
+#include "tracer.h"
+#include <algorithm>
+#include <chrono>
+
+namespace neural_network {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+} // namespace
+
+PipelineTrainer::PipelineTrainer(Network& network, size_t numStages, PipelineSchedule schedule)
+    : network_(network), schedule_(schedule) {
+    const size_t layer_count = network_.getLayerCount();
+    const size_t stage_count = std::max<size_t>(1, std::min(numStages, layer_count));
+    
+    // 按参数量（每层至少计1）均衡划分连续的层
+    std::vector<double> prefix(layer_count + 1, 0.0);
+    for (size_t i = 0; i < layer_count; i++) {
+        prefix[i + 1] = prefix[i] + network_.getLayer(i)->parameterCount() + 1.0;
+    }
+    std::vector<size_t> boundaries = {0};
+    for (size_t s = 1; s < stage_count; s++) {
+        double target = prefix[layer_count] * s / stage_count;
+        size_t cut = boundaries.back() + 1;
+        while (cut < layer_count - (stage_count - s) && prefix[cut] < target) {
+            cut++;
+        }
+        boundaries.push_back(cut);
+    }
+    boundaries.push_back(layer_count);
+    
+    for (size_t s = 0; s < stage_count; s++) {
+        auto stage = std::make_unique<Stage>();
+        stage->first_layer = boundaries[s];
+        stage->last_layer = boundaries[s + 1];
+        size_t parameters = 0;
+        for (size_t l = stage->first_layer; l < stage->last_layer; l++) {
+            parameters += network_.getLayer(l)->parameterCount();
+        }
+        stage->gradients.assign(parameters, 0.0);
+        stage->scratch.assign(parameters, 0.0);
+        stages_.push_back(std::move(stage));
+    }
+    
+    for (size_t s = 0; s < stages_.size(); s++) {
+        stages_[s]->thread = std::thread(&PipelineTrainer::stageLoop, this, s);
+    }
+}
+
+PipelineTrainer::~PipelineTrainer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    start_cv_.notify_all();
+    for (auto& stage : stages_) {
+        stage->thread.join();
+    }
+}
+
+void PipelineTrainer::setSchedule(PipelineSchedule schedule) {
+    schedule_ = schedule;
+}
+
+size_t PipelineTrainer::getStageCount() const {
+    return stages_.size();
+}
+
+std::vector<size_t> PipelineTrainer::getStageBoundaries() const {
+    std::vector<size_t> boundaries;
+    for (const auto& stage : stages_) {
+        boundaries.push_back(stage->first_layer);
+    }
+    return boundaries;
+}
+
+size_t PipelineTrainer::microBegin(size_t micro) const {
+    return micro * batch_->size() / micro_batches_;
+}
+
+PipelineStats PipelineTrainer::trainBatch(const Dataset& batch, size_t numMicroBatches, double learningRate) {
+    PipelineStats stats;
+    if (batch.empty() || network_.getLayerCount() == 0) {
+        return stats;
+    }
+    
+    batch_ = &batch;
+    micro_batches_ = std::max<size_t>(1, std::min(numMicroBatches, batch.size()));
+    learning_rate_ = learningRate;
+    
+    // 队列容纳S（阶段数）个微批次，不随微批次数增长，队列满时生产者阻塞形成背压。
+    // 1F1B下阶段s在收到第0个微批次的误差前最多推送S - s个微批次，此后每推送一个前向微批次
+    // 都先收到了下游的一个误差微批次，积压不超过2个，因此前向推送永远不会阻塞；
+    // 反向推送阻塞时接收方队列非空，接收方只会等待更靠前的阶段，不会形成环形等待。
+    // GPipe下游阶段在前向阶段只消费不发送误差，同样不会互相等待。
+    const size_t micro_size = (batch.size() + micro_batches_ - 1) / micro_batches_;
+    const size_t queue_capacity = std::min(stages_.size() * micro_size, batch.size());
+    for (size_t s = 0; s < stages_.size(); s++) {
+        Stage& stage = *stages_[s];
+        if (s > 0 && (!stage.forward_in || stage.forward_in->capacity() < queue_capacity)) {
+            stage.forward_in = std::make_unique<SpscQueue<Message>>(queue_capacity);
+        }
+        if (s + 1 < stages_.size() && (!stage.backward_in || stage.backward_in->capacity() < queue_capacity)) {
+            stage.backward_in = std::make_unique<SpscQueue<Message>>(queue_capacity);
+        }
+        stage.stash.resize(batch.size());
+        for (auto& caches : stage.stash) {
+            caches.resize(stage.last_layer - stage.first_layer);
+        }
+        std::fill(stage.gradients.begin(), stage.gradients.end(), 0.0);
+        stage.busy_seconds = 0.0;
+        stage.stashed = 0;
+        stage.peak_stashed = 0;
+        stage.loss_sum = 0.0;
+    }
+    
+    auto start = Clock::now();
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        generation_++;
+        remaining_ = stages_.size();
+        start_cv_.notify_all();
+        done_cv_.wait(lock, [this] { return remaining_ == 0; });
+    }
+    
+    // 各阶段已把平均梯度写回自己的层，统一更新并使推理缓存失效
+    network_.applyGradients(learningRate);
+    stats.wall_seconds = secondsSince(start);
+    
+    double utilization_sum = 0.0;
+    for (const auto& stage : stages_) {
+        double utilization = stats.wall_seconds > 0 ? stage->busy_seconds / stats.wall_seconds : 0.0;
+        stats.stage_busy_seconds.push_back(stage->busy_seconds);
+        stats.stage_utilization.push_back(utilization);
+        stats.peak_stashed_samples.push_back(stage->peak_stashed);
+        utilization_sum += utilization;
+    }
+    stats.bubble_fraction = 1.0 - utilization_sum / stages_.size();
+    stats.queue_capacity = stages_.size() > 1 ? stages_[1]->forward_in->capacity() : 0;
+    stats.mean_loss = stages_.back()->loss_sum / batch.size();
+    batch_ = nullptr;
+    return stats;
+}
+
+void PipelineTrainer::stageLoop(size_t index) {
+    Tracer::instance().setThreadName("pipeline stage " + std::to_string(index));
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_cv_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+            if (stopping_) {
+                return;
+            }
+            seen = generation_;
+        }
+        
+        runStage(index);
+        
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--remaining_ == 0) {
+            done_cv_.notify_one();
+        }
+    }
+}
+
+void PipelineTrainer::runStage(size_t index) {
+    Stage& stage = *stages_[index];
+    const size_t M = micro_batches_;
+    
+    if (schedule_ == PipelineSchedule::GPIPE) {
+        for (size_t m = 0; m < M; m++) {
+            forwardMicroBatch(index, m);
+        }
+        for (size_t m = 0; m < M; m++) {
+            backwardMicroBatch(index, m);
+        }
+    } else {
+        // 1F1B：越靠前的阶段预热的微批次越多，之后每完成一个前向就执行一个反向
+        size_t warmup = std::min(stages_.size() - index - 1, M);
+        for (size_t m = 0; m < warmup; m++) {
+            forwardMicroBatch(index, m);
+        }
+        for (size_t m = 0; m < M; m++) {
+            if (warmup + m < M) {
+                forwardMicroBatch(index, warmup + m);
+            }
+            backwardMicroBatch(index, m);
+        }
+    }
+    
+    // 取平均后写回本阶段各层
+    auto start = Clock::now();
+    const double samples = static_cast<double>(batch_->size());
+    for (auto& gradient : stage.gradients) {
+        gradient /= samples;
+    }
+    const double* gradients = stage.gradients.data();
+    for (size_t l = stage.first_layer; l < stage.last_layer; l++) {
+        auto layer = network_.getLayer(l);
+        layer->importGradients(gradients);
+        gradients += layer->parameterCount();
+    }
+    stage.busy_seconds += secondsSince(start);
+}
+
+void PipelineTrainer::forwardMicroBatch(size_t index, size_t micro) {
+    NN_TRACE_SCOPE_ARG("pipeline", "PipelineTrainer::forwardMicroBatch", "micro_batch", micro);
+    Stage& stage = *stages_[index];
+    const bool last = index + 1 == stages_.size();
+    
+    for (size_t i = microBegin(micro); i < microBegin(micro + 1); i++) {
+        std::vector<double> activations = index == 0 ? (*batch_)[i].first : stage.forward_in->pop().data;
+        
+        auto start = Clock::now();
+        for (size_t l = stage.first_layer; l < stage.last_layer; l++) {
+            auto layer = network_.getLayer(l);
+            activations = layer->forward(activations);
+            layer->takeCache(stage.stash[i][l - stage.first_layer]);
+        }
+        stage.peak_stashed = std::max(stage.peak_stashed, ++stage.stashed);
+        if (last) {
+            stage.loss_sum += network_.computeLoss(activations, (*batch_)[i].second);
+        }
+        stage.busy_seconds += secondsSince(start);
+        
+        if (!last) {
+            Message message;
+            message.sample = i;
+            message.data = std::move(activations);
+            stages_[index + 1]->forward_in->push(std::move(message));
+        }
+    }
+}
+
+void PipelineTrainer::backwardMicroBatch(size_t index, size_t micro) {
+    NN_TRACE_SCOPE_ARG("pipeline", "PipelineTrainer::backwardMicroBatch", "micro_batch", micro);
+    Stage& stage = *stages_[index];
+    const bool last = index + 1 == stages_.size();
+    
+    for (size_t i = microBegin(micro); i < microBegin(micro + 1); i++) {
+        std::vector<double> errors;
+        if (!last) {
+            errors = stage.backward_in->pop().data;
+        }
+        
+        auto start = Clock::now();
+        double* gradients = stage.scratch.data();
+        for (size_t l = stage.last_layer; l-- > stage.first_layer;) {
+            auto layer = network_.getLayer(l);
+            LayerCache& cache = stage.stash[i][l - stage.first_layer];
+            layer->restoreCache(cache);
+            cache = LayerCache();
+            
+            if (last && l + 1 == stage.last_layer) {
+                errors = network_.computeOutputLayerErrors(layer->getLastOutputs(), (*batch_)[i].second);
+            }
+            errors = layer->backward(errors, 1.0, l > 0);
+        }
+        
+        // 各层梯度按层顺序展平后累加，顺序与Network::getGradients相同
+        for (size_t l = stage.first_layer; l < stage.last_layer; l++) {
+            auto layer = network_.getLayer(l);
+            layer->exportGradients(gradients);
+            gradients += layer->parameterCount();
+        }
+        for (size_t p = 0; p < stage.gradients.size(); p++) {
+            stage.gradients[p] += stage.scratch[p];
+        }
+        stage.stashed--;
+        stage.busy_seconds += secondsSince(start);
+        
+        if (index > 0) {
+            Message message;
+            message.sample = i;
+            message.data = std::move(errors);
+            stages_[index - 1]->backward_in->push(std::move(message));
+        }
+    }
+}
+
+} // namespace neural_network
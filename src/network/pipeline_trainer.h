@@ -0,0 +1,165 @@
+#ifndef PIPELINE_TRAINER_H
+#define PIPELINE_TRAINER_H
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include "network.h"
+#include "evaluation.h"
+#include "spsc_queue.h"
+
+namespace neural_network {
+
+/**
+ * @brief 流水线调度方式
+ */
+enum class PipelineSchedule {
+    GPIPE,          ///< 先完成所有微批次的前向传播，再依次反向传播
+    ONE_F_ONE_B     ///< 预热后前向与反向交替进行，在途微批次数不超过流水线深度
+};
+
+/**
+ * @brief 一次流水线训练的统计信息
+ */
+struct PipelineStats {
+    double wall_seconds = 0.0;                  ///< 整批训练耗时
+    std::vector<double> stage_busy_seconds;     ///< 各阶段实际计算耗时
+    std::vector<double> stage_utilization;      ///< 各阶段利用率（计算耗时 / 整批耗时）
+    std::vector<size_t> peak_stashed_samples;   ///< 各阶段同时暂存的最大样本数
+    double bubble_fraction = 0.0;               ///< 气泡比例（1 - 平均利用率）
+    double mean_loss = 0.0;                     ///< 批次平均损失
+    size_t queue_capacity = 0;                  ///< 阶段间每个队列的容量（样本数）
+};
+
+/**
+ * @brief 按层划分阶段的流水线并行训练器
+ * 
+ * 网络的连续若干层组成一个阶段，每个阶段由一个常驻线程负责。
+ * 一个批次被切分为若干微批次，前向激活值和反向误差通过有界无锁SPSC队列在相邻阶段间传递，
+ * 每个队列容纳的微批次数等于阶段数，不随微批次数增长；
+ * 每个样本在各层的前向缓存被取出暂存，轮到其反向传播时再放回层中。
+ * 各阶段按样本顺序累加梯度，整批结束后取平均并更新自己的层（同步流水线），
+ * 因此结果与逐样本计算梯度后统一更新的串行训练逐位一致。
+ * 
+ * 训练期间不得从其他线程访问该网络。不支持混合精度的损失缩放和激活值检查点。
+ */
+class PipelineTrainer {
+public:
+    /**
+     * @brief 构造函数，按参数量均衡地把层划分为阶段并启动阶段线程
+     * @param network 待训练的网络
+     * @param numStages 阶段数（不超过层数）
+     * @param schedule 调度方式
+     */
+    PipelineTrainer(Network& network, size_t numStages,
+                    PipelineSchedule schedule = PipelineSchedule::ONE_F_ONE_B);
+    
+    /**
+     * @brief 析构函数，停止阶段线程
+     */
+    ~PipelineTrainer();
+    
+    PipelineTrainer(const PipelineTrainer&) = delete;
+    PipelineTrainer& operator=(const PipelineTrainer&) = delete;
+    
+    /**
+     * @brief 在一个批次上训练一步
+     * @param batch 批次样本
+     * @param numMicroBatches 微批次数量（不超过样本数）
+     * @param learningRate 学习率
+     * @return 统计信息
+     */
+    PipelineStats trainBatch(const Dataset& batch, size_t numMicroBatches, double learningRate);
+    
+    /**
+     * @brief 设置调度方式
+     * @param schedule 调度方式
+     */
+    void setSchedule(PipelineSchedule schedule);
+    
+    /**
+     * @brief 获取阶段数
+     * @return 阶段数
+     */
+    size_t getStageCount() const;
+    
+    /**
+     * @brief 获取各阶段的第一层索引
+     * @return 每个阶段的起始层索引
+     */
+    std::vector<size_t> getStageBoundaries() const;
+
+private:
+    /**
+     * @brief 阶段间传递的消息
+     */
+    struct Message {
+        size_t sample = 0;              ///< 样本序号
+        std::vector<double> data;       ///< 激活值或误差
+    };
+    
+    /**
+     * @brief 流水线阶段
+     */
+    struct Stage {
+        size_t first_layer = 0;                         ///< 第一层索引
+        size_t last_layer = 0;                          ///< 最后一层之后的索引
+        std::thread thread;                             ///< 阶段线程
+        std::unique_ptr<SpscQueue<Message>> forward_in; ///< 来自上一阶段的激活值
+        std::unique_ptr<SpscQueue<Message>> backward_in;///< 来自下一阶段的误差
+        std::vector<std::vector<LayerCache>> stash;     ///< 每个样本在各层的前向缓存
+        std::vector<double> gradients;                  ///< 本阶段各层梯度之和
+        std::vector<double> scratch;                    ///< 单个样本的梯度（临时）
+        double busy_seconds = 0.0;                      ///< 计算耗时
+        size_t stashed = 0;                             ///< 当前暂存样本数
+        size_t peak_stashed = 0;                        ///< 最大暂存样本数
+        double loss_sum = 0.0;                          ///< 最后阶段累计的损失
+    };
+    
+    /**
+     * @brief 阶段线程主循环：等待新批次，执行调度，报告完成
+     */
+    void stageLoop(size_t index);
+    
+    /**
+     * @brief 按调度执行一个阶段在当前批次上的全部工作
+     */
+    void runStage(size_t index);
+    
+    /**
+     * @brief 对一个微批次的所有样本执行本阶段的前向传播
+     */
+    void forwardMicroBatch(size_t index, size_t micro);
+    
+    /**
+     * @brief 对一个微批次的所有样本执行本阶段的反向传播
+     */
+    void backwardMicroBatch(size_t index, size_t micro);
+    
+    /**
+     * @brief 获取微批次的样本区间起点
+     */
+    size_t microBegin(size_t micro) const;
+    
+    Network& network_;                          ///< 待训练的网络
+    std::vector<std::unique_ptr<Stage>> stages_;///< 各阶段
+    PipelineSchedule schedule_;                 ///< 调度方式
+    
+    const Dataset* batch_ = nullptr;            ///< 当前批次
+    size_t micro_batches_ = 0;                  ///< 当前微批次数
+    double learning_rate_ = 0.0;                ///< 当前学习率
+    
+    std::mutex mutex_;                          ///< 保护以下批次同步状态
+    std::condition_variable start_cv_;         ///< 通知阶段线程开始
+    std::condition_variable done_cv_;          ///< 通知调用者批次完成
+    uint64_t generation_ = 0;                   ///< 批次代数
+    size_t remaining_ = 0;                      ///< 尚未完成的阶段数
+    bool stopping_ = false;                     ///< 是否正在停止
+};
+
+} // namespace neural_network
+
+#endif // PIPELINE_TRAINER_H
@@ -0,0 +1,190 @@
+#include "pooling_layer.h"
+#include "tracer.h"
+#include <algorithm>
+
+namespace neural_network {
+
+PoolingLayer::PoolingLayer(PoolingType type, size_t channels, size_t inHeight, size_t inWidth,
+                           size_t poolSize, size_t stride)
+    : Layer(0, channels * inHeight * inWidth, WeightInitScheme::UNIFORM),
+      type_(type), channels_(channels), in_height_(inHeight), in_width_(inWidth),
+      pool_size_(std::max<size_t>(poolSize, 1)), stride_(stride == 0 ? std::max<size_t>(poolSize, 1) : stride),
+      out_height_(0), out_width_(0) {
+    if (inHeight >= pool_size_ && inWidth >= pool_size_) {
+        out_height_ = (inHeight - pool_size_) / stride_ + 1;
+        out_width_ = (inWidth - pool_size_) / stride_ + 1;
+    }
+    last_outputs_.resize(size());
+}
+
+std::vector<double> PoolingLayer::forward(const std::vector<double>& inputs) {
+    NN_TRACE_SCOPE_ARG("layer", "PoolingLayer::forward", "channels", channels_);
+    last_inputs_ = inputs;
+    last_inputs_.resize(num_inputs_, 0.0);
+    pool(last_inputs_, last_outputs_, nullptr);
+    return last_outputs_;
+}
+
+std::vector<std::vector<double>> PoolingLayer::predictBatch(const std::vector<std::vector<double>>& batch) const {
+    std::vector<std::vector<double>> outputs(batch.size());
+    std::vector<double> padded;
+    for (size_t s = 0; s < batch.size(); s++) {
+        padded = batch[s];
+        padded.resize(num_inputs_, 0.0);
+        pool(padded, outputs[s], nullptr);
+    }
+    return outputs;
+}
+
+void PoolingLayer::pool(const std::vector<double>& inputs, std::vector<double>& outputs,
+                        std::vector<size_t>* argmax) const {
+    outputs.assign(size(), 0.0);
+    if (argmax) {
+        argmax->assign(size(), 0);
+    }
+    const double area = static_cast<double>(pool_size_ * pool_size_);
+    
+    for (size_t c = 0; c < channels_; c++) {
+        const size_t channel_offset = c * in_height_ * in_width_;
+        for (size_t oh = 0; oh < out_height_; oh++) {
+            for (size_t ow = 0; ow < out_width_; ow++) {
+                const size_t out_index = (c * out_height_ + oh) * out_width_ + ow;
+                size_t best = channel_offset + oh * stride_ * in_width_ + ow * stride_;
+                double sum = 0.0;
+                
+                for (size_t ki = 0; ki < pool_size_; ki++) {
+                    for (size_t kj = 0; kj < pool_size_; kj++) {
+                        size_t index = channel_offset + (oh * stride_ + ki) * in_width_ + ow * stride_ + kj;
+                        sum += inputs[index];
+                        if (inputs[index] > inputs[best]) {
+                            best = index;
+                        }
+                    }
+                }
+                
+                if (type_ == PoolingType::MAX) {
+                    outputs[out_index] = inputs[best];
+                    if (argmax) {
+                        (*argmax)[out_index] = best;
+                    }
+                } else {
+                    outputs[out_index] = sum / area;
+                }
+            }
+        }
+    }
+}
+
+std::vector<double> PoolingLayer::backward(const std::vector<double>& errors, double /*gradientScale*/,
+                                           bool propagateErrors) {
+    NN_TRACE_SCOPE_ARG("layer", "PoolingLayer::backward", "channels", channels_);
+    if (!propagateErrors) {
+        return {};
+    }
+    
+    std::vector<double> prev_errors(num_inputs_, 0.0);
+    if (type_ == PoolingType::MAX) {
+        // 误差只传给窗口内的最大值位置（由缓存的输入重新确定）
+        std::vector<double> outputs;
+        std::vector<size_t> argmax;
+        pool(last_inputs_, outputs, &argmax);
+        for (size_t i = 0; i < errors.size(); i++) {
+            prev_errors[argmax[i]] += errors[i];
+        }
+        return prev_errors;
+    }
+    
+    // 平均池化：误差平均分给窗口内的每个位置
+    const double area = static_cast<double>(pool_size_ * pool_size_);
+    for (size_t c = 0; c < channels_; c++) {
+        const size_t channel_offset = c * in_height_ * in_width_;
+        for (size_t oh = 0; oh < out_height_; oh++) {
+            for (size_t ow = 0; ow < out_width_; ow++) {
+                double share = errors[(c * out_height_ + oh) * out_width_ + ow] / area;
+                for (size_t ki = 0; ki < pool_size_; ki++) {
+                    for (size_t kj = 0; kj < pool_size_; kj++) {
+                        prev_errors[channel_offset + (oh * stride_ + ki) * in_width_ + ow * stride_ + kj] += share;
+                    }
+                }
+            }
+        }
+    }
+    return prev_errors;
+}
+
+void PoolingLayer::updateWeights(double /*learningRate*/) {
+    // 池化层没有参数
+}
+
+size_t PoolingLayer::parameterCount() const {
+    return 0;
+}
+
+void PoolingLayer::exportParameters(double* /*out*/) const {}
+
+void PoolingLayer::importParameters(const double* /*in*/) {}
+
+void PoolingLayer::exportGradients(double* /*out*/) const {}
+
+void PoolingLayer::importGradients(const double* /*in*/) {}
+
+double PoolingLayer::outputDerivative(size_t /*index*/, double /*output*/) const {
+    return 1.0;
+}
+
+size_t PoolingLayer::size() const {
+    return channels_ * out_height_ * out_width_;
+}
+
+std::string PoolingLayer::kernelShapeKey() const {
+    // 池化层只有一种实现，不参与调优
+    return "";
+}
+
+std::vector<KernelConfig> PoolingLayer::kernelCandidates(size_t /*maxThreads*/) const {
+    return {};
+}
+
+std::string PoolingLayer::typeName() const {
+    return type_ == PoolingType::MAX ? "maxpool" : "avgpool";
+}
+
+void PoolingLayer::save(std::ostream& out, PrecisionType /*precision*/) const {
+    out << typeName() << " " << channels_ << " " << in_height_ << " " << in_width_ << " "
+        << pool_size_ << " " << stride_ << std::endl;
+}
+
+bool PoolingLayer::loadParameters(std::istream& /*in*/) {
+    return true;
+}
+
+LayerMemoryUsage PoolingLayer::memoryUsage() const {
+    LayerMemoryUsage usage;
+    usage.type = typeName();
+    usage.parameter_bytes = 0;
+    usage.overhead_bytes = sizeof(PoolingLayer) + cacheBytes();
+    return usage;
+}
+
+std::shared_ptr<PoolingLayer> PoolingLayer::fromHeader(PoolingType type, std::istream& in) {
+    size_t channels, in_height, in_width, pool_size, stride;
+    in >> channels >> in_height >> in_width >> pool_size >> stride;
+    if (in.fail()) {
+        return nullptr;
+    }
+    return std::make_shared<PoolingLayer>(type, channels, in_height, in_width, pool_size, stride);
+}
+
+void PoolingLayer::initializeWeights(WeightInitScheme scheme, uint64_t /*seed*/) {
+    init_scheme_ = scheme;
+}
+
+void PoolingLayer::setPrecision(PrecisionType /*precision*/) {
+    // 池化层没有参数
+}
+
+PoolingType PoolingLayer::getPoolingType() const {
+    return type_;
+}
+
+} // namespace neural_network
@@ -0,0 +1,95 @@
+#ifndef POOLING_LAYER_H
+#define POOLING_LAYER_H
+
+#include <vector>
+#include <memory>
+#include <string>
+#include "layer.h"
+
+namespace neural_network {
+
+/**
+ * @brief 池化方式枚举
+ */
+enum class PoolingType {
+    MAX,
+    AVERAGE
+};
+
+/**
+ * @brief 二维池化层（无参数）
+ * 
+ * 输入和输出均按（通道，行，列）顺序展平，各通道独立池化，不补零。
+ */
+class PoolingLayer : public Layer {
+public:
+    /**
+     * @brief 构造函数
+     * @param type 池化方式
+     * @param channels 通道数
+     * @param inHeight 输入高度
+     * @param inWidth 输入宽度
+     * @param poolSize 池化窗口边长
+     * @param stride 步长，0表示与窗口边长相同
+     */
+    PoolingLayer(PoolingType type, size_t channels, size_t inHeight, size_t inWidth,
+                 size_t poolSize, size_t stride = 0);
+    
+    std::vector<double> forward(const std::vector<double>& inputs) override;
+    std::vector<std::vector<double>> predictBatch(const std::vector<std::vector<double>>& batch) const override;
+    std::vector<double> backward(const std::vector<double>& errors, double gradientScale = 1.0,
+                                 bool propagateErrors = true) override;
+    void updateWeights(double learningRate) override;
+    size_t parameterCount() const override;
+    void exportParameters(double* out) const override;
+    void importParameters(const double* in) override;
+    void exportGradients(double* out) const override;
+    void importGradients(const double* in) override;
+    double outputDerivative(size_t index, double output) const override;
+    size_t size() const override;
+    std::string typeName() const override;
+    void save(std::ostream& out, PrecisionType precision) const override;
+    bool loadParameters(std::istream& in) override;
+    LayerMemoryUsage memoryUsage() const override;
+    void initializeWeights(WeightInitScheme scheme, uint64_t seed) override;
+    void setPrecision(PrecisionType precision) override;
+    std::string kernelShapeKey() const override;
+    std::vector<KernelConfig> kernelCandidates(size_t maxThreads) const override;
+    
+    /**
+     * @brief 从模型文件的层描述行创建池化层（类型名已读取）
+     * @param type 池化方式（由类型名决定）
+     * @param in 输入流
+     * @return 池化层，格式错误时返回nullptr
+     */
+    static std::shared_ptr<PoolingLayer> fromHeader(PoolingType type, std::istream& in);
+    
+    /**
+     * @brief 获取池化方式
+     * @return 池化方式
+     */
+    PoolingType getPoolingType() const;
+
+private:
+    PoolingType type_;     ///< 池化方式
+    size_t channels_;      ///< 通道数
+    size_t in_height_;     ///< 输入高度
+    size_t in_width_;      ///< 输入宽度
+    size_t pool_size_;     ///< 窗口边长
+    size_t stride_;        ///< 步长
+    size_t out_height_;    ///< 输出高度
+    size_t out_width_;     ///< 输出宽度
+    
+    /**
+     * @brief 计算池化输出
+     * @param inputs 输入
+     * @param outputs 输出
+     * @param argmax 最大池化时记录每个输出对应的输入下标（可为nullptr）
+     */
+    void pool(const std::vector<double>& inputs, std::vector<double>& outputs,
+              std::vector<size_t>* argmax) const;
+};
+
+} // namespace neural_network
+
+#endif // POOLING_LAYER_H
@@ -0,0 +1,298 @@
+#include "shared_model.h"
+#include "dense_kernel.h"
+#include <atomic>
+#include <new>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace neural_network {
+
+namespace {
+
+const uint64_t kSharedModelMagic = 0x4c444f4d4e4e5348ull; // "HSNNMODL"
+const uint32_t kSharedModelVersion = 1;
+
+size_t pageSize() {
+    return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+size_t roundUpToPage(size_t bytes) {
+    size_t page = pageSize();
+    return (bytes + page - 1) / page * page;
+}
+
+int openSegment(const std::string& name, SharedModelBacking backing, int flags) {
+    if (backing == SharedModelBacking::SHARED_MEMORY) {
+        return shm_open(name.c_str(), flags, 0644);
+    }
+    return open(name.c_str(), flags, 0644);
+}
+
+} // namespace
+
+struct SharedModel::SegmentHeader {
+    uint64_t magic;                    ///< 魔数，最后写入，表示段已就绪
+    uint32_t version;                  ///< 格式版本
+    uint32_t layer_count;              ///< 层数
+    std::atomic<uint32_t> ref_count;   ///< 所有进程的引用计数
+    uint32_t reserved;                 ///< 保留
+    uint64_t header_bytes;             ///< 头部区域大小（页对齐）
+    uint64_t data_bytes;               ///< 权重区域大小
+};
+
+struct SharedModel::LayerDescriptor {
+    uint64_t rows;                     ///< 神经元数量
+    uint64_t cols;                     ///< 输入数量
+    uint64_t offset;                   ///< 权重在数据区中的偏移（以double计）
+    uint32_t activation;               ///< 激活函数类型
+    uint32_t reserved;                 ///< 保留
+};
+
+std::shared_ptr<SharedModel> SharedModel::publish(const std::string& name, const Network& network,
+                                                  SharedModelBacking backing) {
+    const size_t layer_count = network.getLayerCount();
+    
+    // 只支持全连接层，且每层只记录一个激活函数，神经元激活函数不一致的层无法发布
+    for (size_t i = 0; i < layer_count; i++) {
+        auto layer = network.getLayer(i);
+        if (layer->typeName() != "dense") {
+            return nullptr;
+        }
+        const auto& neurons = layer->getNeurons();
+        for (const auto& neuron : neurons) {
+            if (neuron->getActivationType() != neurons[0]->getActivationType()) {
+                return nullptr;
+            }
+        }
+    }
+    
+    // 计算布局
+    std::vector<LayerDescriptor> descriptors(layer_count);
+    size_t data_doubles = 0;
+    for (size_t i = 0; i < layer_count; i++) {
+        auto layer = network.getLayer(i);
+        LayerDescriptor& desc = descriptors[i];
+        desc.rows = layer->size();
+        desc.cols = layer->inputSize();
+        desc.offset = data_doubles;
+        desc.activation = static_cast<uint32_t>(
+            layer->size() > 0 ? layer->getNeurons()[0]->getActivationType() : ActivationType::SIGMOID);
+        desc.reserved = 0;
+        data_doubles += desc.rows * desc.cols + desc.rows;
+    }
+    
+    const size_t header_bytes = roundUpToPage(sizeof(SegmentHeader) + layer_count * sizeof(LayerDescriptor));
+    const size_t data_bytes = data_doubles * sizeof(double);
+    const size_t total_bytes = header_bytes + data_bytes;
+    
+    // 文件方式先写临时文件，写完后再以硬链接原子地占用目标名称，读者不会看到写了一半的文件
+    std::string create_name = name;
+    if (backing == SharedModelBacking::FILE) {
+        create_name = name + ".tmp." + std::to_string(getpid());
+    }
+    
+    int fd = openSegment(create_name, backing, O_CREAT | O_EXCL | O_RDWR);
+    if (fd < 0) {
+        return nullptr;
+    }
+    
+    auto cleanup = [&]() {
+        close(fd);
+        if (backing == SharedModelBacking::SHARED_MEMORY) {
+            shm_unlink(create_name.c_str());
+        } else {
+            unlink(create_name.c_str());
+        }
+    };
+    
+    if (ftruncate(fd, static_cast<off_t>(total_bytes)) != 0) {
+        cleanup();
+        return nullptr;
+    }
+    
+    void* base = mmap(nullptr, total_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        cleanup();
+        return nullptr;
+    }
+    
+    // 写入描述符和权重
+    auto* bytes = static_cast<unsigned char*>(base);
+    std::memcpy(bytes + sizeof(SegmentHeader), descriptors.data(), layer_count * sizeof(LayerDescriptor));
+    auto* data = reinterpret_cast<double*>(bytes + header_bytes);
+    for (size_t i = 0; i < layer_count; i++) {
+        const auto& neurons = network.getLayer(i)->getNeurons();
+        const LayerDescriptor& desc = descriptors[i];
+        double* weights = data + desc.offset;
+        double* biases = weights + desc.rows * desc.cols;
+        for (size_t j = 0; j < desc.rows; j++) {
+            const auto& row = neurons[j]->getWeights();
+            std::copy(row.begin(), row.end(), weights + j * desc.cols);
+            biases[j] = neurons[j]->getBias();
+        }
+    }
+    
+    // 头部最后写入：发布者持有第一个引用
+    auto* header = new (base) SegmentHeader;
+    header->version = kSharedModelVersion;
+    header->layer_count = static_cast<uint32_t>(layer_count);
+    header->ref_count.store(1, std::memory_order_relaxed);
+    header->reserved = 0;
+    header->header_bytes = header_bytes;
+    header->data_bytes = data_bytes;
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = kSharedModelMagic;
+    munmap(base, total_bytes);
+    
+    // link在目标已存在时失败（rename会静默替换），与共享内存的O_EXCL语义一致
+    if (backing == SharedModelBacking::FILE) {
+        const bool linked = link(create_name.c_str(), name.c_str()) == 0;
+        unlink(create_name.c_str());
+        if (!linked) {
+            close(fd);
+            return nullptr;
+        }
+    }
+    
+    std::shared_ptr<SharedModel> model(new SharedModel());
+    model->name_ = name;
+    model->backing_ = backing;
+    bool mapped = model->map(fd);
+    close(fd);
+    if (!mapped) {
+        return nullptr;
+    }
+    return model;
+}
+
+std::shared_ptr<SharedModel> SharedModel::attach(const std::string& name, SharedModelBacking backing) {
+    int fd = openSegment(name, backing, O_RDWR);
+    if (fd < 0) {
+        return nullptr;
+    }
+    
+    std::shared_ptr<SharedModel> model(new SharedModel());
+    model->name_ = name;
+    model->backing_ = backing;
+    bool mapped = model->map(fd);
+    close(fd);
+    if (!mapped) {
+        return nullptr;
+    }
+    
+    // 引用计数为0表示段正在销毁，不能再附加
+    auto* header = static_cast<SegmentHeader*>(model->header_);
+    uint32_t count = header->ref_count.load();
+    do {
+        if (count == 0) {
+            model->header_ = nullptr; // 析构时不再释放引用
+            munmap(header, model->header_bytes_);
+            return nullptr;
+        }
+    } while (!header->ref_count.compare_exchange_weak(count, count + 1));
+    
+    return model;
+}
+
+bool SharedModel::remove(const std::string& name, SharedModelBacking backing) {
+    if (backing == SharedModelBacking::SHARED_MEMORY) {
+        return shm_unlink(name.c_str()) == 0;
+    }
+    return unlink(name.c_str()) == 0;
+}
+
+bool SharedModel::map(int fd) {
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < pageSize()) {
+        return false;
+    }
+    const size_t total_bytes = static_cast<size_t>(info.st_size);
+    
+    // 先映射第一页读取头部大小
+    void* first_page = mmap(nullptr, pageSize(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (first_page == MAP_FAILED) {
+        return false;
+    }
+    const auto* probe = static_cast<const SegmentHeader*>(first_page);
+    bool valid = probe->magic == kSharedModelMagic;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    valid = valid && probe->version == kSharedModelVersion &&
+            probe->header_bytes + probe->data_bytes == total_bytes;
+    const size_t header_bytes = valid ? probe->header_bytes : 0;
+    munmap(first_page, pageSize());
+    if (!valid) {
+        return false;
+    }
+    
+    header_ = mmap(nullptr, header_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (header_ == MAP_FAILED) {
+        header_ = nullptr;
+        return false;
+    }
+    header_bytes_ = header_bytes;
+    
+    data_bytes_ = total_bytes - header_bytes;
+    if (data_bytes_ > 0) {
+        void* data = mmap(nullptr, data_bytes_, PROT_READ, MAP_SHARED, fd, static_cast<off_t>(header_bytes));
+        if (data == MAP_FAILED) {
+            munmap(header_, header_bytes_);
+            header_ = nullptr;
+            return false;
+        }
+        data_ = data;
+    }
+    return true;
+}
+
+SharedModel::~SharedModel() {
+    if (header_) {
+        auto* header = static_cast<SegmentHeader*>(header_);
+        if (header->ref_count.fetch_sub(1) == 1 && backing_ == SharedModelBacking::SHARED_MEMORY) {
+            shm_unlink(name_.c_str());
+        }
+        munmap(header_, header_bytes_);
+    }
+    if (data_) {
+        munmap(const_cast<void*>(data_), data_bytes_);
+    }
+}
+
+std::vector<double> SharedModel::predict(const std::vector<double>& inputs) const {
+    const auto* header = static_cast<const SegmentHeader*>(header_);
+    const auto* descriptors = reinterpret_cast<const LayerDescriptor*>(
+        static_cast<const unsigned char*>(header_) + sizeof(SegmentHeader));
+    const auto* data = static_cast<const double*>(data_);
+    
+    if (header->layer_count > 0 && inputs.size() != descriptors[0].cols) {
+        return {};
+    }
+    
+    std::vector<double> current = inputs;
+    std::vector<double> next;
+    for (uint32_t i = 0; i < header->layer_count; i++) {
+        const LayerDescriptor& desc = descriptors[i];
+        next.resize(desc.rows);
+        const double* weights = data + desc.offset;
+        denseForward(weights, weights + desc.rows * desc.cols, desc.rows, desc.cols,
+                     static_cast<ActivationType>(desc.activation), current.data(), next.data());
+        current.swap(next);
+    }
+    return current;
+}
+
+size_t SharedModel::getLayerCount() const {
+    return static_cast<const SegmentHeader*>(header_)->layer_count;
+}
+
+uint32_t SharedModel::getRefCount() const {
+    return static_cast<const SegmentHeader*>(header_)->ref_count.load();
+}
+
+size_t SharedModel::getMappedBytes() const {
+    return header_bytes_ + data_bytes_;
+}
+
+} // namespace neural_network
@@ -0,0 +1,119 @@
+#ifndef SHARED_MODEL_H
+#define SHARED_MODEL_H
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include "network.h"
+
+namespace neural_network {
+
+/**
+ * @brief 共享模型的存储方式
+ */
+enum class SharedModelBacking {
+    SHARED_MEMORY,  ///< POSIX命名共享内存（名称形如"/model_name"）
+    FILE            ///< 普通文件的共享映射
+};
+
+/**
+ * @brief 跨进程只读共享的模型权重
+ * 
+ * 发布者把网络的权重、偏置和激活函数类型按层连续写入一个共享内存段，
+ * 其他进程以只读方式映射同一段内存，直接在映射的权重上推理而不复制。
+ * 
+ * 段的第一部分为可写的头部（包含引用计数），权重数据从页对齐位置开始，
+ * 以只读方式单独映射。每个SharedModel对象持有一个引用，
+ * 最后一个引用释放时自动删除共享内存名称（文件方式保留文件）。
+ * 进程异常退出时其引用不会被释放，需要调用remove()手动清理。
+ * 
+ * 仅支持以ActivationType设置激活函数的全连接层。
+ */
+class SharedModel {
+public:
+    /**
+     * @brief 将网络发布到共享内存段或文件
+     * @param name 共享内存名称或文件路径
+     * @param network 要发布的网络
+     * @param backing 存储方式
+     * @return 持有发布者引用的对象，失败时返回nullptr（如名称已存在、含非全连接层或层内激活函数不一致）
+     */
+    static std::shared_ptr<SharedModel> publish(const std::string& name, const Network& network,
+                                                SharedModelBacking backing = SharedModelBacking::SHARED_MEMORY);
+    
+    /**
+     * @brief 以只读方式附加到已发布的模型
+     * @param name 共享内存名称或文件路径
+     * @param backing 存储方式
+     * @return 模型对象，失败时返回nullptr（如不存在或正在销毁）
+     */
+    static std::shared_ptr<SharedModel> attach(const std::string& name,
+                                               SharedModelBacking backing = SharedModelBacking::SHARED_MEMORY);
+    
+    /**
+     * @brief 强制删除共享内存名称或文件（已映射的进程不受影响）
+     * @param name 共享内存名称或文件路径
+     * @param backing 存储方式
+     * @return 是否删除成功
+     */
+    static bool remove(const std::string& name,
+                       SharedModelBacking backing = SharedModelBacking::SHARED_MEMORY);
+    
+    /**
+     * @brief 析构函数，释放引用并解除映射
+     */
+    ~SharedModel();
+    
+    SharedModel(const SharedModel&) = delete;
+    SharedModel& operator=(const SharedModel&) = delete;
+    
+    /**
+     * @brief 直接在共享权重上进行前向传播（线程安全）
+     * @param inputs 输入值向量
+     * @return 网络输出值向量，输入数与第一层不符时返回空向量
+     */
+    std::vector<double> predict(const std::vector<double>& inputs) const;
+    
+    /**
+     * @brief 获取层数
+     * @return 层数
+     */
+    size_t getLayerCount() const;
+    
+    /**
+     * @brief 获取当前引用计数（所有进程合计）
+     * @return 引用计数
+     */
+    uint32_t getRefCount() const;
+    
+    /**
+     * @brief 获取映射的总字节数
+     * @return 字节数
+     */
+    size_t getMappedBytes() const;
+
+private:
+    struct SegmentHeader;
+    struct LayerDescriptor;
+    
+    SharedModel() = default;
+    
+    /**
+     * @brief 映射已打开的段：头部可写，权重只读
+     * @param fd 文件描述符
+     * @return 是否成功
+     */
+    bool map(int fd);
+    
+    std::string name_;                          ///< 共享内存名称或文件路径
+    SharedModelBacking backing_ = SharedModelBacking::SHARED_MEMORY; ///< 存储方式
+    void* header_ = nullptr;                    ///< 可写头部映射
+    size_t header_bytes_ = 0;                   ///< 头部映射大小
+    const void* data_ = nullptr;                ///< 只读权重映射
+    size_t data_bytes_ = 0;                     ///< 权重映射大小
+};
+
+} // namespace neural_network
+
+#endif // SHARED_MODEL_H
@@ -0,0 +1,107 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <cstddef>
+
+namespace neural_network {
+
+/**
+ * @brief 有界无锁单生产者单消费者队列
+ * 
+ * 环形缓冲区容量取不小于请求值的2的幂。生产者只写tail_，消费者只写head_，
+ * 以release/acquire配对发布元素。push在队列满、pop在队列空时让出CPU并重试。
+ * 两个索引分开放在不同缓存行，避免生产者和消费者互相失效。
+ * @tparam T 元素类型（需可移动赋值和默认构造）
+ */
+template <typename T>
+class SpscQueue {
+public:
+    /**
+     * @brief 构造函数
+     * @param capacity 最小容量
+     */
+    explicit SpscQueue(size_t capacity) : head_(0), tail_(0) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        slots_.resize(size);
+        mask_ = size - 1;
+    }
+    
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+    
+    /**
+     * @brief 尝试入队（仅生产者线程调用）
+     * @param value 元素，成功时被移走
+     * @return 队列满时返回false
+     */
+    bool tryPush(T& value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) > mask_) {
+            return false;
+        }
+        slots_[tail & mask_] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+    
+    /**
+     * @brief 入队，队列满时等待（仅生产者线程调用）
+     * @param value 元素
+     */
+    void push(T value) {
+        while (!tryPush(value)) {
+            std::this_thread::yield();
+        }
+    }
+    
+    /**
+     * @brief 尝试出队（仅消费者线程调用）
+     * @param value 接收元素
+     * @return 队列空时返回false
+     */
+    bool tryPop(T& value) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+    
+    /**
+     * @brief 出队，队列空时等待（仅消费者线程调用）
+     * @return 元素
+     */
+    T pop() {
+        T value;
+        while (!tryPop(value)) {
+            std::this_thread::yield();
+        }
+        return value;
+    }
+    
+    /**
+     * @brief 获取容量
+     * @return 容量
+     */
+    size_t capacity() const {
+        return mask_ + 1;
+    }
+
+private:
+    std::vector<T> slots_;                  ///< 环形缓冲区
+    size_t mask_;                           ///< 容量减1
+    alignas(64) std::atomic<size_t> head_;  ///< 下一个出队位置（消费者写）
+    alignas(64) std::atomic<size_t> tail_;  ///< 下一个入队位置（生产者写）
+};
+
+} // namespace neural_network
+
+#endif // SPSC_QUEUE_H
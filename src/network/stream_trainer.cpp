@@ -0,0 +1,360 @@
+#include "stream_trainer.h"
+#include "tracer.h"
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <poll.h>
+#include <unistd.h>
+
+namespace neural_network {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int kPollIntervalMs = 100;    ///< 读线程检查停止请求的间隔
+
+/**
+ * @brief 完整写入，处理部分写和EINTR
+ */
+bool writeFully(int fd, const char* data, size_t bytes) {
+    while (bytes > 0) {
+        ssize_t written = ::write(fd, data, bytes);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        bytes -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+} // namespace
+
+StreamTrainer::StreamTrainer(Network& network, const StreamOptions& options, ModelHandle* handle)
+    : network_(network), options_(options), handle_(handle), input_size_(0), width_(0) {
+    if (network_.getLayerCount() > 0) {
+        input_size_ = network_.getLayer(0)->inputSize();
+        width_ = input_size_ + network_.getLayer(network_.getLayerCount() - 1)->size();
+    }
+    options_.batch_size = std::max<size_t>(1, options_.batch_size);
+    options_.ring_capacity = std::max(options_.ring_capacity, options_.batch_size);
+    
+    // 读缓冲区至少能容纳一条完整的二进制记录
+    read_buffer_.resize(std::max(options_.read_buffer_bytes, sizeof(uint32_t) + width_ * sizeof(double)));
+    ring_.resize(options_.ring_capacity * width_);
+}
+
+bool StreamTrainer::run(int fd) {
+    if (width_ == 0) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        head_ = 0;
+        tail_ = 0;
+        finished_ = false;
+        read_failed_ = false;
+        stats_ = StreamStats();
+    }
+    stop_requested_ = false;
+    auto start = Clock::now();
+    
+    std::thread reader(&StreamTrainer::readLoop, this, fd);
+    
+    const size_t capacity = options_.ring_capacity;
+    const auto flush_timeout = std::chrono::milliseconds(options_.flush_timeout_ms);
+    std::vector<double> inputs(input_size_);
+    std::vector<double> targets(width_ - input_size_);
+    size_t batches_since_snapshot = 0;
+    while (true) {
+        size_t begin = 0;
+        size_t count = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto batch_ready = [&]() { return tail_ - head_ >= options_.batch_size || finished_; };
+            if (options_.flush_timeout_ms > 0) {
+                // 先等到至少一个样本，再最多等待flush_timeout凑满一批
+                not_empty_.wait(lock, [&]() { return tail_ > head_ || finished_; });
+                not_empty_.wait_for(lock, flush_timeout, batch_ready);
+            } else {
+                not_empty_.wait(lock, batch_ready);
+            }
+            begin = head_;
+            count = std::min(tail_ - head_, options_.batch_size);
+        }
+        if (count == 0) {
+            break;
+        }
+        
+        // 槽位在释放前不会被读线程覆盖，训练期间读线程可以继续填充其余槽位
+        {
+            NN_TRACE_SCOPE_ARG("network", "StreamTrainer batch", "samples", count);
+            for (size_t i = 0; i < count; i++) {
+                const double* slot = &ring_[((begin + i) % capacity) * width_];
+                inputs.assign(slot, slot + input_size_);
+                targets.assign(slot + input_size_, slot + width_);
+                network_.train(inputs, targets, options_.learning_rate);
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            head_ += count;
+            stats_.trained += count;
+            stats_.batches++;
+        }
+        not_full_.notify_one();
+        
+        batches_since_snapshot++;
+        if (options_.snapshot_interval > 0 && batches_since_snapshot >= options_.snapshot_interval) {
+            publishSnapshot();
+            batches_since_snapshot = 0;
+        }
+    }
+    reader.join();
+    
+    // 流结束时发布最后一次快照
+    if (batches_since_snapshot > 0) {
+        publishSnapshot();
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.wall_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return !read_failed_;
+}
+
+void StreamTrainer::stop() {
+    stop_requested_ = true;
+    std::lock_guard<std::mutex> lock(mutex_);
+    not_full_.notify_all();
+    not_empty_.notify_all();
+}
+
+StreamStats StreamTrainer::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+size_t StreamTrainer::getBufferBytes() const {
+    return read_buffer_.size() + ring_.size() * sizeof(double);
+}
+
+bool StreamTrainer::writeBinaryRecord(int fd, const std::vector<double>& inputs, const std::vector<double>& targets) {
+    const size_t values = inputs.size() + targets.size();
+    const uint32_t length = static_cast<uint32_t>(values * sizeof(double));
+    std::vector<char> record(sizeof(uint32_t) + length);
+    for (size_t b = 0; b < sizeof(uint32_t); b++) {
+        record[b] = static_cast<char>((length >> (8 * b)) & 0xff);
+    }
+    std::memcpy(record.data() + sizeof(uint32_t), inputs.data(), inputs.size() * sizeof(double));
+    std::memcpy(record.data() + sizeof(uint32_t) + inputs.size() * sizeof(double), targets.data(),
+                targets.size() * sizeof(double));
+    return writeFully(fd, record.data(), record.size());
+}
+
+void StreamTrainer::readLoop(int fd) {
+    Tracer::instance().setThreadName("stream reader");
+    char* data = read_buffer_.data();
+    size_t filled = 0;
+    size_t skip = 0;
+    bool failed = false;
+    while (!stop_requested_) {
+        // 定期醒来检查停止请求，避免阻塞在没有数据的管道上
+        pollfd descriptor = {fd, POLLIN, 0};
+        int ready = poll(&descriptor, 1, kPollIntervalMs);
+        if (ready < 0 && errno != EINTR) {
+            failed = true;
+            break;
+        }
+        if (ready <= 0) {
+            continue;
+        }
+        
+        ssize_t received = ::read(fd, data + filled, read_buffer_.size() - filled);
+        if (received < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            failed = true;
+            break;
+        }
+        if (received == 0) {
+            // 最后一行CSV可以没有换行符；其余残留的半条记录计为格式错误
+            if (options_.format == StreamFormat::CSV && filled > 0 && filled < read_buffer_.size()) {
+                data[filled++] = '\n';
+                filled -= parseRecords(data, filled, skip);
+            }
+            if (filled > 0) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stats_.malformed++;
+            }
+            break;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.bytes_read += static_cast<uint64_t>(received);
+        }
+        filled += static_cast<size_t>(received);
+        
+        size_t consumed = parseRecords(data, filled, skip);
+        std::memmove(data, data + consumed, filled - consumed);
+        filled -= consumed;
+        
+        // 缓冲区已满仍没有完整的CSV行：丢弃这一行的剩余部分
+        if (filled == read_buffer_.size()) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.malformed += skip == 0 ? 1 : 0;
+            filled = 0;
+            skip = 1;
+        }
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    finished_ = true;
+    read_failed_ = failed;
+    not_empty_.notify_all();
+}
+
+size_t StreamTrainer::parseRecords(char* data, size_t size, size_t& skip) {
+    size_t position = 0;
+    if (options_.format == StreamFormat::BINARY) {
+        const size_t expected = width_ * sizeof(double);
+        while (true) {
+            if (skip > 0) {
+                size_t dropped = std::min(skip, size - position);
+                position += dropped;
+                skip -= dropped;
+                if (skip > 0) {
+                    break;
+                }
+            }
+            if (size - position < sizeof(uint32_t)) {
+                break;
+            }
+            const auto* prefix = reinterpret_cast<const unsigned char*>(data + position);
+            uint32_t length = 0;
+            for (size_t b = 0; b < sizeof(uint32_t); b++) {
+                length |= static_cast<uint32_t>(prefix[b]) << (8 * b);
+            }
+            if (length != expected) {
+                // 长度不符的记录整条跳过，可以跨越多次读取
+                std::lock_guard<std::mutex> lock(mutex_);
+                stats_.malformed++;
+                position += sizeof(uint32_t);
+                skip = length;
+                continue;
+            }
+            if (size - position < sizeof(uint32_t) + length) {
+                break;
+            }
+            double* slot = acquireSlot();
+            if (!slot) {
+                break;
+            }
+            std::memcpy(slot, data + position + sizeof(uint32_t), length);
+            commitSlot();
+            position += sizeof(uint32_t) + length;
+        }
+        return position;
+    }
+    
+    while (position < size) {
+        char* line = data + position;
+        char* end = static_cast<char*>(std::memchr(line, '\n', size - position));
+        if (!end) {
+            break;
+        }
+        position = static_cast<size_t>(end - data) + 1;
+        if (skip > 0) {
+            skip = 0;
+            continue;
+        }
+        
+        // 就地截断成C字符串，strtod不会越过行尾
+        *end = '\0';
+        if (end > line && end[-1] == '\r') {
+            end[-1] = '\0';
+        }
+        if (line[0] == '\0') {
+            continue;
+        }
+        double* slot = acquireSlot();
+        if (!slot) {
+            break;
+        }
+        char* cursor = line;
+        bool valid = true;
+        for (size_t k = 0; k < width_ && valid; k++) {
+            char* next = nullptr;
+            slot[k] = std::strtod(cursor, &next);
+            valid = next != cursor;
+            cursor = next;
+            while (*cursor == ' ' || *cursor == '\t') {
+                cursor++;
+            }
+            if (valid && k + 1 < width_) {
+                valid = *cursor == ',';
+                cursor++;
+            }
+        }
+        if (valid && *cursor == '\0') {
+            commitSlot();
+        } else {
+            // 槽位未提交，下一条记录会覆盖它
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.malformed++;
+        }
+    }
+    return position;
+}
+
+double* StreamTrainer::acquireSlot() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const size_t capacity = options_.ring_capacity;
+    if (tail_ - head_ >= capacity) {
+        // 背压：缓冲区满时不再读取，等训练线程释放槽位
+        stats_.producer_waits++;
+        not_full_.wait(lock, [&]() { return tail_ - head_ < capacity || stop_requested_; });
+    }
+    if (stop_requested_) {
+        return nullptr;
+    }
+    return &ring_[(tail_ % capacity) * width_];
+}
+
+void StreamTrainer::commitSlot() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tail_++;
+        stats_.records++;
+    }
+    not_empty_.notify_one();
+}
+
+void StreamTrainer::publishSnapshot() {
+    NN_TRACE_SCOPE("io", "StreamTrainer snapshot");
+    if (handle_) {
+        auto copy = network_.clone();
+        if (copy) {
+            handle_->publish(std::move(copy));
+        }
+    }
+    if (!options_.snapshot_file.empty()) {
+        // 先写临时文件再改名，读者不会看到写了一半的快照
+        const std::string temp_name = options_.snapshot_file + ".tmp";
+        if (network_.saveModel(temp_name)) {
+            std::rename(temp_name.c_str(), options_.snapshot_file.c_str());
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.snapshots++;
+}
+
+} // namespace neural_network
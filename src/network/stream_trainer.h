@@ -0,0 +1,162 @@
+#ifndef STREAM_TRAINER_H
+#define STREAM_TRAINER_H
+
+#include <vector>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include "network.h"
+#include "model_handle.h"
+
+namespace neural_network {
+
+/**
+ * @brief 流式记录格式
+ */
+enum class StreamFormat {
+    BINARY,     ///< 4字节小端长度前缀 + 本机字节序的输入与目标double数组（长度必须等于(输入数+输出数)*8）
+    CSV         ///< 每行输入值在前、目标值在后，以逗号分隔
+};
+
+/**
+ * @brief 流式训练选项
+ */
+struct StreamOptions {
+    StreamFormat format = StreamFormat::BINARY;   ///< 记录格式
+    size_t batch_size = 32;                       ///< 每次训练取出的样本数
+    size_t ring_capacity = 1024;                  ///< 环形缓冲区可容纳的样本数
+    size_t read_buffer_bytes = 64 * 1024;         ///< 读缓冲区字节数（限制单条记录的最大长度）
+    double learning_rate = 0.1;                   ///< 学习率
+    size_t flush_timeout_ms = 100;                ///< 凑不满一批时等待多久后先训练已有样本，0表示总是等满
+    size_t snapshot_interval = 0;                 ///< 每隔多少批发布一次快照，0表示只在流结束时发布
+    std::string snapshot_file;                    ///< 快照文件（先写临时文件再改名），为空时不写文件
+};
+
+/**
+ * @brief 流式训练统计信息
+ */
+struct StreamStats {
+    uint64_t bytes_read = 0;          ///< 读取的字节数
+    uint64_t records = 0;             ///< 解析成功的记录数
+    uint64_t malformed = 0;           ///< 丢弃的格式错误或超长记录数
+    uint64_t trained = 0;             ///< 已训练的样本数
+    uint64_t batches = 0;             ///< 已训练的批次数
+    uint64_t snapshots = 0;           ///< 已发布的快照数
+    uint64_t producer_waits = 0;      ///< 缓冲区满、读线程停止读取的次数（背压）
+    double wall_seconds = 0.0;        ///< 总耗时
+};
+
+/**
+ * @brief 从文件描述符（管道、套接字或文件）持续读取样本的在线训练器
+ *
+ * 读线程把数据读入固定大小的读缓冲区，直接在缓冲区上解析记录（二进制记录按长度前缀定位，
+ * CSV用strtod就地解析），样本值写入固定容量的环形缓冲区的槽位，不产生中间对象。
+ * 调用run()的线程按批取出样本，用Network::train逐个更新权重，再释放槽位。
+ * 环形缓冲区满时读线程不再读取，管道写满后上游写者随之阻塞，形成背压；
+ * 因此内存占用只由读缓冲区和环形缓冲区决定，与流的长度无关。
+ *
+ * 快照通过Network::clone()复制后发布到ModelHandle，推理线程可以在训练进行的同时读取；
+ * 也可以写入snapshot_file。训练期间不得从其他线程访问该网络。
+ */
+class StreamTrainer {
+public:
+    /**
+     * @brief 构造函数，按网络的输入和输出大小分配缓冲区
+     * @param network 待训练的网络
+     * @param options 选项
+     * @param handle 发布快照的模型句柄，为空时不发布
+     */
+    StreamTrainer(Network& network, const StreamOptions& options = StreamOptions(), ModelHandle* handle = nullptr);
+    
+    StreamTrainer(const StreamTrainer&) = delete;
+    StreamTrainer& operator=(const StreamTrainer&) = delete;
+    
+    /**
+     * @brief 从fd读取并训练，直到流结束或调用stop()
+     * @param fd 文件描述符（不会被关闭）
+     * @return 网络为空或读取出错时返回false
+     */
+    bool run(int fd);
+    
+    /**
+     * @brief 请求run()尽快返回（可从其他线程调用），已读入的样本仍会训练完
+     */
+    void stop();
+    
+    /**
+     * @brief 获取统计信息（可在run()期间从其他线程调用）
+     * @return 统计信息
+     */
+    StreamStats getStats() const;
+    
+    /**
+     * @brief 获取读缓冲区和环形缓冲区占用的字节数
+     * @return 字节数
+     */
+    size_t getBufferBytes() const;
+    
+    /**
+     * @brief 以二进制格式向fd写入一条记录（供数据生成端使用）
+     * @param fd 文件描述符
+     * @param inputs 输入值
+     * @param targets 目标值
+     * @return 是否完整写入
+     */
+    static bool writeBinaryRecord(int fd, const std::vector<double>& inputs, const std::vector<double>& targets);
+
+private:
+    Network& network_;                      ///< 待训练的网络
+    StreamOptions options_;                 ///< 选项
+    ModelHandle* handle_;                   ///< 快照发布目标
+    size_t input_size_;                     ///< 每条记录的输入数
+    size_t width_;                          ///< 每条记录的值个数（输入数 + 输出数）
+    
+    std::vector<char> read_buffer_;         ///< 读缓冲区
+    std::vector<double> ring_;              ///< 环形缓冲区，每个槽位width_个值
+    size_t head_ = 0;                       ///< 下一个待训练的样本序号
+    size_t tail_ = 0;                       ///< 下一个待写入的样本序号
+    bool finished_ = false;                 ///< 读线程已结束
+    bool read_failed_ = false;              ///< 读取出错
+    StreamStats stats_;                     ///< 统计信息
+    mutable std::mutex mutex_;              ///< 保护以上环形缓冲区状态和统计信息
+    std::condition_variable not_full_;      ///< 通知读线程有空闲槽位
+    std::condition_variable not_empty_;     ///< 通知训练线程有新样本
+    std::atomic<bool> stop_requested_{false};  ///< 已请求停止
+    
+    /**
+     * @brief 读线程主循环：读取、解析并写入环形缓冲区
+     * @param fd 文件描述符
+     */
+    void readLoop(int fd);
+    
+    /**
+     * @brief 解析缓冲区中的完整记录
+     * @param data 缓冲区起始位置
+     * @param size 有效字节数
+     * @param skip 二进制格式下仍需丢弃的字节数；CSV格式下非0表示丢弃到下一个换行
+     * @return 已消费的字节数
+     */
+    size_t parseRecords(char* data, size_t size, size_t& skip);
+    
+    /**
+     * @brief 等待空闲槽位
+     * @return 槽位起始位置，stop()后返回nullptr
+     */
+    double* acquireSlot();
+    
+    /**
+     * @brief 提交已写入的槽位
+     */
+    void commitSlot();
+    
+    /**
+     * @brief 发布一次快照
+     */
+    void publishSnapshot();
+};
+
+} // namespace neural_network
+
+#endif // STREAM_TRAINER_H
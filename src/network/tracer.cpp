@@ -0,0 +1,185 @@
+#include "tracer.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unistd.h>
+
+namespace neural_network {
+
+/**
+ * @brief 单个线程的环形事件缓冲区（只由所属线程写入）
+ */
+struct Tracer::ThreadBuffer {
+    std::vector<TraceEvent> events;      ///< 固定容量的事件槽
+    std::atomic<uint64_t> written{0};    ///< 累计写入的事件数
+    uint32_t thread_id = 0;              ///< 线程编号
+};
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const Clock::time_point kEpoch = Clock::now();
+
+std::atomic<uint32_t> next_thread_id{1};
+
+/**
+ * @brief 当前线程的编号（第一次调用时分配）
+ */
+uint32_t currentThreadId() {
+    thread_local const uint32_t id = next_thread_id.fetch_add(1);
+    return id;
+}
+
+/**
+ * @brief 转义JSON字符串
+ */
+std::string escapeJson(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            escaped += ' ';
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+} // namespace
+
+Tracer::Tracer() : enabled_(false), generation_(0), events_per_thread_(kDefaultEventsPerThread) {}
+
+Tracer& Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+void Tracer::enable(size_t eventsPerThread) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        events_per_thread_ = std::max<size_t>(1, eventsPerThread);
+        buffers_.clear();
+        generation_.fetch_add(1, std::memory_order_release);
+    }
+    enabled_.store(true, std::memory_order_release);
+}
+
+void Tracer::disable() {
+    enabled_.store(false, std::memory_order_release);
+}
+
+void Tracer::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffers_.clear();
+    generation_.fetch_add(1, std::memory_order_release);
+}
+
+Tracer::ThreadBuffer& Tracer::threadBuffer() {
+    // 线程持有自己的缓冲区；enable/clear后代数变化时重新注册
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    thread_local uint64_t buffer_generation = 0;
+    
+    const uint64_t generation = generation_.load(std::memory_order_acquire);
+    if (!buffer || buffer_generation != generation) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        buffer = std::make_shared<ThreadBuffer>();
+        buffer->events.resize(events_per_thread_);
+        buffer->thread_id = currentThreadId();
+        buffers_.push_back(buffer);
+        buffer_generation = generation_.load(std::memory_order_relaxed);
+    }
+    return *buffer;
+}
+
+void Tracer::record(const TraceEvent& event) {
+    ThreadBuffer& buffer = threadBuffer();
+    const uint64_t index = buffer.written.load(std::memory_order_relaxed);
+    buffer.events[index % buffer.events.size()] = event;
+    buffer.written.store(index + 1, std::memory_order_release);
+}
+
+void Tracer::setThreadName(const std::string& name) {
+    const uint32_t id = currentThreadId();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (thread_names_.size() <= id) {
+        thread_names_.resize(id + 1);
+    }
+    thread_names_[id] = name;
+}
+
+uint64_t Tracer::now() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - kEpoch).count();
+}
+
+size_t Tracer::getEventCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = 0;
+    for (const auto& buffer : buffers_) {
+        count += std::min<uint64_t>(buffer->written.load(std::memory_order_acquire), buffer->events.size());
+    }
+    return count;
+}
+
+size_t Tracer::getDroppedCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t dropped = 0;
+    for (const auto& buffer : buffers_) {
+        const uint64_t written = buffer->written.load(std::memory_order_acquire);
+        dropped += written > buffer->events.size() ? written - buffer->events.size() : 0;
+    }
+    return dropped;
+}
+
+std::string Tracer::toChromeTrace() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const long pid = static_cast<long>(getpid());
+    
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(3);
+    json << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for (size_t id = 0; id < thread_names_.size(); id++) {
+        if (thread_names_[id].empty()) {
+            continue;
+        }
+        json << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+             << ",\"tid\":" << id << ",\"args\":{\"name\":\"" << escapeJson(thread_names_[id]) << "\"}}";
+        first = false;
+    }
+    
+    // 完整事件（ph为X），时间单位为微秒
+    for (const auto& buffer : buffers_) {
+        const uint64_t written = buffer->written.load(std::memory_order_acquire);
+        const uint64_t capacity = buffer->events.size();
+        for (uint64_t i = written > capacity ? written - capacity : 0; i < written; i++) {
+            const TraceEvent& event = buffer->events[i % capacity];
+            json << (first ? "" : ",") << "\n{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category
+                 << "\",\"ph\":\"X\",\"ts\":" << event.start_ns / 1000.0 << ",\"dur\":" << event.duration_ns / 1000.0
+                 << ",\"pid\":" << pid << ",\"tid\":" << buffer->thread_id;
+            if (event.arg_name) {
+                json << ",\"args\":{\"" << event.arg_name << "\":" << event.arg_value << "}";
+            }
+            json << "}";
+            first = false;
+        }
+    }
+    json << "\n]}\n";
+    return json.str();
+}
+
+bool Tracer::writeChromeTrace(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    file << toChromeTrace();
+    return static_cast<bool>(file);
+}
+
+} // namespace neural_network
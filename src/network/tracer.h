@@ -0,0 +1,189 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace neural_network {
+
+/**
+ * @brief 一条带时长的跟踪事件
+ */
+struct TraceEvent {
+    const char* category = "";     ///< 分类（字符串字面量）
+    const char* name = "";         ///< 事件名（字符串字面量）
+    uint64_t start_ns = 0;         ///< 开始时间（相对跟踪器创建时刻，纳秒）
+    uint64_t duration_ns = 0;      ///< 持续时间（纳秒）
+    const char* arg_name = nullptr;///< 附加参数名，nullptr表示无参数
+    int64_t arg_value = 0;         ///< 附加参数值
+};
+
+/**
+ * @brief 训练与推理时间线跟踪器（全局单例）
+ *
+ * 每个线程第一次记录事件时注册一个固定容量的环形缓冲区，之后只由该线程写入，
+ * 记录事件不加锁也不分配内存；缓冲区写满后覆盖最旧的事件。关闭时每个跟踪点
+ * 只有一次原子读取的开销。
+ *
+ * 导出为Chrome/Perfetto可读取的trace JSON（chrome://tracing 或 ui.perfetto.dev）。
+ * 导出和clear()应在被跟踪的计算停止后调用，否则正在写入的事件可能不完整。
+ */
+class Tracer {
+public:
+    static constexpr size_t kDefaultEventsPerThread = 65536;  ///< 默认每线程缓冲区容量
+    
+    /**
+     * @brief 获取全局跟踪器
+     * @return 跟踪器
+     */
+    static Tracer& instance();
+    
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+    
+    /**
+     * @brief 开始记录，并丢弃之前记录的事件
+     * @param eventsPerThread 每个线程的环形缓冲区容量
+     */
+    void enable(size_t eventsPerThread = kDefaultEventsPerThread);
+    
+    /**
+     * @brief 停止记录（已记录的事件保留到下次enable或clear）
+     */
+    void disable();
+    
+    /**
+     * @brief 是否正在记录
+     * @return 是否启用
+     */
+    bool isEnabled() const {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+    
+    /**
+     * @brief 丢弃所有已记录的事件
+     */
+    void clear();
+    
+    /**
+     * @brief 记录一条事件（通常通过TraceScope调用）
+     * @param event 事件
+     */
+    void record(const TraceEvent& event);
+    
+    /**
+     * @brief 设置当前线程在时间线中显示的名称
+     * @param name 线程名
+     */
+    void setThreadName(const std::string& name);
+    
+    /**
+     * @brief 当前时间（相对跟踪器创建时刻，纳秒）
+     * @return 纳秒数
+     */
+    uint64_t now() const;
+    
+    /**
+     * @brief 获取缓冲区中保留的事件数
+     * @return 事件数
+     */
+    size_t getEventCount() const;
+    
+    /**
+     * @brief 获取因缓冲区写满被覆盖的事件数
+     * @return 事件数
+     */
+    size_t getDroppedCount() const;
+    
+    /**
+     * @brief 生成Chrome trace JSON
+     * @return JSON字符串
+     */
+    std::string toChromeTrace() const;
+    
+    /**
+     * @brief 将Chrome trace JSON写入文件
+     * @param filename 文件路径
+     * @return 是否写入成功
+     */
+    bool writeChromeTrace(const std::string& filename) const;
+
+private:
+    struct ThreadBuffer;
+    
+    std::atomic<bool> enabled_;                          ///< 是否正在记录
+    std::atomic<uint64_t> generation_;                   ///< 缓冲区代数，enable/clear时加1
+    size_t events_per_thread_;                           ///< 每线程缓冲区容量
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_; ///< 当前代数的所有线程缓冲区
+    std::vector<std::string> thread_names_;              ///< 按线程编号索引的线程名
+    mutable std::mutex mutex_;                           ///< 保护buffers_、thread_names_和容量
+    
+    Tracer();
+    
+    /**
+     * @brief 获取当前线程在当前代数下的缓冲区，必要时注册新的缓冲区
+     * @return 缓冲区
+     */
+    ThreadBuffer& threadBuffer();
+};
+
+/**
+ * @brief 作用域跟踪：构造时记录开始时间，析构时记录一条持续事件
+ *
+ * 跟踪器关闭时构造和析构各只有一次原子读取。
+ */
+class TraceScope {
+public:
+    /**
+     * @brief 构造函数
+     * @param category 分类（字符串字面量）
+     * @param name 事件名（字符串字面量）
+     * @param argName 附加参数名（字符串字面量），nullptr表示无参数
+     * @param argValue 附加参数值
+     */
+    TraceScope(const char* category, const char* name, const char* argName = nullptr, int64_t argValue = 0) {
+        if (Tracer::instance().isEnabled()) {
+            active_ = true;
+            event_.category = category;
+            event_.name = name;
+            event_.arg_name = argName;
+            event_.arg_value = argValue;
+            event_.start_ns = Tracer::instance().now();
+        }
+    }
+    
+    ~TraceScope() {
+        if (active_) {
+            event_.duration_ns = Tracer::instance().now() - event_.start_ns;
+            Tracer::instance().record(event_);
+        }
+    }
+    
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    bool active_ = false;   ///< 构造时跟踪器是否启用
+    TraceEvent event_;      ///< 正在记录的事件
+};
+
+#define NN_TRACE_CONCAT_INNER(a, b) a##b
+#define NN_TRACE_CONCAT(a, b) NN_TRACE_CONCAT_INNER(a, b)
+
+/// 在当前作用域记录一条事件
+#define NN_TRACE_SCOPE(category, name) \
+    ::neural_network::TraceScope NN_TRACE_CONCAT(nn_trace_scope_, __LINE__)(category, name)
+
+/// 在当前作用域记录一条带一个整数参数的事件
+#define NN_TRACE_SCOPE_ARG(category, name, argName, argValue) \
+    ::neural_network::TraceScope NN_TRACE_CONCAT(nn_trace_scope_, __LINE__)( \
+        category, name, argName, static_cast<int64_t>(argValue))
+
+} // namespace neural_network
+
+#endif // TRACER_H
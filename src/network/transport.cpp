@@ -0,0 +1,261 @@
+#include "transport.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <functional>
+#include <cstring>
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+namespace neural_network {
+
+namespace {
+
+/**
+ * @brief 在超时时间内接受一个连接
+ */
+int acceptWithTimeout(int listenFd, int timeoutMs) {
+    pollfd pfd = {listenFd, POLLIN, 0};
+    int rc;
+    do {
+        rc = poll(&pfd, 1, timeoutMs);
+    } while (rc < 0 && errno == EINTR);
+    if (rc <= 0) {
+        return -1;
+    }
+    return accept(listenFd, nullptr, nullptr);
+}
+
+/**
+ * @brief 加入环：监听套接字已就绪，先连接下一个rank再接受上一个rank
+ * 
+ * 所有rank都先监听再连接，连接可以在对方accept之前完成，因此不会互相等待。
+ * @param connectNext 尝试连接下一个rank，失败返回-1（在超时前重试）
+ */
+std::unique_ptr<SocketTransport> joinRing(size_t rank, size_t worldSize, int timeoutMs, int listenFd,
+                                          const std::function<int()>& connectNext) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    int next_fd = -1;
+    while ((next_fd = connectNext()) < 0) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            close(listenFd);
+            return nullptr;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    
+    int remaining = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now()).count());
+    int prev_fd = acceptWithTimeout(listenFd, std::max(remaining, 0));
+    close(listenFd);
+    if (prev_fd < 0) {
+        close(next_fd);
+        return nullptr;
+    }
+    return std::unique_ptr<SocketTransport>(new SocketTransport(rank, worldSize, next_fd, prev_fd));
+}
+
+} // namespace
+
+SocketTransport::SocketTransport(size_t rank, size_t worldSize, int nextFd, int prevFd, int timeoutMs)
+    : rank_(rank), world_size_(worldSize), next_fd_(nextFd), prev_fd_(prevFd), timeout_ms_(timeoutMs) {}
+
+SocketTransport::~SocketTransport() {
+    if (next_fd_ >= 0) {
+        close(next_fd_);
+    }
+    if (prev_fd_ >= 0 && prev_fd_ != next_fd_) {
+        close(prev_fd_);
+    }
+}
+
+std::vector<std::unique_ptr<SocketTransport>> SocketTransport::createLocalRing(size_t worldSize) {
+    std::vector<std::unique_ptr<SocketTransport>> ring;
+    if (worldSize == 1) {
+        ring.emplace_back(new SocketTransport(0, 1, -1, -1));
+        return ring;
+    }
+    
+    // 第i对套接字连接rank i（发送端）和rank i+1（接收端）
+    std::vector<int> send_fds(worldSize, -1);
+    std::vector<int> recv_fds(worldSize, -1);
+    for (size_t i = 0; i < worldSize; i++) {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            for (size_t j = 0; j < i; j++) {
+                close(send_fds[j]);
+                close(recv_fds[(j + 1) % worldSize]);
+            }
+            return {};
+        }
+        send_fds[i] = fds[0];
+        recv_fds[(i + 1) % worldSize] = fds[1];
+    }
+    
+    for (size_t r = 0; r < worldSize; r++) {
+        ring.emplace_back(new SocketTransport(r, worldSize, send_fds[r], recv_fds[r]));
+    }
+    return ring;
+}
+
+std::unique_ptr<SocketTransport> SocketTransport::connectUnixRing(const std::string& pathPrefix, size_t rank,
+                                                                  size_t worldSize, int timeoutMs) {
+    if (worldSize == 1) {
+        return std::unique_ptr<SocketTransport>(new SocketTransport(0, 1, -1, -1));
+    }
+    
+    auto make_address = [&pathPrefix](size_t r, sockaddr_un& addr) {
+        std::string path = pathPrefix + "." + std::to_string(r);
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)) {
+            return false;
+        }
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+        return true;
+    };
+    
+    sockaddr_un own;
+    sockaddr_un next;
+    if (rank >= worldSize || !make_address(rank, own) || !make_address((rank + 1) % worldSize, next)) {
+        return nullptr;
+    }
+    
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        return nullptr;
+    }
+    unlink(own.sun_path);
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&own), sizeof(own)) != 0 || listen(listen_fd, 1) != 0) {
+        close(listen_fd);
+        return nullptr;
+    }
+    
+    auto transport = joinRing(rank, worldSize, timeoutMs, listen_fd, [&next]() {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&next), sizeof(next)) != 0) {
+            close(fd);
+            fd = -1;
+        }
+        return fd;
+    });
+    unlink(own.sun_path);
+    return transport;
+}
+
+std::unique_ptr<SocketTransport> SocketTransport::connectTcpRing(const std::string& host, uint16_t basePort,
+                                                                 size_t rank, size_t worldSize, int timeoutMs) {
+    if (worldSize == 1) {
+        return std::unique_ptr<SocketTransport>(new SocketTransport(0, 1, -1, -1));
+    }
+    
+    sockaddr_in own;
+    std::memset(&own, 0, sizeof(own));
+    own.sin_family = AF_INET;
+    if (rank >= worldSize || inet_pton(AF_INET, host.c_str(), &own.sin_addr) != 1) {
+        return nullptr;
+    }
+    sockaddr_in next = own;
+    own.sin_port = htons(static_cast<uint16_t>(basePort + rank));
+    next.sin_port = htons(static_cast<uint16_t>(basePort + (rank + 1) % worldSize));
+    
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        return nullptr;
+    }
+    int one = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&own), sizeof(own)) != 0 || listen(listen_fd, 1) != 0) {
+        close(listen_fd);
+        return nullptr;
+    }
+    
+    auto transport = joinRing(rank, worldSize, timeoutMs, listen_fd, [&next]() {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&next), sizeof(next)) != 0) {
+            close(fd);
+            fd = -1;
+        }
+        if (fd >= 0) {
+            // 梯度分块较小，关闭Nagle算法以免每步增加延迟
+            int flag = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+        }
+        return fd;
+    });
+    return transport;
+}
+
+size_t SocketTransport::getRank() const {
+    return rank_;
+}
+
+size_t SocketTransport::getWorldSize() const {
+    return world_size_;
+}
+
+bool SocketTransport::ringExchange(const void* sendData, size_t sendBytes, void* recvData, size_t recvBytes) {
+    if (world_size_ == 1) {
+        std::memcpy(recvData, sendData, std::min(sendBytes, recvBytes));
+        return sendBytes == recvBytes;
+    }
+    
+    const char* send_ptr = static_cast<const char*>(sendData);
+    char* recv_ptr = static_cast<char*>(recvData);
+    size_t sent = 0;
+    size_t received = 0;
+    
+    // 收发交替进行：若先阻塞发送完再接收，所有rank同时发送大块数据时会填满缓冲区而死锁
+    while (sent < sendBytes || received < recvBytes) {
+        pollfd fds[2];
+        nfds_t count = 0;
+        int send_slot = -1;
+        int recv_slot = -1;
+        if (sent < sendBytes) {
+            send_slot = static_cast<int>(count);
+            fds[count++] = {next_fd_, POLLOUT, 0};
+        }
+        if (received < recvBytes) {
+            recv_slot = static_cast<int>(count);
+            fds[count++] = {prev_fd_, POLLIN, 0};
+        }
+        
+        int rc = poll(fds, count, timeout_ms_);
+        if (rc < 0 && errno == EINTR) {
+            continue;
+        }
+        if (rc <= 0) {
+            return false;
+        }
+        
+        if (send_slot >= 0 && fds[send_slot].revents != 0) {
+            if (fds[send_slot].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+                return false;
+            }
+            ssize_t n = send(next_fd_, send_ptr + sent, sendBytes - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                return false;
+            }
+            sent += n > 0 ? static_cast<size_t>(n) : 0;
+        }
+        if (recv_slot >= 0 && fds[recv_slot].revents != 0) {
+            if (fds[recv_slot].revents & POLLNVAL) {
+                return false;
+            }
+            ssize_t n = recv(prev_fd_, recv_ptr + received, recvBytes - received, MSG_DONTWAIT);
+            if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                return false;
+            }
+            received += n > 0 ? static_cast<size_t>(n) : 0;
+        }
+    }
+    return true;
+}
+
+} // namespace neural_network
@@ -0,0 +1,113 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace neural_network {
+
+/**
+ * @brief 环形拓扑上的进程间通信接口
+ * 
+ * 各进程按rank排成环，每个进程只与下一个rank（发送）和上一个rank（接收）通信，
+ * 这足以实现环形allreduce。新的传输方式只需实现该接口。
+ */
+class Transport {
+public:
+    virtual ~Transport() = default;
+    
+    /**
+     * @brief 获取本进程的rank
+     * @return rank，从0开始
+     */
+    virtual size_t getRank() const = 0;
+    
+    /**
+     * @brief 获取进程总数
+     * @return 进程总数
+     */
+    virtual size_t getWorldSize() const = 0;
+    
+    /**
+     * @brief 同时向下一个rank发送并从上一个rank接收（不会因双方同时发送而死锁）
+     * @param sendData 发送数据
+     * @param sendBytes 发送字节数
+     * @param recvData 接收缓冲区
+     * @param recvBytes 接收字节数
+     * @return 连接断开或超时时返回false
+     */
+    virtual bool ringExchange(const void* sendData, size_t sendBytes, void* recvData, size_t recvBytes) = 0;
+};
+
+/**
+ * @brief 基于流式套接字的环形传输（Unix域套接字或TCP）
+ * 
+ * 同一主机上可通过socketpair在fork前建立，也可由相互独立的进程按路径前缀或
+ * 端口连接：rank r监听自己的地址，连接rank r+1，并接受rank r-1的连接。
+ */
+class SocketTransport : public Transport {
+public:
+    /**
+     * @brief 构造函数，接管两个已连接套接字的所有权
+     * @param rank 本进程rank
+     * @param worldSize 进程总数
+     * @param nextFd 连接下一个rank的套接字（只用于发送）
+     * @param prevFd 连接上一个rank的套接字（只用于接收）
+     * @param timeoutMs 单次交换的超时时间（毫秒）
+     */
+    SocketTransport(size_t rank, size_t worldSize, int nextFd, int prevFd, int timeoutMs = 30000);
+    ~SocketTransport() override;
+    
+    SocketTransport(const SocketTransport&) = delete;
+    SocketTransport& operator=(const SocketTransport&) = delete;
+    
+    /**
+     * @brief 在fork之前为同一主机上的进程组创建环形连接
+     * 
+     * fork后每个进程保留自己rank对应的对象，释放其余对象即可。
+     * @param worldSize 进程总数
+     * @return 每个rank的传输对象，失败时为空
+     */
+    static std::vector<std::unique_ptr<SocketTransport>> createLocalRing(size_t worldSize);
+    
+    /**
+     * @brief 通过Unix域套接字加入环（地址为"前缀.rank"）
+     * @param pathPrefix 套接字路径前缀
+     * @param rank 本进程rank
+     * @param worldSize 进程总数
+     * @param timeoutMs 建立连接的超时时间（毫秒）
+     * @return 传输对象，失败时返回nullptr
+     */
+    static std::unique_ptr<SocketTransport> connectUnixRing(const std::string& pathPrefix, size_t rank,
+                                                            size_t worldSize, int timeoutMs = 10000);
+    
+    /**
+     * @brief 通过TCP加入环（rank r监听basePort + r）
+     * @param host 所有rank所在主机的IPv4地址（如"127.0.0.1"）
+     * @param basePort 起始端口
+     * @param rank 本进程rank
+     * @param worldSize 进程总数
+     * @param timeoutMs 建立连接的超时时间（毫秒）
+     * @return 传输对象，失败时返回nullptr
+     */
+    static std::unique_ptr<SocketTransport> connectTcpRing(const std::string& host, uint16_t basePort,
+                                                           size_t rank, size_t worldSize, int timeoutMs = 10000);
+    
+    size_t getRank() const override;
+    size_t getWorldSize() const override;
+    bool ringExchange(const void* sendData, size_t sendBytes, void* recvData, size_t recvBytes) override;
+
+private:
+    size_t rank_;       ///< 本进程rank
+    size_t world_size_; ///< 进程总数
+    int next_fd_;       ///< 发往下一个rank
+    int prev_fd_;       ///< 来自上一个rank
+    int timeout_ms_;    ///< 交换超时
+};
+
+} // namespace neural_network
+
+#endif // TRANSPORT_H
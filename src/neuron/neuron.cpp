@@ -1,23 +1,66 @@
 #include "neuron.h"
+#include "philox.h"
 #include <random>
 #include <cmath>
 #include <numeric>
 #include <algorithm>
 
 namespace neural_network {
+
+std::atomic<uint64_t>& Neuron::globalSeed() {
+    // 首次使用时从random_device取一次种子
+    static std::atomic<uint64_t> seed{(static_cast<uint64_t>(std::random_device{}()) << 32) ^ std::random_device{}()};
+    return seed;
+}
+
+std::atomic<uint64_t>& Neuron::nextStream() {
+    static std::atomic<uint64_t> stream{0};
+    return stream;
+}
+
+bool& Neuron::skipStreams() {
+    thread_local bool skip = false;
+    return skip;
+}
+
+Neuron::NoStreamScope::NoStreamScope() : previous_(skipStreams()) {
+    skipStreams() = true;
+}
+
+Neuron::NoStreamScope::~NoStreamScope() {
+    skipStreams() = previous_;
+}
+
+void Neuron::setGlobalSeed(uint64_t seed) {
+    globalSeed().store(seed);
+    nextStream().store(0);
+}
+
+uint64_t Neuron::deriveInitSeed() {
+    if (skipStreams()) {
+        return 0;
+    }
+    Philox4x32 generator(globalSeed().load());
+    Philox4x32::Counter block = generator.generate(nextStream().fetch_add(1), 0);
+    return (static_cast<uint64_t>(block[0]) << 32) | block[1];
+}
+
+uint64_t Neuron::getNextStream() {
+    return nextStream().load();
+}
     
 Neuron::Neuron(size_t numInputs) 
     : weights_(numInputs), bias_(0.0), activation_type_(ActivationType::SIGMOID), weight_gradients_(numInputs),
       bias_gradient_(0.0), output_(0.0) {
-    // 初始化权重和偏置为小的随机数
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<double> dis(-0.5, 0.5);
-    
-    for (size_t i = 0; i < numInputs; i++) {
-        weights_[i] = dis(gen);
+    // 初始化权重和偏置为小的随机数：每个神经元使用独立的Philox流，
+    // 避免为每个神经元创建random_device和mt19937
+    if (!skipStreams()) {
+        std::vector<double> values(numInputs + 1);
+        philoxFillUniform(globalSeed().load(), nextStream().fetch_add(1), values.data(), values.size(), -0.5, 0.5);
+        
+        std::copy(values.begin(), values.begin() + numInputs, weights_.begin());
+        bias_ = values[numInputs];
     }
-    bias_ = dis(gen);
     
     // 初始化默认激活函数
     initializeActivationFunction(activation_type_);
@@ -28,11 +71,23 @@ double Neuron::forward(const std::vector<double>& inputs) {
     double sum = std::inner_product(inputs.begin(), inputs.end(), weights_.begin(), 0.0) + bias_;
     
     // 应用激活函数
-    output_ = activation_function_(sum);
-    
+    return activate(sum);
+}
+
+double Neuron::activate(double sum) {
+    output_ = applyActivation(sum);
     return output_;
 }
 
+double Neuron::predict(const std::vector<double>& inputs) const {
+    double sum = std::inner_product(inputs.begin(), inputs.end(), weights_.begin(), 0.0) + bias_;
+    return applyActivation(sum);
+}
+
+double Neuron::applyActivation(double sum) const {
+    return activation_function_(sum);
+}
+
 void Neuron::setActivationFunction(ActivationType type) {
     activation_type_ = type;
     initializeActivationFunction(type);
@@ -43,6 +98,10 @@ void Neuron::setActivationFunction(std::function<double(double)> activation_func
     activation_type_ = ActivationType::SIGMOID; // 默认设置
 }
 
+ActivationType Neuron::getActivationType() const {
+    return activation_type_;
+}
+
 void Neuron::initializeActivationFunction(ActivationType type) {
     switch (type) {
         case ActivationType::TANH:
@@ -57,6 +116,12 @@ void Neuron::initializeActivationFunction(ActivationType type) {
             };
             break;
             
+        case ActivationType::LINEAR:
+            activation_function_ = [](double x) -> double {
+                return x;
+            };
+            break;
+            
         case ActivationType::SIGMOID:
         default:
             activation_function_ = [](double x) -> double {
@@ -119,6 +184,9 @@ double Neuron::computeActivationDerivative(double output) const {
         case ActivationType::RELU:
             return output > 0 ? 1.0 : 0.0;
             
+        case ActivationType::LINEAR:
+            return 1.0;
+            
         case ActivationType::SIGMOID:
         default:
             return output * (1.0 - output);
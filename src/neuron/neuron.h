@@ -4,6 +4,8 @@
 #include <vector>
 #include <memory>
 #include <functional>
+#include <atomic>
+#include <cstdint>
 
 namespace neural_network {
     
@@ -13,7 +15,8 @@ namespace neural_network {
 enum class ActivationType {
     SIGMOID,
     TANH,
-    RELU
+    RELU,
+    LINEAR
 };
 
 /**
@@ -41,6 +44,27 @@ public:
      */
     double forward(const std::vector<double>& inputs);
     
+    /**
+     * @brief 对已算好的加权输入和应用激活函数并记录输出
+     * @param sum 加权输入和（含偏置）
+     * @return 输出值
+     */
+    double activate(double sum);
+    
+    /**
+     * @brief 只读前向计算，不记录输出（可在多线程中并发调用）
+     * @param inputs 输入值向量
+     * @return 输出值
+     */
+    double predict(const std::vector<double>& inputs) const;
+    
+    /**
+     * @brief 对加权输入和应用激活函数，不记录输出
+     * @param sum 加权输入和（含偏置）
+     * @return 输出值
+     */
+    double applyActivation(double sum) const;
+    
     /**
      * @brief 设置激活函数类型
      * @param type 激活函数类型
@@ -53,6 +77,12 @@ public:
      */
     void setActivationFunction(std::function<double(double)> activation_func);
     
+    /**
+     * @brief 获取激活函数类型
+     * @return 激活函数类型
+     */
+    ActivationType getActivationType() const;
+    
     /**
      * @brief 获取权重
      * @return 权重向量
@@ -114,6 +144,46 @@ public:
      * @return 导数值
      */
     double computeActivationDerivative(double output) const;
+    
+    /**
+     * @brief 设置神经元默认初始化使用的全局种子
+     * 
+     * 之后按相同顺序构造的神经元得到相同的初始权重。
+     * 未设置时首次构造神经元会从random_device取一次种子。
+     * @param seed 种子
+     */
+    static void setGlobalSeed(uint64_t seed);
+    
+    /**
+     * @brief 从全局种子派生一个初始化种子（供不由神经元组成的层使用）
+     * 
+     * 与神经元共用流编号，因此设置全局种子后按相同顺序构造的各类层都得到相同的初始权重。
+     * @return 种子
+     */
+    static uint64_t deriveInitSeed();
+    
+    /**
+     * @brief 获取下一个神经元使用的随机数流编号
+     * @return 流编号
+     */
+    static uint64_t getNextStream();
+    
+    /**
+     * @brief 作用域内当前线程构造的神经元和层不消耗随机数流
+     * 
+     * 用于权重随后会被覆盖的构造（复制网络、按层描述重建）：神经元权重初始化为0，
+     * deriveInitSeed返回0。只影响当前线程，其他线程同时构造的神经元照常依次取得流编号。
+     */
+    class NoStreamScope {
+    public:
+        NoStreamScope();
+        ~NoStreamScope();
+        NoStreamScope(const NoStreamScope&) = delete;
+        NoStreamScope& operator=(const NoStreamScope&) = delete;
+        
+    private:
+        bool previous_;    ///< 进入作用域前的状态（允许嵌套）
+    };
 
 protected:
     std::vector<double> weights_;              ///< 连接权重
@@ -131,6 +201,22 @@ protected:
      * @param type 激活函数类型
      */
     void initializeActivationFunction(ActivationType type);
+
+private:
+    /**
+     * @brief 全局初始化种子
+     */
+    static std::atomic<uint64_t>& globalSeed();
+    
+    /**
+     * @brief 下一个神经元使用的随机数流编号
+     */
+    static std::atomic<uint64_t>& nextStream();
+    
+    /**
+     * @brief 当前线程是否处于NoStreamScope内
+     */
+    static bool& skipStreams();
 };
 
 } // namespace neural_network
@@ -0,0 +1,98 @@
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace neural_network {
+
+/**
+ * @brief Philox4x32-10计数器随机数生成器
+ * 
+ * 输出只由（密钥，计数器）决定，没有内部状态，因此任意位置的随机数
+ * 都可以独立计算：不同线程按计数器区间并行填充，结果与串行完全一致。
+ */
+class Philox4x32 {
+public:
+    using Counter = std::array<uint32_t, 4>;
+    
+    /**
+     * @brief 构造函数
+     * @param seed 64位种子（作为密钥）
+     */
+    explicit Philox4x32(uint64_t seed)
+        : key0_(static_cast<uint32_t>(seed)), key1_(static_cast<uint32_t>(seed >> 32)) {}
+    
+    /**
+     * @brief 计算指定计数器对应的4个32位随机数
+     * @param stream 流编号（计数器高64位）
+     * @param index 块编号（计数器低64位）
+     * @return 4个32位随机数
+     */
+    Counter generate(uint64_t stream, uint64_t index) const {
+        Counter counter = {static_cast<uint32_t>(index), static_cast<uint32_t>(index >> 32),
+                           static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32)};
+        uint32_t k0 = key0_;
+        uint32_t k1 = key1_;
+        for (int round = 0; round < 10; round++) {
+            uint64_t product0 = static_cast<uint64_t>(kMultiplier0) * counter[0];
+            uint64_t product1 = static_cast<uint64_t>(kMultiplier1) * counter[2];
+            counter = {static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ k0,
+                       static_cast<uint32_t>(product1),
+                       static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ k1,
+                       static_cast<uint32_t>(product0)};
+            k0 += kWeyl0;
+            k1 += kWeyl1;
+        }
+        return counter;
+    }
+    
+    /**
+     * @brief 将两个32位随机数组合为[0, 1)区间内53位精度的double
+     * @param high 高位随机数
+     * @param low 低位随机数
+     * @return [0, 1)内的均匀随机数
+     */
+    static double toUnitDouble(uint32_t high, uint32_t low) {
+        return ((high >> 5) * 67108864.0 + (low >> 6)) * (1.0 / 9007199254740992.0);
+    }
+
+private:
+    static constexpr uint32_t kMultiplier0 = 0xD2511F53u;
+    static constexpr uint32_t kMultiplier1 = 0xCD9E8D57u;
+    static constexpr uint32_t kWeyl0 = 0x9E3779B9u;
+    static constexpr uint32_t kWeyl1 = 0xBB67AE85u;
+    
+    uint32_t key0_;  ///< 密钥低32位
+    uint32_t key1_;  ///< 密钥高32位
+};
+
+/**
+ * @brief 用Philox在[low, high)内填充均匀随机数
+ * 
+ * 第i个值只取决于（seed, stream, i），与填充顺序和线程划分无关。
+ * @param seed 种子
+ * @param stream 流编号（例如神经元编号）
+ * @param out 输出缓冲区
+ * @param count 数量
+ * @param low 下界
+ * @param high 上界
+ */
+inline void philoxFillUniform(uint64_t seed, uint64_t stream, double* out, size_t count,
+                              double low, double high) {
+    Philox4x32 generator(seed);
+    const double range = high - low;
+    for (size_t i = 0; i < count; i += 2) {
+        // 每个块产生4个32位数，即2个double
+        Philox4x32::Counter block = generator.generate(stream, i / 2);
+        out[i] = low + range * Philox4x32::toUnitDouble(block[0], block[1]);
+        if (i + 1 < count) {
+            out[i + 1] = low + range * Philox4x32::toUnitDouble(block[2], block[3]);
+        }
+    }
+}
+
+} // namespace neural_network
+
+#endif // PHILOX_H
@@ -0,0 +1,96 @@
+#include "../src/network/network.h"
+#include "../src/network/layer.h"
+#include "../src/network/conv_layer.h"
+#include "../src/network/code_generator.h"
+#include "codegen_model.h"
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <cstring>
+#include <chrono>
+
+int main() {
+    std::cout << "测试模型代码生成..." << std::endl;
+    
+    // 生成的头文件由构建时的nn_codegen从同一个模型文件得到
+    neural_network::Network network;
+    if (!network.loadModel(CODEGEN_MODEL_FILE)) {
+        std::cout << "⚠ 无法加载模型: " << CODEGEN_MODEL_FILE << std::endl;
+        return 1;
+    }
+    
+    // 测试1: 输入输出尺寸
+    if (codegen_model::kInputSize == network.getLayer(0)->inputSize() &&
+        codegen_model::kOutputSize == network.getLayer(network.getLayerCount() - 1)->size()) {
+        std::cout << "✓ 生成代码的输入输出尺寸正确: " << codegen_model::kInputSize << " -> "
+                  << codegen_model::kOutputSize << std::endl;
+    } else {
+        std::cout << "⚠ 生成代码的输入输出尺寸不正确" << std::endl;
+    }
+    
+    // 测试2: 与Network::forward逐位一致
+    std::vector<std::vector<double>> inputs;
+    for (int i = 0; i < 2000; i++) {
+        std::vector<double> x(codegen_model::kInputSize);
+        for (size_t k = 0; k < x.size(); k++) {
+            x[k] = std::sin(0.731 * i + 1.37 * k) * (1 + i % 7) + (i % 11 == 0 ? 0.0 : 0.01 * k);
+        }
+        inputs.push_back(x);
+    }
+    inputs.push_back(std::vector<double>(codegen_model::kInputSize, 0.0));
+    inputs.push_back(std::vector<double>(codegen_model::kInputSize, -1e6));
+    
+    size_t mismatches = 0;
+    double output[codegen_model::kOutputSize];
+    for (const auto& x : inputs) {
+        std::vector<double> expected = network.forward(x);
+        codegen_model::predict(x.data(), output);
+        if (std::memcmp(expected.data(), output, sizeof(output)) != 0) {
+            mismatches++;
+        }
+    }
+    if (mismatches == 0) {
+        std::cout << "✓ " << inputs.size() << "个输入的生成代码输出与Network::forward逐位一致" << std::endl;
+    } else {
+        std::cout << "⚠ 生成代码有" << mismatches << "个输入的输出与Network::forward不一致" << std::endl;
+    }
+    
+    // 测试3: 推理耗时对比
+    using Clock = std::chrono::steady_clock;
+    double runtime_checksum = 0.0;
+    double generated_checksum = 0.0;
+    auto start = Clock::now();
+    for (const auto& x : inputs) {
+        runtime_checksum += network.predict(x)[0];
+    }
+    double runtime_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    start = Clock::now();
+    for (const auto& x : inputs) {
+        codegen_model::predict(x.data(), output);
+        generated_checksum += output[0];
+    }
+    double generated_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (runtime_checksum == generated_checksum) {
+        std::cout << "✓ 每次推理耗时: 运行时 " << runtime_seconds / inputs.size() * 1e9 << " ns，生成代码 "
+                  << generated_seconds / inputs.size() * 1e9 << " ns" << std::endl;
+    } else {
+        std::cout << "⚠ 推理耗时测试结果不一致" << std::endl;
+    }
+    
+    // 测试4: 不支持的网络和命名空间
+    neural_network::Network conv_net;
+    conv_net.addLayer(std::make_shared<neural_network::Conv2DLayer>(1, 4, 4, 1, 3));
+    std::ostringstream rejected;
+    if (!neural_network::generateInferenceHeader(conv_net, "conv_model", rejected) &&
+        !neural_network::generateInferenceHeader(network, "bad-name", rejected) &&
+        !neural_network::generateInferenceHeader(neural_network::Network(), "empty", rejected)) {
+        std::cout << "✓ 拒绝不支持的层类型和非法命名空间" << std::endl;
+    } else {
+        std::cout << "⚠ 未拒绝不支持的网络" << std::endl;
+    }
+    
+    std::cout << "\n所有代码生成测试完成!" << std::endl;
+    return 0;
+}
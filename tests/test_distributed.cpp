@@ -0,0 +1,173 @@
+#include "../src/network/network.h"
+#include "../src/network/layer.h"
+#include "../src/network/transport.h"
+#include "../src/network/distributed_trainer.h"
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <string>
+#include <functional>
+#include <cmath>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+// 为每个rank fork一个子进程执行worker，全部以0退出时返回true
+bool runRanks(size_t worldSize, const std::function<bool(size_t)>& worker) {
+    std::vector<pid_t> children;
+    for (size_t rank = 0; rank < worldSize; rank++) {
+        pid_t child = fork();
+        if (child == 0) {
+            _exit(worker(rank) ? 0 : 1);
+        }
+        children.push_back(child);
+    }
+    bool ok = true;
+    for (pid_t child : children) {
+        int status = 0;
+        waitpid(child, &status, 0);
+        ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    return ok;
+}
+
+std::shared_ptr<neural_network::Network> buildNetwork() {
+    auto network = std::make_shared<neural_network::Network>();
+    network->setSeed(5);
+    network->addLayer(std::make_shared<neural_network::Layer>(6, 3));
+    network->addLayer(std::make_shared<neural_network::Layer>(1, 6));
+    return network;
+}
+
+} // namespace
+
+int main() {
+    std::cout << "测试多进程数据并行训练..." << std::endl;
+    
+    // 测试1: 环形allreduce（元素数不能被进程数整除）
+    const size_t world = 3;
+    {
+        auto ring = neural_network::SocketTransport::createLocalRing(world);
+        bool ok = runRanks(world, [&ring](size_t rank) {
+            auto& transport = *ring[rank];
+            std::vector<double> data(10);
+            for (size_t i = 0; i < data.size(); i++) {
+                data[i] = rank * 100.0 + i;
+            }
+            if (!neural_network::ringAllreduce(transport, data)) {
+                return false;
+            }
+            for (size_t i = 0; i < data.size(); i++) {
+                if (data[i] != 300.0 + 3.0 * i) {
+                    return false;
+                }
+            }
+            return true;
+        });
+        std::cout << (ok ? "✓ 环形allreduce结果正确" : "⚠ 环形allreduce结果错误") << std::endl;
+    }
+    
+    // 测试2: 三个进程各持一个数据分片训练，每步后权重逐位一致
+    neural_network::Dataset dataset;
+    for (int i = 0; i < 30; i++) {
+        double a = (i % 5) / 4.0;
+        double b = (i % 3) / 2.0;
+        double c = (i % 7) / 6.0;
+        dataset.push_back({{a, b, c}, {0.5 + 0.4 * std::sin(a + b - c)}});
+    }
+    const size_t batch_size = 4;
+    const int epochs = 20;
+    const double learning_rate = 0.5;
+    
+    std::vector<int> pipes(world * 2);
+    for (size_t rank = 0; rank < world; rank++) {
+        if (pipe(&pipes[rank * 2]) != 0) {
+            std::cout << "⚠ 无法创建管道" << std::endl;
+            return 0;
+        }
+    }
+    const size_t parameter_count = buildNetwork()->getParameterCount();
+    {
+        auto ring = neural_network::SocketTransport::createLocalRing(world);
+        bool ok = runRanks(world, [&](size_t rank) {
+            auto network = buildNetwork();
+            neural_network::DistributedTrainer trainer(*network, *ring[rank]);
+            auto shard = neural_network::DistributedTrainer::shard(dataset, rank, world);
+            if (!trainer.broadcastParameters()) {
+                return false;
+            }
+            for (int epoch = 0; epoch < epochs; epoch++) {
+                if (!trainer.trainEpoch(shard, batch_size, learning_rate)) {
+                    return false;
+                }
+            }
+            auto parameters = network->getParameters();
+            size_t bytes = parameters.size() * sizeof(double);
+            return write(pipes[rank * 2 + 1], parameters.data(), bytes) == static_cast<ssize_t>(bytes);
+        });
+        
+        std::vector<std::vector<double>> results(world, std::vector<double>(parameter_count));
+        for (size_t rank = 0; rank < world && ok; rank++) {
+            size_t bytes = parameter_count * sizeof(double);
+            ok = read(pipes[rank * 2], results[rank].data(), bytes) == static_cast<ssize_t>(bytes);
+        }
+        for (int fd : pipes) {
+            close(fd);
+        }
+        bool identical = ok && results[1] == results[0] && results[2] == results[0];
+        
+        // 单进程参考：每步使用所有分片在该步的样本的平均梯度
+        auto reference = buildNetwork();
+        auto single = neural_network::SocketTransport::createLocalRing(1);
+        neural_network::DistributedTrainer reference_trainer(*reference, *single[0]);
+        std::vector<neural_network::Dataset> shards;
+        for (size_t rank = 0; rank < world; rank++) {
+            shards.push_back(neural_network::DistributedTrainer::shard(dataset, rank, world));
+        }
+        for (int epoch = 0; epoch < epochs; epoch++) {
+            for (size_t step = 0; step * batch_size < shards[0].size(); step++) {
+                neural_network::Dataset batch;
+                for (const auto& shard : shards) {
+                    size_t begin = std::min(shard.size(), step * batch_size);
+                    size_t end = std::min(shard.size(), begin + batch_size);
+                    batch.insert(batch.end(), shard.begin() + begin, shard.begin() + end);
+                }
+                reference_trainer.trainStep(batch, learning_rate);
+            }
+        }
+        double max_diff = 0.0;
+        auto expected = reference->getParameters();
+        for (size_t i = 0; ok && i < expected.size(); i++) {
+            max_diff = std::max(max_diff, std::abs(expected[i] - results[0][i]));
+        }
+        
+        if (identical && max_diff < 1e-9) {
+            std::cout << "✓ 各rank权重逐位一致，与单进程全批次训练最大差异: " << max_diff << std::endl;
+        } else {
+            std::cout << "⚠ 多进程训练结果不一致" << std::endl;
+        }
+    }
+    
+    // 测试3: 独立进程通过Unix域套接字路径组成环
+    const std::string prefix = "/tmp/nn_test_ring_" + std::to_string(getpid());
+    bool unix_ok = runRanks(2, [&prefix](size_t rank) {
+        auto transport = neural_network::SocketTransport::connectUnixRing(prefix, rank, 2);
+        std::vector<double> data(5, rank + 1.0);
+        return transport && neural_network::ringAllreduce(*transport, data) && data == std::vector<double>(5, 3.0);
+    });
+    std::cout << (unix_ok ? "✓ Unix域套接字传输正常" : "⚠ Unix域套接字传输失败") << std::endl;
+    
+    // 测试4: 本机TCP传输
+    const uint16_t base_port = static_cast<uint16_t>(20000 + getpid() % 20000);
+    bool tcp_ok = runRanks(2, [base_port](size_t rank) {
+        auto transport = neural_network::SocketTransport::connectTcpRing("127.0.0.1", base_port, rank, 2);
+        std::vector<double> data(1000, rank + 1.0);
+        return transport && neural_network::ringAllreduce(*transport, data) &&
+               data == std::vector<double>(1000, 3.0);
+    });
+    std::cout << (tcp_ok ? "✓ 本机TCP传输正常" : "⚠ 本机TCP传输失败") << std::endl;
+    
+    std::cout << "\n所有分布式训练测试完成!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include "../src/network/network.h"
+#include "../src/network/layer.h"
+#include "../src/network/model_handle.h"
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+
+namespace {
+
+// 按版本号构造确定性的模型，使每个版本的输出各不相同
+std::unique_ptr<neural_network::Network> buildModel(uint64_t seed) {
+    auto network = std::make_unique<neural_network::Network>();
+    network->setSeed(seed);
+    network->addLayer(std::make_shared<neural_network::Layer>(16, 8));
+    network->addLayer(std::make_shared<neural_network::Layer>(16, 16));
+    network->addLayer(std::make_shared<neural_network::Layer>(2, 16));
+    return network;
+}
+
+} // namespace
+
+int main() {
+    std::cout << "测试ModelHandle类功能..." << std::endl;
+    
+    const std::vector<double> inputs = {0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8};
+    const uint64_t swap_count = 2000;
+    
+    // 预先计算每个版本的期望输出（版本号v对应种子v）
+    std::vector<std::vector<double>> expected(swap_count + 2);
+    for (uint64_t v = 1; v < expected.size(); v++) {
+        expected[v] = buildModel(v)->predict(inputs);
+    }
+    
+    // 测试1: 发布初始模型
+    neural_network::ModelHandle handle;
+    if (handle.predict(inputs).empty()) {
+        std::cout << "✓ 未发布模型时返回空输出" << std::endl;
+    }
+    handle.publish(buildModel(1));
+    if (handle.predict(inputs) == expected[1] && handle.getVersion() == 1) {
+        std::cout << "✓ 成功发布初始模型" << std::endl;
+    } else {
+        std::cout << "⚠ 初始模型发布结果不正确" << std::endl;
+    }
+    
+    // 测试2: 读者持有旧版本时，替换不会释放旧模型
+    {
+        auto guard = handle.acquire();
+        handle.publish(buildModel(2));
+        if (guard.version() == 1 && guard->predict(inputs) == expected[1] && handle.getRetiredCount() == 1) {
+            std::cout << "✓ 进行中的推理在旧版本上完成" << std::endl;
+        } else {
+            std::cout << "⚠ 旧版本在读者退出前被替换或释放" << std::endl;
+        }
+    }
+    handle.reclaim();
+    if (handle.getRetiredCount() == 0) {
+        std::cout << "✓ 读者退出后旧版本被回收" << std::endl;
+    } else {
+        std::cout << "⚠ 旧版本未被回收" << std::endl;
+    }
+    
+    // 测试3: 并发替换压力测试，检查是否出现撕裂读取
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> reads(0);
+    std::atomic<uint64_t> torn(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++) {
+        readers.emplace_back([&]() {
+            while (!stop.load()) {
+                auto guard = handle.acquire();
+                if (guard->predict(inputs) != expected[guard.version()]) {
+                    torn++;
+                }
+                reads++;
+            }
+        });
+    }
+    
+    // 模型在读者之外准备，然后发布
+    for (uint64_t v = 3; v < expected.size(); v++) {
+        handle.publish(buildModel(v));
+    }
+    stop.store(true);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    handle.reclaim();
+    
+    if (torn.load() == 0 && handle.getVersion() == expected.size() - 1 && handle.getRetiredCount() == 0) {
+        std::cout << "✓ " << swap_count << " 次并发替换、" << reads.load()
+                  << " 次读取，无撕裂读取" << std::endl;
+    } else {
+        std::cout << "⚠ 检测到 " << torn.load() << " 次撕裂读取" << std::endl;
+    }
+    
+    std::cout << "\n所有模型句柄测试完成!" << std::endl;
+    return 0;
+}
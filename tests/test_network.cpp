@@ -1,10 +1,37 @@
 #include "../src/network/network.h"
 #include "../src/network/layer.h"
+#include "../src/network/conv_layer.h"
+#include "../src/network/pooling_layer.h"
+#include "../src/network/inference_model.h"
+#include "../src/network/incremental_inference.h"
+#include "../src/network/inference_cache.h"
+#include "../src/network/network_bundle.h"
+#include "../src/network/pipeline_trainer.h"
+#include "../src/network/transport.h"
+#include "../src/network/distributed_trainer.h"
+#include "../src/network/kernel_tuner.h"
+#include "../src/network/tracer.h"
+#include "../src/network/low_rank.h"
+#include "../src/network/binary_layer.h"
+#include "../src/network/activation_cache.h"
+#include "../src/network/data_parallel_trainer.h"
+#include "../src/network/stream_trainer.h"
+#include "../src/network/batch_norm_layer.h"
+#include "../src/network/model_handle.h"
 #include "../src/neuron/neuron.h"
 #include <iostream>
 #include <vector>
 #include <memory>
 #include <cmath>
+#include <cstdio>
+#include <chrono>
+#include <string>
+#include <functional>
+#include <fstream>
+#include <thread>
+#include <atomic>
+#include <unistd.h>
+#include <sys/wait.h>
 
 int main() {
     std::cout << "测试Network类功能..." << std::endl;
@@ -54,6 +81,1261 @@ int main() {
         std::cout << "⚠ 网络层获取功能可能存在问题" << std::endl;
     }
     
+    // 测试8: 激活值检查点与普通训练结果一致
+    neural_network::Network plain;
+    neural_network::Network checkpointed;
+    const size_t depth_sizes[] = {4, 6, 6, 5, 3, 1};
+    for (size_t i = 1; i < sizeof(depth_sizes) / sizeof(depth_sizes[0]); i++) {
+        auto a = std::make_shared<neural_network::Layer>(depth_sizes[i], depth_sizes[i - 1]);
+        auto b = std::make_shared<neural_network::Layer>(depth_sizes[i], depth_sizes[i - 1]);
+        for (size_t j = 0; j < a->size(); j++) {
+            b->getNeurons()[j]->setWeights(a->getNeurons()[j]->getWeights());
+            b->getNeurons()[j]->setBias(a->getNeurons()[j]->getBias());
+        }
+        plain.addLayer(a);
+        checkpointed.addLayer(b);
+    }
+    checkpointed.setCheckpointInterval(2);
+    
+    std::vector<double> deep_inputs = {0.1, 0.9, 0.4, 0.7};
+    for (int step = 0; step < 20; step++) {
+        plain.train(deep_inputs, targets, 0.5);
+        checkpointed.train(deep_inputs, targets, 0.5);
+    }
+    
+    bool checkpoint_match = plain.forward(deep_inputs) == checkpointed.forward(deep_inputs);
+    size_t plain_bytes = plain.getActivationMemoryUsage();
+    size_t checkpoint_bytes = checkpointed.getActivationMemoryUsage();
+    if (checkpoint_match && checkpoint_bytes < plain_bytes) {
+        std::cout << "✓ 激活值检查点训练结果一致，缓存内存: " << plain_bytes
+                  << " -> " << checkpoint_bytes << " 字节" << std::endl;
+    } else {
+        std::cout << "⚠ 激活值检查点功能可能存在问题" << std::endl;
+    }
+    
+    // 各层缓存为80、96、88、64、32字节：间隔2时常驻200字节，最长一段96字节
+    size_t interval = checkpointed.setActivationMemoryBudget(300);
+    plain.resetPeakActivationMemoryUsage();
+    checkpointed.resetPeakActivationMemoryUsage();
+    plain.train(deep_inputs, targets, 0.5);
+    checkpointed.train(deep_inputs, targets, 0.5);
+    size_t plain_peak = plain.getPeakActivationMemoryUsage();
+    size_t checkpoint_peak = checkpointed.getPeakActivationMemoryUsage();
+    if (interval == 2 && checkpoint_peak <= 300 && checkpoint_peak < plain_peak &&
+        plain.forward(deep_inputs) == checkpointed.forward(deep_inputs)) {
+        std::cout << "✓ 内存预算300字节选择检查点间隔" << interval << "，训练峰值: " << plain_peak
+                  << " -> " << checkpoint_peak << " 字节" << std::endl;
+    } else {
+        std::cout << "⚠ 检查点间隔" << interval << "的训练峰值" << checkpoint_peak
+                  << "字节超出内存预算" << std::endl;
+    }
+    
+    // 测试9: bfloat16混合精度训练
+    neural_network::Network mixed;
+    mixed.addLayer(std::make_shared<neural_network::Layer>(4, 2));
+    mixed.addLayer(std::make_shared<neural_network::Layer>(1, 4));
+    mixed.setMixedPrecision(true);
+    
+    const std::vector<std::vector<double>> xor_inputs = {{0, 0}, {0, 1}, {1, 0}, {1, 1}};
+    const std::vector<std::vector<double>> xor_targets = {{0}, {1}, {1}, {0}};
+    double mixed_loss_before = 0.0;
+    for (size_t i = 0; i < xor_inputs.size(); i++) {
+        mixed_loss_before += mixed.computeLoss(mixed.forward(xor_inputs[i]), xor_targets[i]);
+    }
+    for (int epoch = 0; epoch < 2000; epoch++) {
+        for (size_t i = 0; i < xor_inputs.size(); i++) {
+            mixed.train(xor_inputs[i], xor_targets[i], 1.0);
+        }
+    }
+    double mixed_loss_after = 0.0;
+    for (size_t i = 0; i < xor_inputs.size(); i++) {
+        mixed_loss_after += mixed.computeLoss(mixed.forward(xor_inputs[i]), xor_targets[i]);
+    }
+    
+    if (mixed_loss_after < mixed_loss_before) {
+        std::cout << "✓ 混合精度训练损失下降: " << mixed_loss_before / 4 << " -> " << mixed_loss_after / 4
+                  << "，损失缩放因子: " << mixed.getLossScale() << std::endl;
+    } else {
+        std::cout << "⚠ 混合精度训练可能存在问题" << std::endl;
+    }
+    
+    if (mixed.saveModel("test_bf16_model.dat", neural_network::PrecisionType::BFLOAT16)) {
+        neural_network::Network reloaded;
+        reloaded.setMixedPrecision(true);
+        reloaded.loadModel("test_bf16_model.dat");
+        // 不启用混合精度加载时，参数同样是导出时的bfloat16数值
+        neural_network::Network reloaded_plain;
+        bool bf16_exact = reloaded_plain.loadModel("test_bf16_model.dat");
+        auto exported = mixed.getParameters();
+        auto restored = reloaded_plain.getParameters();
+        bf16_exact = bf16_exact && exported.size() == restored.size();
+        for (size_t p = 0; bf16_exact && p < exported.size(); p++) {
+            bf16_exact = restored[p] == neural_network::roundToBFloat16(exported[p]);
+        }
+        if (reloaded.forward(xor_inputs[1]) == mixed.forward(xor_inputs[1]) && bf16_exact) {
+            std::cout << "✓ bfloat16模型导出与加载结果一致" << std::endl;
+        } else {
+            std::cout << "⚠ bfloat16模型导出与加载结果不一致" << std::endl;
+        }
+        std::remove("test_bf16_model.dat");
+    }
+    
+    // 测试10: 并行只读评估
+    neural_network::Dataset xor_dataset;
+    for (size_t i = 0; i < xor_inputs.size(); i++) {
+        xor_dataset.push_back({xor_inputs[i], xor_targets[i]});
+    }
+    auto single = mixed.evaluate(xor_dataset, neural_network::EvaluationMetrics::ALL, 1);
+    auto parallel = mixed.evaluate(xor_dataset, neural_network::EvaluationMetrics::ALL, 4);
+    if (single.mean_loss == parallel.mean_loss && single.confusion_matrix == parallel.confusion_matrix &&
+        std::abs(single.mean_loss - mixed_loss_after / 4) < 1e-12) {
+        std::cout << "✓ 并行评估成功，平均损失: " << parallel.mean_loss
+                  << "，准确率: " << parallel.accuracy << std::endl;
+    } else {
+        std::cout << "⚠ 并行评估结果与串行不一致" << std::endl;
+    }
+    
+    // 损失跨多个数量级时，按线程分组求和会改变舍入，结果必须与线程数无关
+    neural_network::Network wide_loss_net;
+    wide_loss_net.addLayer(std::make_shared<neural_network::Layer>(1, 2));
+    wide_loss_net.getLayer(0)->getNeurons()[0]->setActivationFunction(neural_network::ActivationType::LINEAR);
+    neural_network::Dataset wide_loss_data;
+    for (size_t i = 0; i < 1001; i++) {
+        double magnitude = std::pow(10.0, static_cast<double>(i % 9) - 3.0);
+        wide_loss_data.push_back({{0.001 * static_cast<double>(i % 17), 0.3}, {magnitude * (1.0 + 0.1 * (i % 5))}});
+    }
+    auto wide_single = wide_loss_net.evaluate(wide_loss_data, neural_network::EvaluationMetrics::LOSS, 1);
+    bool loss_invariant = true;
+    for (size_t threads : {2, 3, 5, 8}) {
+        auto wide_parallel = wide_loss_net.evaluate(wide_loss_data, neural_network::EvaluationMetrics::LOSS, threads);
+        loss_invariant = loss_invariant && wide_parallel.mean_loss == wide_single.mean_loss;
+    }
+    if (loss_invariant) {
+        std::cout << "✓ 1/2/3/5/8线程评估的平均损失逐位一致: " << wide_single.mean_loss << std::endl;
+    } else {
+        std::cout << "⚠ 平均损失随线程数变化" << std::endl;
+    }
+    
+    // 测试11: 可复现的批量权重初始化
+    auto build_seeded = [](uint64_t seed) {
+        auto net = std::make_shared<neural_network::Network>();
+        net->setSeed(seed);
+        auto hidden = std::make_shared<neural_network::Layer>(64, 32);
+        hidden->initializeWeights(neural_network::WeightInitScheme::HE, 0);
+        net->addLayer(hidden);
+        net->addLayer(std::make_shared<neural_network::Layer>(4, 64));
+        return net;
+    };
+    auto seeded_a = build_seeded(42);
+    auto seeded_b = build_seeded(42);
+    auto seeded_c = build_seeded(43);
+    std::vector<double> probe(32, 0.25);
+    
+    // 另一个线程同时复制网络时，本线程按全局种子构造的层的初始权重不受影响
+    auto build_unseeded = []() {
+        std::vector<std::shared_ptr<neural_network::Layer>> layers;
+        for (int i = 0; i < 2000; i++) {
+            layers.push_back(std::make_shared<neural_network::Layer>(4, 3));
+        }
+        return layers;
+    };
+    auto layer_weights = [](const std::vector<std::shared_ptr<neural_network::Layer>>& layers) {
+        std::vector<double> weights;
+        for (const auto& layer : layers) {
+            std::vector<double> parameters(layer->parameterCount());
+            layer->exportParameters(parameters.data());
+            weights.insert(weights.end(), parameters.begin(), parameters.end());
+        }
+        return weights;
+    };
+    neural_network::Neuron::setGlobalSeed(7);
+    auto serial_weights = layer_weights(build_unseeded());
+    neural_network::Neuron::setGlobalSeed(7);
+    std::atomic<bool> built{false};
+    std::thread cloner([&] {
+        while (!built) {
+            seeded_a->clone();
+        }
+    });
+    auto concurrent_weights = layer_weights(build_unseeded());
+    built = true;
+    cloner.join();
+    
+    if (seeded_a->predict(probe) == seeded_b->predict(probe) &&
+        seeded_a->predict(probe) != seeded_c->predict(probe) &&
+        seeded_a->getLayer(0)->getInitScheme() == neural_network::WeightInitScheme::HE &&
+        concurrent_weights == serial_weights) {
+        std::cout << "✓ 相同种子的网络初始权重逐位一致" << std::endl;
+    } else {
+        std::cout << "⚠ 种子初始化结果不可复现" << std::endl;
+    }
+    
+    // 测试12: 卷积层与池化层
+    neural_network::Network conv_net;
+    conv_net.setSeed(7);
+    auto conv = std::make_shared<neural_network::Conv2DLayer>(1, 6, 6, 2, 3, 1, 1);
+    conv_net.addLayer(conv);
+    conv_net.addLayer(std::make_shared<neural_network::PoolingLayer>(neural_network::PoolingType::MAX, 2, 6, 6, 2));
+    conv_net.addLayer(std::make_shared<neural_network::Layer>(2, 18));
+    
+    std::vector<double> image(36);
+    for (size_t i = 0; i < image.size(); i++) {
+        image[i] = (i % 7) / 7.0;
+    }
+    std::vector<double> image_target = {1.0, 0.0};
+    
+    conv->setAlgorithm(neural_network::ConvAlgorithm::DIRECT);
+    auto direct_out = conv_net.predict(image);
+    conv->setAlgorithm(neural_network::ConvAlgorithm::IM2COL_GEMM);
+    auto gemm_out = conv_net.predict(image);
+    bool algorithms_match = std::abs(direct_out[0] - gemm_out[0]) < 1e-12 && std::abs(direct_out[1] - gemm_out[1]) < 1e-12;
+    
+    double conv_loss_before = conv_net.computeLoss(conv_net.predict(image), image_target);
+    for (int step = 0; step < 200; step++) {
+        conv_net.train(image, image_target, 0.5);
+    }
+    double conv_loss_after = conv_net.computeLoss(conv_net.predict(image), image_target);
+    
+    if (algorithms_match && conv_loss_after < conv_loss_before) {
+        std::cout << "✓ 卷积/池化网络训练成功，参数量: " << conv->getWeights().size() + conv->getBiases().size()
+                  << "，损失: " << conv_loss_before << " -> " << conv_loss_after << std::endl;
+    } else {
+        std::cout << "⚠ 卷积/池化网络可能存在问题" << std::endl;
+    }
+    
+    conv->setAlgorithm(neural_network::ConvAlgorithm::AUTO);
+    if (conv_net.saveModel("test_conv_model.dat")) {
+        neural_network::Network reloaded_conv;
+        if (reloaded_conv.loadModel("test_conv_model.dat") && reloaded_conv.getLayerCount() == 3 &&
+            reloaded_conv.predict(image) == conv_net.predict(image)) {
+            std::cout << "✓ 卷积网络保存与加载结果一致" << std::endl;
+        } else {
+            std::cout << "⚠ 卷积网络保存与加载结果不一致" << std::endl;
+        }
+        std::remove("test_conv_model.dat");
+    }
+    
+    // 有限差分检查卷积层和池化层的反向传播：L = sum(c * y)
+    // 层间传递的误差不含前一层的激活导数，输入梯度只在线性激活下等于dL/dx
+    auto weighted_sum = [](neural_network::Layer& layer, const std::vector<double>& x) {
+        auto y = layer.forward(x);
+        double total = 0.0;
+        for (size_t i = 0; i < y.size(); i++) {
+            total += std::cos(0.37 * i) * y[i];
+        }
+        return total;
+    };
+    auto check_layer_gradients = [&](neural_network::Layer& layer, const std::vector<double>& x, bool check_inputs) {
+        const double h = 1e-6;
+        auto y = layer.forward(x);
+        std::vector<double> c(y.size());
+        for (size_t i = 0; i < c.size(); i++) {
+            c[i] = std::cos(0.37 * i);
+        }
+        auto dx = layer.backward(c, 1.0, check_inputs);
+        std::vector<double> analytic(layer.parameterCount());
+        layer.exportGradients(analytic.data());
+        double max_error = 0.0;
+        for (size_t k = 0; check_inputs && k < x.size(); k++) {
+            auto plus = x;
+            auto minus = x;
+            plus[k] += h;
+            minus[k] -= h;
+            double numeric = (weighted_sum(layer, plus) - weighted_sum(layer, minus)) / (2 * h);
+            max_error = std::max(max_error, std::abs(numeric - dx[k]));
+        }
+        std::vector<double> parameters(layer.parameterCount());
+        layer.exportParameters(parameters.data());
+        for (size_t k = 0; k < parameters.size(); k++) {
+            auto shifted = parameters;
+            shifted[k] += h;
+            layer.importParameters(shifted.data());
+            double plus = weighted_sum(layer, x);
+            shifted[k] -= 2 * h;
+            layer.importParameters(shifted.data());
+            double minus = weighted_sum(layer, x);
+            max_error = std::max(max_error, std::abs((plus - minus) / (2 * h) - analytic[k]));
+        }
+        layer.importParameters(parameters.data());
+        return max_error;
+    };
+    std::vector<double> grad_image(2 * 5 * 5);
+    for (size_t i = 0; i < grad_image.size(); i++) {
+        grad_image[i] = std::sin(1.7 * i) + 0.01 * i;
+    }
+    neural_network::Conv2DLayer linear_conv(2, 5, 5, 3, 3, 2, 1, neural_network::ActivationType::LINEAR);
+    neural_network::Conv2DLayer sigmoid_conv(2, 5, 5, 3, 3, 1, 1, neural_network::ActivationType::SIGMOID);
+    neural_network::PoolingLayer max_pool(neural_network::PoolingType::MAX, 2, 5, 5, 2, 1);
+    neural_network::PoolingLayer average_pool(neural_network::PoolingType::AVERAGE, 2, 5, 5, 2, 2);
+    double conv_grad_error = check_layer_gradients(linear_conv, grad_image, true);
+    double sigmoid_grad_error = check_layer_gradients(sigmoid_conv, grad_image, false);
+    double max_pool_error = check_layer_gradients(max_pool, grad_image, true);
+    double average_pool_error = check_layer_gradients(average_pool, grad_image, true);
+    if (conv_grad_error < 1e-6 && sigmoid_grad_error < 1e-6 && max_pool_error < 1e-6 && average_pool_error < 1e-6) {
+        std::cout << "✓ 卷积/池化反向传播通过有限差分检查，最大偏差: "
+                  << std::max({conv_grad_error, sigmoid_grad_error, max_pool_error, average_pool_error}) << std::endl;
+    } else {
+        std::cout << "⚠ 卷积/池化反向传播与有限差分不一致: " << conv_grad_error << " " << sigmoid_grad_error
+                  << " " << max_pool_error << " " << average_pool_error << std::endl;
+    }
+    
+    // 测试13: 冻结推理模型与内存统计
+    auto frozen = seeded_a->exportInferenceModel();
+    size_t training_bytes = 0;
+    size_t frozen_bytes = 0;
+    for (const auto& usage : seeded_a->getMemoryUsage()) {
+        training_bytes += usage.totalBytes();
+    }
+    if (frozen) {
+        for (const auto& usage : frozen->getMemoryUsage()) {
+            frozen_bytes += usage.totalBytes();
+        }
+    }
+    // 神经元激活函数不一致的层无法按单一激活函数导出
+    neural_network::Network mixed_net;
+    mixed_net.addLayer(std::make_shared<neural_network::Layer>(3, 4));
+    mixed_net.getLayer(0)->getNeurons()[1]->setActivationFunction(neural_network::ActivationType::TANH);
+    if (frozen && frozen->predict(probe) == seeded_a->predict(probe) && frozen_bytes < training_bytes &&
+        !conv_net.exportInferenceModel() && !mixed_net.exportInferenceModel()) {
+        std::cout << "✓ 冻结模型推理结果一致，内存: " << training_bytes << " -> " << frozen_bytes << " 字节" << std::endl;
+    } else {
+        std::cout << "⚠ 冻结模型可能存在问题" << std::endl;
+    }
+    
+    // 测试14: 增量前向推理
+    auto exact = seeded_a->createIncrementalInference();
+    auto approx = seeded_a->createIncrementalInference(1e-3);
+    std::vector<double> stream_input = probe;
+    bool incremental_ok = exact && approx && !mixed_net.createIncrementalInference() &&
+                          exact->reset(stream_input) && approx->reset(stream_input) &&
+                          exact->getOutputs() == seeded_a->predict(stream_input);
+    double max_exact_error = 0.0;
+    double max_approx_error = 0.0;
+    size_t max_cost = 0;
+    for (size_t step = 0; incremental_ok && step < 50; step++) {
+        std::vector<size_t> indices = {(step * 7) % stream_input.size(), (step * 13 + 5) % stream_input.size()};
+        std::vector<double> deltas = {0.05, -0.03};
+        for (size_t i = 0; i < indices.size(); i++) {
+            stream_input[indices[i]] += deltas[i];
+        }
+        incremental_ok = exact->update(indices, deltas) && approx->update(stream_input);
+        auto expected = seeded_a->predict(stream_input);
+        for (size_t i = 0; incremental_ok && i < expected.size(); i++) {
+            max_exact_error = std::max(max_exact_error, std::abs(exact->getOutputs()[i] - expected[i]));
+            max_approx_error = std::max(max_approx_error, std::abs(approx->getOutputs()[i] - expected[i]));
+        }
+        max_cost = std::max(max_cost, exact->getLastUpdateCost());
+    }
+    if (incremental_ok && max_exact_error < 1e-12 && max_approx_error < 1e-2 &&
+        max_cost < exact->getFullForwardCost() && !exact->update({stream_input.size()}, {1.0})) {
+        std::cout << "✓ 增量推理成功，最大误差: " << max_exact_error << " / " << max_approx_error
+                  << "，单次乘加: " << max_cost << " / " << exact->getFullForwardCost() << std::endl;
+    } else {
+        std::cout << "⚠ 增量推理可能存在问题" << std::endl;
+    }
+    
+    // 按整体输入更新时，重新同步的结果必须与全新的前向传播逐位一致
+    auto resynced = seeded_a->createIncrementalInference(0.0, 4);
+    std::vector<double> resync_input = probe;
+    bool resync_exact = resynced && resynced->reset(resync_input);
+    for (size_t step = 1; resync_exact && step <= 40; step++) {
+        for (size_t i = 0; i < resync_input.size(); i++) {
+            resync_input[i] = 0.1 * static_cast<double>((step * 3 + i * 7) % 11) + 0.7 / static_cast<double>(step);
+        }
+        resync_exact = resynced->update(resync_input) &&
+                       (step % 4 != 0 || resynced->getOutputs() == seeded_a->predict(resync_input));
+    }
+    if (resync_exact) {
+        std::cout << "✓ 增量推理重新同步后与完整前向传播逐位一致" << std::endl;
+    } else {
+        std::cout << "⚠ 增量推理重新同步后与完整前向传播不一致" << std::endl;
+    }
+    
+    // 测试15: LRU推理缓存
+    neural_network::Network cached;
+    cached.setSeed(11);
+    cached.addLayer(std::make_shared<neural_network::Layer>(8, 4));
+    cached.addLayer(std::make_shared<neural_network::Layer>(2, 8));
+    std::vector<double> cache_probe = {1.0, 0.0, 1.0, 0.0};
+    auto uncached_output = cached.predict(cache_probe);
+    cached.enableInferenceCache(1 << 16, 4);
+    bool cache_ok = cached.predict(cache_probe) == uncached_output &&
+                    cached.forward(cache_probe) == uncached_output;
+    auto cache_stats = cached.getInferenceCacheStats();
+    cache_ok = cache_ok && cache_stats.hits == 1 && cache_stats.misses == 1;
+    
+    auto hit_start = std::chrono::steady_clock::now();
+    const int hit_rounds = 100000;
+    for (int i = 0; i < hit_rounds; i++) {
+        cached.predict(cache_probe);
+    }
+    double hit_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - hit_start).count() /
+                    hit_rounds;
+    
+    // 训练改变权重后缓存失效，训练本身不经过缓存
+    uint64_t version_before = cached.getWeightsVersion();
+    cached.train(cache_probe, {1.0, 0.0}, 0.5);
+    auto trained_output = cached.predict(cache_probe);
+    cache_ok = cache_ok && cached.getWeightsVersion() == version_before + 1 && trained_output != uncached_output;
+    cached.disableInferenceCache();
+    cache_ok = cache_ok && cached.predict(cache_probe) == trained_output;
+    
+    // 容量不足时按LRU淘汰
+    neural_network::InferenceCache small_cache(2048, 1);
+    for (int i = 0; i < 64; i++) {
+        small_cache.insert(std::vector<double>(4, i), std::vector<double>(2, i), small_cache.getGeneration());
+    }
+    std::vector<double> cached_value;
+    uint64_t observed_generation = 0;
+    auto small_stats = small_cache.getStats();
+    cache_ok = cache_ok && small_stats.evictions > 0 && small_stats.bytes <= 2048 &&
+               small_cache.lookup(std::vector<double>(4, 63), cached_value, observed_generation) &&
+               cached_value[0] == 63 && !small_cache.lookup(std::vector<double>(4, 0), cached_value, observed_generation);
+    
+    // 查找与插入之间发生失效时，旧权重算出的结果不会被缓存
+    const std::vector<double> racing_inputs(4, 100.0);
+    cache_ok = cache_ok && !small_cache.lookup(racing_inputs, cached_value, observed_generation);
+    small_cache.invalidate();
+    small_cache.insert(racing_inputs, std::vector<double>(2, -1.0), observed_generation);
+    cache_ok = cache_ok && !small_cache.lookup(racing_inputs, cached_value, observed_generation);
+    small_cache.insert(racing_inputs, std::vector<double>(2, 1.0), observed_generation);
+    cache_ok = cache_ok && small_cache.lookup(racing_inputs, cached_value, observed_generation) &&
+               cached_value[0] == 1.0;
+    if (cache_ok) {
+        std::cout << "✓ 推理缓存成功，命中耗时: " << hit_ns << " ns，淘汰: " << small_stats.evictions << std::endl;
+    } else {
+        std::cout << "⚠ 推理缓存可能存在问题" << std::endl;
+    }
+    
+    // 测试16: 同结构小网络的捆绑训练
+    const size_t bundle_size = 8;
+    neural_network::NetworkBundle bundle(bundle_size, {2, 4, 1});
+    std::vector<uint64_t> bundle_seeds;
+    std::vector<double> bundle_rates;
+    std::vector<std::shared_ptr<neural_network::Network>> separate;
+    for (size_t m = 0; m < bundle_size; m++) {
+        bundle_seeds.push_back(100 + m);
+        bundle_rates.push_back(0.1 + 0.05 * m);
+        auto net = std::make_shared<neural_network::Network>();
+        net->setSeed(bundle_seeds.back());
+        net->addLayer(std::make_shared<neural_network::Layer>(4, 2));
+        net->addLayer(std::make_shared<neural_network::Layer>(1, 4));
+        separate.push_back(net);
+    }
+    bool bundle_ok = bundle.setSeeds(bundle_seeds) && bundle.setLearningRates(bundle_rates);
+    for (int epoch = 0; epoch < 200; epoch++) {
+        for (size_t i = 0; i < xor_inputs.size(); i++) {
+            bundle.train(xor_inputs[i], xor_targets[i]);
+            for (size_t m = 0; m < bundle_size; m++) {
+                separate[m]->train(xor_inputs[i], xor_targets[i], bundle_rates[m]);
+            }
+        }
+    }
+    for (size_t i = 0; bundle_ok && i < xor_inputs.size(); i++) {
+        auto bundle_outputs = bundle.forward(xor_inputs[i]);
+        for (size_t m = 0; m < bundle_size; m++) {
+            bundle_ok = bundle_ok && bundle_outputs[m] == separate[m]->predict(xor_inputs[i]) &&
+                        bundle.exportModel(m)->predict(xor_inputs[i]) == bundle_outputs[m];
+        }
+    }
+    
+    // 设置种子和导出模型不消耗全局随机流，之后创建的层的初始权重不受影响
+    uint64_t stream_before = neural_network::Neuron::getNextStream();
+    bundle_ok = bundle_ok && bundle.setSeeds(bundle_seeds) && bundle.exportModel(0) &&
+                neural_network::Neuron::getNextStream() == stream_before;
+    
+    // 另一个线程同时设置种子和导出模型时同样不影响本线程构造的层
+    neural_network::Neuron::setGlobalSeed(7);
+    std::atomic<bool> bundle_built{false};
+    std::thread bundle_worker([&] {
+        while (!bundle_built) {
+            bundle.setSeeds(bundle_seeds);
+            bundle.exportModel(0);
+        }
+    });
+    auto bundle_concurrent_weights = layer_weights(build_unseeded());
+    bundle_built = true;
+    bundle_worker.join();
+    bundle_ok = bundle_ok && bundle_concurrent_weights == serial_weights;
+    
+    // 吞吐量：K个模型捆绑训练与逐个训练比较
+    const size_t sweep_size = 256;
+    neural_network::NetworkBundle sweep(sweep_size, {2, 4, 1});
+    std::vector<std::shared_ptr<neural_network::Network>> sweep_networks;
+    for (size_t m = 0; m < sweep_size; m++) {
+        sweep_networks.push_back(sweep.exportModel(m));
+    }
+    auto bundle_start = std::chrono::steady_clock::now();
+    for (int epoch = 0; epoch < 20; epoch++) {
+        for (size_t i = 0; i < xor_inputs.size(); i++) {
+            sweep.train(xor_inputs[i], xor_targets[i]);
+        }
+    }
+    auto bundle_end = std::chrono::steady_clock::now();
+    for (int epoch = 0; epoch < 20; epoch++) {
+        for (size_t i = 0; i < xor_inputs.size(); i++) {
+            for (auto& net : sweep_networks) {
+                net->train(xor_inputs[i], xor_targets[i], 0.1);
+            }
+        }
+    }
+    auto separate_end = std::chrono::steady_clock::now();
+    double speedup = std::chrono::duration<double>(separate_end - bundle_end).count() /
+                     std::chrono::duration<double>(bundle_end - bundle_start).count();
+    if (bundle_ok) {
+        std::cout << "✓ 捆绑训练与单独训练逐位一致，" << sweep_size << "个模型加速比: " << speedup << "x" << std::endl;
+    } else {
+        std::cout << "⚠ 捆绑训练结果与单独训练不一致" << std::endl;
+    }
+    
+    // 测试17: 流水线并行训练与串行梯度累加逐位一致
+    auto build_deep = []() {
+        auto net = std::make_shared<neural_network::Network>();
+        net->setSeed(21);
+        net->addLayer(std::make_shared<neural_network::Layer>(8, 4));
+        net->addLayer(std::make_shared<neural_network::Layer>(8, 8));
+        net->addLayer(std::make_shared<neural_network::Layer>(8, 8));
+        net->addLayer(std::make_shared<neural_network::Layer>(8, 8));
+        net->addLayer(std::make_shared<neural_network::Layer>(2, 8));
+        return net;
+    };
+    neural_network::Dataset pipeline_batch;
+    for (int i = 0; i < 16; i++) {
+        pipeline_batch.push_back({{i / 16.0, (i % 4) / 4.0, (i % 3) / 3.0, 0.5}, {(i % 2) * 1.0, (i % 3 == 0) * 1.0}});
+    }
+    auto serial_net = build_deep();
+    auto single_rank = neural_network::SocketTransport::createLocalRing(1);
+    neural_network::DistributedTrainer serial_trainer(*serial_net, *single_rank[0]);
+    auto gpipe_net = build_deep();
+    auto interleaved_net = build_deep();
+    neural_network::PipelineTrainer gpipe(*gpipe_net, 3, neural_network::PipelineSchedule::GPIPE);
+    neural_network::PipelineTrainer interleaved(*interleaved_net, 3, neural_network::PipelineSchedule::ONE_F_ONE_B);
+    neural_network::PipelineStats gpipe_stats;
+    neural_network::PipelineStats interleaved_stats;
+    for (int step = 0; step < 10; step++) {
+        serial_trainer.trainStep(pipeline_batch, 0.5);
+        gpipe_stats = gpipe.trainBatch(pipeline_batch, 4, 0.5);
+        interleaved_stats = interleaved.trainBatch(pipeline_batch, 4, 0.5);
+    }
+    if (gpipe.getStageCount() == 3 && gpipe_net->getParameters() == serial_net->getParameters() &&
+        interleaved_net->getParameters() == serial_net->getParameters() &&
+        interleaved_stats.peak_stashed_samples[0] < gpipe_stats.peak_stashed_samples[0]) {
+        std::cout << "✓ 流水线训练与串行训练逐位一致，首阶段暂存样本: GPipe " << gpipe_stats.peak_stashed_samples[0]
+                  << " / 1F1B " << interleaved_stats.peak_stashed_samples[0] << std::endl;
+    } else {
+        std::cout << "⚠ 流水线训练结果与串行训练不一致" << std::endl;
+    }
+    
+    // 有界队列（阶段数 x 微批次大小）在各种微批次划分下都不会死锁，结果仍与串行一致
+    neural_network::Dataset long_batch;
+    for (int i = 0; i < 64; i++) {
+        long_batch.push_back({{std::sin(0.3 * i), (i % 5) / 5.0, (i % 7) / 7.0, 0.25}, {(i % 2) * 1.0, (i % 3 == 0) * 1.0}});
+    }
+    bool bounded_ok = true;
+    size_t bounded_capacity = 0;
+    for (auto schedule : {neural_network::PipelineSchedule::GPIPE, neural_network::PipelineSchedule::ONE_F_ONE_B}) {
+        for (size_t micro : {1, 3, 7, 16, 64}) {
+            auto reference_net = build_deep();
+            auto bounded_net = build_deep();
+            neural_network::DistributedTrainer reference_trainer(*reference_net, *single_rank[0]);
+            neural_network::PipelineTrainer bounded(*bounded_net, 4, schedule);
+            neural_network::PipelineStats bounded_stats;
+            for (int step = 0; step < 2; step++) {
+                reference_trainer.trainStep(long_batch, 0.5);
+                bounded_stats = bounded.trainBatch(long_batch, micro, 0.5);
+            }
+            bounded_ok = bounded_ok && bounded_net->getParameters() == reference_net->getParameters();
+            if (micro == 16) {
+                bounded_capacity = bounded_stats.queue_capacity;
+                bounded_ok = bounded_ok && bounded_capacity < long_batch.size();
+            }
+        }
+    }
+    if (bounded_ok) {
+        std::cout << "✓ 有界队列流水线在各种微批次划分下完成训练，64个样本16个微批次时队列容量: "
+                  << bounded_capacity << std::endl;
+    } else {
+        std::cout << "⚠ 有界队列流水线训练结果与串行训练不一致" << std::endl;
+    }
+    
+    // 含二值层的流水线：暂存缓存后每个样本的直通估计仍使用自己的z
+    auto build_binary_deep = []() {
+        auto net = std::make_shared<neural_network::Network>();
+        net->setSeed(23);
+        net->addLayer(std::make_shared<neural_network::Layer>(8, 4));
+        net->addLayer(std::make_shared<neural_network::BinaryLayer>(8, 8));
+        net->addLayer(std::make_shared<neural_network::Layer>(8, 8));
+        net->addLayer(std::make_shared<neural_network::Layer>(2, 8));
+        return net;
+    };
+    auto binary_serial_net = build_binary_deep();
+    auto binary_pipeline_net = build_binary_deep();
+    auto binary_initial = binary_pipeline_net->getParameters();
+    neural_network::DistributedTrainer binary_serial(*binary_serial_net, *single_rank[0]);
+    neural_network::PipelineTrainer binary_pipeline(*binary_pipeline_net, 3);
+    for (int step = 0; step < 5; step++) {
+        binary_serial.trainStep(long_batch, 0.5);
+        binary_pipeline.trainBatch(long_batch, 8, 0.5);
+    }
+    if (binary_pipeline_net->getParameters() == binary_serial_net->getParameters() &&
+        binary_pipeline_net->getParameters() != binary_initial) {
+        std::cout << "✓ 含二值层的流水线训练与串行训练逐位一致" << std::endl;
+    } else {
+        std::cout << "⚠ 含二值层的流水线训练与串行训练不一致" << std::endl;
+    }
+    
+    // 测试18: 内核自动调优与调优缓存
+    neural_network::Network tuned_net;
+    tuned_net.setSeed(33);
+    tuned_net.addLayer(std::make_shared<neural_network::Layer>(24, 40));
+    tuned_net.addLayer(std::make_shared<neural_network::Layer>(6, 24));
+    std::vector<std::vector<double>> tune_batch(20, std::vector<double>(40));
+    for (size_t s = 0; s < tune_batch.size(); s++) {
+        for (size_t k = 0; k < 40; k++) {
+            tune_batch[s][k] = std::sin(0.37 * s + 0.11 * k);
+        }
+    }
+    auto untuned_out = tuned_net.predictBatch(tune_batch);
+    
+    bool variants_match = true;
+    for (const auto& config : tuned_net.getLayer(0)->kernelCandidates(4)) {
+        tuned_net.getLayer(0)->setKernelConfig(config);
+        variants_match = variants_match && tuned_net.predictBatch(tune_batch) == untuned_out;
+    }
+    
+    const char* tuning_file = "test_kernel_tuning.txt";
+    std::remove(tuning_file);
+    auto tuner = std::make_shared<neural_network::KernelTuner>(tuning_file);
+    tuned_net.enableAutotune(tuner, 16);
+    bool tuned_match = tuned_net.predictBatch(tune_batch) == untuned_out &&
+                       tuned_net.predict(tune_batch[3]) == untuned_out[3];
+    
+    neural_network::KernelTuner reloaded_tuner(tuning_file);
+    size_t retuned = reloaded_tuner.tune(tuned_net, 16);
+    
+    // 写坏的行只跳过该行，不丢弃整个缓存文件
+    {
+        std::ofstream torn(tuning_file, std::ios::app);
+        torn << "torn\tline\n" << "cpu\tshape\t16\tunknown_variant\t1\t1\t1\t1\t1\n" << "cpu\tsha";
+    }
+    neural_network::KernelTuner torn_tuner(tuning_file);
+    if (variants_match && tuned_match && tuner->getEntries().size() == 2 &&
+        reloaded_tuner.getEntries().size() == 2 && retuned == 0 && torn_tuner.getEntries().size() == 2) {
+        std::cout << "✓ 内核调优结果逐位一致，第一层选用线程数: "
+                  << tuned_net.getLayer(0)->getKernelConfig().threads << "，缓存加载后无需重新测试" << std::endl;
+    } else {
+        std::cout << "⚠ 内核调优可能存在问题" << std::endl;
+    }
+    std::remove(tuning_file);
+    
+    // 测试19: Chrome trace时间线导出
+    auto& tracer = neural_network::Tracer::instance();
+    neural_network::Network traced_net;
+    traced_net.setSeed(5);
+    traced_net.addLayer(std::make_shared<neural_network::Layer>(4, 2));
+    traced_net.addLayer(std::make_shared<neural_network::Layer>(1, 4));
+    neural_network::Dataset traced_data = {{{0, 0}, {0}}, {{0, 1}, {1}}, {{1, 0}, {1}}, {{1, 1}, {0}}};
+    
+    tracer.enable();
+    tracer.setThreadName("main");
+    for (const auto& sample : traced_data) {
+        traced_net.train(sample.first, sample.second, 0.5);
+    }
+    traced_net.evaluate(traced_data, neural_network::EvaluationMetrics::LOSS, 2);
+    bool traced_io = traced_net.saveModel("test_trace_model.dat") && traced_net.loadModel("test_trace_model.dat");
+    std::remove("test_trace_model.dat");
+    tracer.disable();
+    
+    size_t traced_events = tracer.getEventCount();
+    traced_net.train(traced_data[0].first, traced_data[0].second, 0.5);
+    std::string trace_json = tracer.toChromeTrace();
+    bool trace_complete = traced_io && traced_events == tracer.getEventCount() && traced_events >= 4 * 7 + 4;
+    for (const char* name : {"\"Network::forward\"", "\"Network::backpropagate\"", "\"Layer::forward\"",
+                             "\"Layer::backward\"", "\"Network::updateWeights\"", "\"Network::saveModel\"",
+                             "\"Network::loadModel\"", "\"Network::evaluate worker\"", "\"thread_name\""}) {
+        trace_complete = trace_complete && trace_json.find(name) != std::string::npos;
+    }
+    
+    // 缓冲区写满后只保留最新的事件（两层网络每次训练记录7个事件）
+    tracer.enable(16);
+    for (int step = 0; step < 20; step++) {
+        traced_net.train(traced_data[step % 4].first, traced_data[step % 4].second, 0.5);
+    }
+    tracer.disable();
+    bool ring_wraps = tracer.getEventCount() == 16 && tracer.getDroppedCount() == 20 * 7 - 16;
+    tracer.clear();
+    
+    if (trace_complete && ring_wraps && tracer.writeChromeTrace("test_trace.json")) {
+        std::cout << "✓ 跟踪事件导出成功，事件数: " << traced_events << std::endl;
+    } else {
+        std::cout << "⚠ 跟踪事件导出可能存在问题" << std::endl;
+    }
+    std::remove("test_trace.json");
+    
+    // 测试20: 全连接层的低秩分解压缩
+    neural_network::Network wide_net;
+    wide_net.setSeed(8);
+    wide_net.addLayer(std::make_shared<neural_network::Layer>(24, 32));
+    wide_net.addLayer(std::make_shared<neural_network::Layer>(2, 24));
+    
+    // 第一层权重设为秩4的矩阵，分解应几乎无损
+    std::vector<double> low_rank_params(24 * 33);
+    for (size_t j = 0; j < 24; j++) {
+        for (size_t k = 0; k < 32; k++) {
+            low_rank_params[j * 33 + k] = 0.1 * std::sin(0.3 * j + 0.2 * k) + 0.05 * std::cos(0.7 * j) * (k % 5) +
+                                          0.02 * (j % 3) * std::cos(0.9 * k);
+        }
+        low_rank_params[j * 33 + 32] = 0.01 * j;
+    }
+    wide_net.getLayer(0)->importParameters(low_rank_params.data());
+    
+    neural_network::Dataset wide_data;
+    for (int i = 0; i < 32; i++) {
+        std::vector<double> x(32);
+        for (size_t k = 0; k < x.size(); k++) {
+            x[k] = std::sin(1.3 * i + 0.4 * k);
+        }
+        wide_data.push_back({x, wide_net.predict(x)});
+    }
+    
+    auto sigma = neural_network::LowRankCompressor::singularValues(*wide_net.getLayer(0));
+    neural_network::LowRankOptions speedup_options;
+    speedup_options.target_speedup = 2.0;
+    size_t speedup_rank = neural_network::LowRankCompressor(speedup_options).chooseRank(sigma, 32, 24);
+    
+    neural_network::LowRankOptions energy_options;
+    energy_options.energy_threshold = 0.999999;
+    auto compression = neural_network::LowRankCompressor(energy_options).compress(wide_net, wide_data);
+    double max_error = 0.0;
+    for (const auto& sample : wide_data) {
+        auto out = wide_net.predict(sample.first);
+        for (size_t k = 0; k < out.size(); k++) {
+            max_error = std::max(max_error, std::abs(out[k] - sample.second[k]));
+        }
+    }
+    
+    bool compressed_reload = false;
+    if (wide_net.saveModel("test_low_rank_model.dat")) {
+        neural_network::Network reloaded_wide;
+        compressed_reload = reloaded_wide.loadModel("test_low_rank_model.dat") && reloaded_wide.getLayerCount() == 3 &&
+                            std::abs(reloaded_wide.predict(wide_data[5].first)[0] - wide_net.predict(wide_data[5].first)[0]) < 1e-9;
+        std::remove("test_low_rank_model.dat");
+    }
+    
+    if (speedup_rank == 6 && compression.layers.size() == 2 && compression.layers[0].factored &&
+        compression.layers[0].rank == 4 && !compression.layers[1].factored && wide_net.getLayerCount() == 3 &&
+        compression.flops_after < compression.flops_before && max_error < 1e-9 && compressed_reload) {
+        std::cout << "✓ 低秩分解成功，秩: " << compression.layers[0].rank << "，乘加次数: "
+                  << compression.flops_before << " -> " << compression.flops_after << "，最大误差: " << max_error << std::endl;
+    } else {
+        std::cout << "⚠ 低秩分解可能存在问题" << std::endl;
+    }
+    
+    // 测试21: XNOR-popcount二值层
+    auto binary = std::make_shared<neural_network::BinaryLayer>(12, 100);
+    std::vector<double> binary_weights(12 * 100);
+    for (size_t i = 0; i < binary_weights.size(); i++) {
+        binary_weights[i] = std::sin(0.37 * i);
+    }
+    binary->setWeights(binary_weights);
+    
+    // 与逐元素±1点积的参考实现比较（100个输入不是64的整数倍，检验补齐位）
+    std::vector<std::vector<double>> bit_inputs;
+    for (int s = 0; s < 16; s++) {
+        std::vector<double> x(100);
+        for (size_t k = 0; k < x.size(); k++) {
+            x[k] = (k * 7 + s * 13) % 5 < 2 ? 1.0 : 0.0;
+        }
+        bit_inputs.push_back(x);
+    }
+    auto binary_batch = binary->predictBatch(bit_inputs);
+    bool binary_matches = true;
+    for (size_t s = 0; s < bit_inputs.size(); s++) {
+        auto single = binary->forward(bit_inputs[s]);
+        for (size_t j = 0; j < 12; j++) {
+            double dot = 0.0;
+            for (size_t k = 0; k < 100; k++) {
+                dot += (bit_inputs[s][k] > 0.5 ? 1.0 : -1.0) * (binary_weights[j * 100 + k] >= 0.0 ? 1.0 : -1.0);
+            }
+            double expected = dot / 10.0 + binary->getBiases()[j] >= 0.0 ? 1.0 : 0.0;
+            binary_matches = binary_matches && binary_batch[s][j] == expected && single[j] == expected;
+        }
+    }
+    
+    // 3x3的0/1数字像素（同digit_recognition示例），二值隐藏层 + sigmoid输出层
+    neural_network::Dataset digit_data = {
+        {{1, 1, 1, 1, 0, 1, 1, 1, 1}, {1.0, 0.0}}, {{0, 1, 0, 1, 0, 1, 0, 1, 0}, {1.0, 0.0}},
+        {{0, 1, 0, 0, 1, 0, 0, 1, 0}, {0.0, 1.0}}, {{0, 0, 1, 0, 0, 1, 0, 0, 1}, {0.0, 1.0}}};
+    neural_network::Network binary_net;
+    binary_net.setSeed(5);
+    binary_net.addLayer(std::make_shared<neural_network::BinaryLayer>(16, 9));
+    binary_net.addLayer(std::make_shared<neural_network::Layer>(2, 16));
+    double binary_loss_before = 0.0;
+    for (const auto& sample : digit_data) {
+        binary_loss_before += binary_net.computeLoss(binary_net.predict(sample.first), sample.second);
+    }
+    for (int epoch = 0; epoch < 300; epoch++) {
+        for (const auto& sample : digit_data) {
+            binary_net.train(sample.first, sample.second, 0.5);
+        }
+    }
+    double binary_loss_after = 0.0;
+    size_t binary_correct = 0;
+    for (const auto& sample : digit_data) {
+        auto out = binary_net.predict(sample.first);
+        binary_loss_after += binary_net.computeLoss(out, sample.second);
+        binary_correct += (out[1] > out[0]) == (sample.second[1] > sample.second[0]) ? 1 : 0;
+    }
+    
+    bool binary_reload = false;
+    if (binary_net.saveModel("test_binary_model.dat")) {
+        neural_network::Network reloaded_binary;
+        binary_reload = reloaded_binary.loadModel("test_binary_model.dat") && reloaded_binary.getLayerCount() == 2 &&
+                        reloaded_binary.getLayer(0)->typeName() == "binary" &&
+                        reloaded_binary.predict(digit_data[2].first) == binary_net.predict(digit_data[2].first);
+        std::remove("test_binary_model.dat");
+    }
+    
+    // 推理参数：12个神经元 x 2个64位字 + 12个阈值；同尺寸全连接层为12 x 101个double
+    auto binary_memory = binary->memoryUsage();
+    if (binary_matches && binary_loss_after < binary_loss_before && binary_correct == digit_data.size() &&
+        binary_reload && binary_memory.parameter_bytes == 12 * 2 * 8 + 12 * 8) {
+        std::cout << "✓ 二值层XNOR-popcount结果与参考实现一致，损失: " << binary_loss_before << " -> "
+                  << binary_loss_after << "，推理参数: " << binary_memory.parameter_bytes << " 字节" << std::endl;
+    } else {
+        std::cout << "⚠ 二值层可能存在问题" << std::endl;
+    }
+    
+    // 测试22: 冻结前缀微调与前缀输出缓存
+    auto make_frozen_net = []() {
+        neural_network::Network net;
+        net.setSeed(21);
+        net.addLayer(std::make_shared<neural_network::Layer>(10, 6));
+        net.addLayer(std::make_shared<neural_network::Layer>(8, 10));
+        net.addLayer(std::make_shared<neural_network::Layer>(6, 8));
+        net.addLayer(std::make_shared<neural_network::Layer>(2, 6));
+        net.freezeLayers(2);
+        return net;
+    };
+    neural_network::Network full_tune = make_frozen_net();
+    neural_network::Network cached_tune = make_frozen_net();
+    
+    neural_network::Dataset tune_data;
+    for (int i = 0; i < 24; i++) {
+        std::vector<double> x(6);
+        for (size_t k = 0; k < x.size(); k++) {
+            x[k] = std::cos(0.9 * i + 0.5 * k);
+        }
+        tune_data.push_back({x, {x[0] > 0 ? 1.0 : 0.0, x[1] > 0 ? 1.0 : 0.0}});
+    }
+    
+    std::vector<double> prefix_before(full_tune.getLayer(0)->parameterCount() + full_tune.getLayer(1)->parameterCount());
+    full_tune.getLayer(0)->exportParameters(prefix_before.data());
+    full_tune.getLayer(1)->exportParameters(prefix_before.data() + full_tune.getLayer(0)->parameterCount());
+    
+    auto memory_cache = neural_network::ActivationCache::build(cached_tune, 2, tune_data);
+    auto file_cache = neural_network::ActivationCache::build(cached_tune, 2, tune_data, "test_activation_cache.bin");
+    auto reopened_cache = neural_network::ActivationCache::open("test_activation_cache.bin");
+    bool caches_agree = memory_cache && file_cache && reopened_cache && reopened_cache->isMapped() &&
+                        reopened_cache->getSampleCount() == tune_data.size() && reopened_cache->getWidth() == 8 &&
+                        reopened_cache->matches(cached_tune);
+    for (size_t i = 0; caches_agree && i < tune_data.size(); i++) {
+        caches_agree = memory_cache->activations(i) == reopened_cache->activations(i);
+    }
+    
+    for (int epoch = 0; epoch < 20; epoch++) {
+        for (size_t i = 0; i < tune_data.size(); i++) {
+            full_tune.train(tune_data[i].first, tune_data[i].second, 0.3);
+            cached_tune.trainFrom(reopened_cache->getBoundary(), reopened_cache->activations(i), tune_data[i].second, 0.3);
+        }
+    }
+    
+    std::vector<double> prefix_after(prefix_before.size());
+    full_tune.getLayer(0)->exportParameters(prefix_after.data());
+    full_tune.getLayer(1)->exportParameters(prefix_after.data() + full_tune.getLayer(0)->parameterCount());
+    bool cache_still_valid = reopened_cache->matches(cached_tune);
+    bool suffix_matches = full_tune.getParameters() == cached_tune.getParameters();
+    
+    // 修改前缀权重后缓存应失效
+    cached_tune.freezeLayers(0);
+    cached_tune.train(tune_data[0].first, tune_data[0].second, 0.3);
+    bool cache_invalidated = !reopened_cache->matches(cached_tune);
+    std::remove("test_activation_cache.bin");
+    
+    if (caches_agree && prefix_after == prefix_before && full_tune.getFrozenPrefixLength() == 2 &&
+        full_tune.getParameters() != make_frozen_net().getParameters() && cache_still_valid && cache_invalidated && suffix_matches) {
+        std::cout << "✓ 冻结前缀微调成功，缓存前缀输出的训练与完整前向训练结果一致" << std::endl;
+    } else {
+        std::cout << "⚠ 冻结前缀微调可能存在问题" << std::endl;
+    }
+    
+    // 测试23: 确定性多线程数据并行训练
+    auto make_parallel_net = []() {
+        // 只设置神经元全局种子：全连接层和卷积层的默认初始化都由它派生
+        neural_network::Neuron::setGlobalSeed(99);
+        neural_network::Network net;
+        net.addLayer(std::make_shared<neural_network::Conv2DLayer>(1, 4, 4, 2, 3, 1, 1));
+        net.addLayer(std::make_shared<neural_network::Layer>(12, 32));
+        net.addLayer(std::make_shared<neural_network::Layer>(3, 12));
+        return net;
+    };
+    neural_network::Dataset parallel_data;
+    for (int i = 0; i < 45; i++) {
+        std::vector<double> x(16);
+        for (size_t k = 0; k < x.size(); k++) {
+            x[k] = std::sin(0.7 * i + 1.1 * k);
+        }
+        std::vector<double> target(3, 0.0);
+        target[i % 3] = 1.0;
+        parallel_data.push_back({x, target});
+    }
+    
+    std::vector<std::vector<double>> deterministic_results;
+    double first_loss = 0.0;
+    double last_loss = 0.0;
+    for (size_t threads : {1, 2, 3, 5}) {
+        neural_network::Network net = make_parallel_net();
+        neural_network::DataParallelOptions parallel_options;
+        parallel_options.num_threads = threads;
+        parallel_options.chunk_size = 4;
+        parallel_options.seed = 17;
+        neural_network::DataParallelTrainer parallel_trainer(net, parallel_options);
+        for (int epoch = 0; epoch < 5; epoch++) {
+            auto epoch_stats = parallel_trainer.trainEpoch(parallel_data, 16, 0.5);
+            if (threads == 1) {
+                (epoch == 0 ? first_loss : last_loss) = epoch_stats.mean_loss;
+            }
+        }
+        deterministic_results.push_back(net.getParameters());
+    }
+    bool thread_invariant = true;
+    for (const auto& result : deterministic_results) {
+        thread_invariant = thread_invariant && result == deterministic_results[0];
+    }
+    
+    // 非确定性快速路径只保证与确定性结果在舍入误差内一致
+    neural_network::Network fast_net = make_parallel_net();
+    neural_network::DataParallelOptions fast_options;
+    fast_options.num_threads = 3;
+    fast_options.deterministic = false;
+    fast_options.seed = 17;
+    neural_network::DataParallelTrainer fast_trainer(fast_net, fast_options);
+    for (int epoch = 0; epoch < 5; epoch++) {
+        fast_trainer.trainEpoch(parallel_data, 16, 0.5);
+    }
+    double fast_difference = 0.0;
+    auto fast_parameters = fast_net.getParameters();
+    for (size_t p = 0; p < fast_parameters.size(); p++) {
+        fast_difference = std::max(fast_difference, std::abs(fast_parameters[p] - deterministic_results[0][p]));
+    }
+    
+    if (thread_invariant && last_loss < first_loss && fast_difference < 1e-9) {
+        std::cout << "✓ 确定性数据并行训练在1/2/3/5个线程下逐位一致，损失: " << first_loss << " -> " << last_loss
+                  << "，快速路径最大偏差: " << fast_difference << std::endl;
+    } else {
+        std::cout << "⚠ 确定性数据并行训练可能存在问题" << std::endl;
+    }
+    
+    // 测试24: 从管道流式在线训练
+    auto stream_sample = [](size_t i) {
+        std::vector<double> x = {std::sin(0.1 * i), std::cos(0.3 * i), std::sin(0.7 * i + 1.0), 0.5};
+        std::vector<double> target = {x[0] * x[1] > 0.0 ? 0.9 : 0.1};
+        return std::make_pair(x, target);
+    };
+    auto make_stream_net = []() {
+        neural_network::Network net;
+        net.setSeed(31);
+        net.addLayer(std::make_shared<neural_network::Layer>(8, 4));
+        net.addLayer(std::make_shared<neural_network::Layer>(1, 8));
+        return net;
+    };
+    // 子进程作为数据生成端写管道，写完关闭写端
+    auto spawn_generator = [](int fds[2], const std::function<void(int)>& generate) {
+        if (pipe(fds) != 0) {
+            return static_cast<pid_t>(-1);
+        }
+        pid_t child = fork();
+        if (child == 0) {
+            close(fds[0]);
+            generate(fds[1]);
+            close(fds[1]);
+            _exit(0);
+        }
+        close(fds[1]);
+        return child;
+    };
+    
+    const size_t stream_records = 3000;
+    int binary_pipe[2];
+    pid_t binary_child = spawn_generator(binary_pipe, [&](int fd) {
+        for (size_t i = 0; i < stream_records; i++) {
+            auto sample = stream_sample(i);
+            neural_network::StreamTrainer::writeBinaryRecord(fd, sample.first, sample.second);
+            if (i == stream_records / 2) {
+                // 长度不符的记录应被整条跳过
+                neural_network::StreamTrainer::writeBinaryRecord(fd, {1.0, 2.0}, {3.0});
+            }
+        }
+    });
+    neural_network::Network stream_net = make_stream_net();
+    neural_network::ModelHandle snapshots;
+    neural_network::StreamOptions stream_options;
+    stream_options.batch_size = 8;
+    stream_options.ring_capacity = 16;
+    stream_options.read_buffer_bytes = 256;
+    stream_options.snapshot_interval = 50;
+    neural_network::StreamTrainer stream_trainer(stream_net, stream_options, &snapshots);
+    const size_t buffer_bytes = stream_trainer.getBufferBytes();
+    bool binary_ok = binary_child > 0 && stream_trainer.run(binary_pipe[0]);
+    close(binary_pipe[0]);
+    int child_status = 0;
+    waitpid(binary_child, &child_status, 0);
+    auto binary_stats = stream_trainer.getStats();
+    
+    // 与按同样顺序逐样本训练的网络逐位一致
+    neural_network::Network stream_reference = make_stream_net();
+    for (size_t i = 0; i < stream_records; i++) {
+        auto sample = stream_sample(i);
+        stream_reference.train(sample.first, sample.second, stream_options.learning_rate);
+    }
+    auto stream_probe = stream_sample(7).first;
+    binary_ok = binary_ok && binary_stats.records == stream_records && binary_stats.trained == stream_records &&
+                binary_stats.malformed == 1 && binary_stats.producer_waits > 0 &&
+                stream_trainer.getBufferBytes() == buffer_bytes &&
+                stream_net.getParameters() == stream_reference.getParameters() &&
+                snapshots.getVersion() == binary_stats.snapshots &&
+                snapshots.predict(stream_probe) == stream_net.predict(stream_probe);
+    
+    // CSV：一行格式错误，最后一行没有换行符
+    const size_t csv_records = 200;
+    int csv_pipe[2];
+    pid_t csv_child = spawn_generator(csv_pipe, [&](int fd) {
+        std::string text;
+        char field[32];
+        for (size_t i = 0; i < csv_records; i++) {
+            auto sample = stream_sample(i);
+            for (double value : sample.first) {
+                std::snprintf(field, sizeof(field), "%.17g,", value);
+                text += field;
+            }
+            std::snprintf(field, sizeof(field), "%.17g", sample.second[0]);
+            text += field;
+            text += i + 1 < csv_records ? "\n" : "";
+            if (i == 10) {
+                text += "1,2,oops\n";
+            }
+        }
+        ssize_t written = write(fd, text.data(), text.size());
+        (void)written;
+    });
+    neural_network::Network csv_net = make_stream_net();
+    neural_network::StreamOptions csv_options;
+    csv_options.format = neural_network::StreamFormat::CSV;
+    neural_network::StreamTrainer csv_trainer(csv_net, csv_options);
+    bool csv_ok = csv_child > 0 && csv_trainer.run(csv_pipe[0]);
+    close(csv_pipe[0]);
+    waitpid(csv_child, &child_status, 0);
+    neural_network::Network csv_reference = make_stream_net();
+    for (size_t i = 0; i < csv_records; i++) {
+        auto sample = stream_sample(i);
+        csv_reference.train(sample.first, sample.second, csv_options.learning_rate);
+    }
+    auto csv_stats = csv_trainer.getStats();
+    csv_ok = csv_ok && csv_stats.records == csv_records && csv_stats.malformed == 1 &&
+             csv_net.getParameters() == csv_reference.getParameters();
+    
+    if (binary_ok && csv_ok) {
+        std::cout << "✓ 流式训练从管道读取" << binary_stats.records << "条二进制记录，缓冲区固定" << buffer_bytes
+                  << "字节，背压" << binary_stats.producer_waits << "次，发布快照" << binary_stats.snapshots
+                  << "次；CSV记录" << csv_stats.records << "条，结果与逐样本训练一致" << std::endl;
+    } else {
+        std::cout << "⚠ 流式训练可能存在问题" << std::endl;
+    }
+    
+    // 测试25: 批归一化层的批量训练与推理折叠
+    // 有限差分检查整批反向传播：L = sum(c * y)
+    bool bn_gradient_ok = true;
+    for (auto activation : {neural_network::ActivationType::LINEAR, neural_network::ActivationType::SIGMOID}) {
+        neural_network::BatchNormLayer bn(3, activation);
+        std::vector<double> bn_parameters = {1.5, 0.7, -0.4, 0.2, -0.1, 0.3};
+        bn.importParameters(bn_parameters.data());
+        std::vector<std::vector<double>> bn_batch(6, std::vector<double>(3));
+        std::vector<std::vector<double>> weights_c(6, std::vector<double>(3));
+        for (size_t s = 0; s < 6; s++) {
+            for (size_t f = 0; f < 3; f++) {
+                bn_batch[s][f] = std::sin(1.3 * s + 0.7 * f) * (f + 1);
+                weights_c[s][f] = std::cos(0.9 * s - 0.4 * f);
+            }
+        }
+        auto batch_loss = [&](const std::vector<std::vector<double>>& x) {
+            auto y = bn.forwardBatch(x);
+            double total = 0.0;
+            for (size_t s = 0; s < y.size(); s++) {
+                for (size_t f = 0; f < 3; f++) {
+                    total += weights_c[s][f] * y[s][f];
+                }
+            }
+            return total;
+        };
+        batch_loss(bn_batch);
+        auto dx = bn.backwardBatch(weights_c);
+        std::vector<double> bn_gradients(bn.parameterCount());
+        bn.exportGradients(bn_gradients.data());
+        const double h = 1e-6;
+        for (size_t s = 0; s < 6; s++) {
+            for (size_t f = 0; f < 3; f++) {
+                auto plus = bn_batch;
+                auto minus = bn_batch;
+                plus[s][f] += h;
+                minus[s][f] -= h;
+                double numeric = (batch_loss(plus) - batch_loss(minus)) / (2 * h);
+                bn_gradient_ok = bn_gradient_ok && std::abs(numeric - dx[s][f]) < 1e-6;
+            }
+        }
+        // gamma的梯度是整批平均值
+        for (size_t f = 0; f < 3; f++) {
+            auto shifted = bn_parameters;
+            shifted[f] += h;
+            bn.importParameters(shifted.data());
+            double plus = batch_loss(bn_batch);
+            shifted[f] -= 2 * h;
+            bn.importParameters(shifted.data());
+            double minus = batch_loss(bn_batch);
+            bn.importParameters(bn_parameters.data());
+            bn_gradient_ok = bn_gradient_ok && std::abs((plus - minus) / (2 * h) / 6.0 - bn_gradients[f]) < 1e-6;
+        }
+    }
+    
+    neural_network::Dataset bn_data;
+    for (int i = 0; i < 64; i++) {
+        std::vector<double> x = {std::sin(0.3 * i) * 4.0 + 2.0, std::cos(0.7 * i) * 0.1, 0.05 * i};
+        bn_data.push_back({x, {x[0] * x[1] > 0.0 ? 0.9 : 0.1, x[2] > 1.6 ? 0.9 : 0.1}});
+    }
+    
+    // 不含批归一化层时，trainBatch与逐样本计算梯度后平均再更新逐位一致
+    auto make_plain_net = []() {
+        neural_network::Network net;
+        net.setSeed(41);
+        net.addLayer(std::make_shared<neural_network::Layer>(6, 3));
+        net.addLayer(std::make_shared<neural_network::Layer>(2, 6));
+        return net;
+    };
+    neural_network::Network plain_batch = make_plain_net();
+    neural_network::Network plain_reference = make_plain_net();
+    neural_network::DataParallelOptions reference_options;
+    reference_options.num_threads = 1;
+    reference_options.chunk_size = bn_data.size();
+    neural_network::DataParallelTrainer reference_trainer(plain_reference, reference_options);
+    plain_batch.trainBatch(bn_data, 0.5);
+    reference_trainer.trainBatch(bn_data, 0.5);
+    bool batch_matches = plain_batch.getParameters() == plain_reference.getParameters();
+    
+    // 二值层的直通估计依赖每个样本自己的z：作为隐藏层和输出层时同样逐位一致
+    auto make_binary_nets = []() {
+        std::vector<neural_network::Network> nets(2);
+        nets[0].setSeed(47);
+        nets[0].addLayer(std::make_shared<neural_network::Layer>(8, 3));
+        nets[0].addLayer(std::make_shared<neural_network::BinaryLayer>(4, 8));
+        nets[0].addLayer(std::make_shared<neural_network::Layer>(2, 4));
+        nets[1].setSeed(53);
+        nets[1].addLayer(std::make_shared<neural_network::Layer>(8, 3));
+        nets[1].addLayer(std::make_shared<neural_network::BinaryLayer>(2, 8));
+        return nets;
+    };
+    auto batch_binary_nets = make_binary_nets();
+    auto binary_reference = make_binary_nets();
+    for (size_t n = 0; n < batch_binary_nets.size(); n++) {
+        auto before = batch_binary_nets[n].getParameters();
+        neural_network::DataParallelTrainer binary_trainer(binary_reference[n], reference_options);
+        batch_binary_nets[n].trainBatch(bn_data, 0.5);
+        binary_trainer.trainBatch(bn_data, 0.5);
+        batch_matches = batch_matches && batch_binary_nets[n].getParameters() == binary_reference[n].getParameters() &&
+                        batch_binary_nets[n].getParameters() != before;
+    }
+    
+    // Layer(线性) -> BatchNormLayer(sigmoid) -> Layer(sigmoid)
+    neural_network::Network bn_net;
+    bn_net.setSeed(43);
+    auto bn_dense = std::make_shared<neural_network::Layer>(6, 3);
+    for (auto& neuron : bn_dense->getNeurons()) {
+        neuron->setActivationFunction(neural_network::ActivationType::LINEAR);
+    }
+    bn_net.addLayer(bn_dense);
+    bn_net.addLayer(std::make_shared<neural_network::BatchNormLayer>(6, neural_network::ActivationType::SIGMOID));
+    bn_net.addLayer(std::make_shared<neural_network::Layer>(2, 6));
+    double bn_first_loss = 0.0;
+    double bn_last_loss = 0.0;
+    for (int epoch = 0; epoch < 30; epoch++) {
+        for (size_t begin = 0; begin < bn_data.size(); begin += 16) {
+            neural_network::Dataset batch(bn_data.begin() + begin, bn_data.begin() + begin + 16);
+            double loss = bn_net.trainBatch(batch, 1.0);
+            (epoch == 0 && begin == 0 ? bn_first_loss : bn_last_loss) = loss;
+        }
+    }
+    
+    auto folded = bn_net.foldBatchNorm();
+    std::vector<std::vector<double>> bn_inputs;
+    for (const auto& sample : bn_data) {
+        bn_inputs.push_back(sample.first);
+    }
+    auto bn_outputs = bn_net.predictBatch(bn_inputs);
+    double fold_difference = 1.0;
+    if (folded && folded->getLayerCount() == 2) {
+        fold_difference = 0.0;
+        auto folded_outputs = folded->predictBatch(bn_inputs);
+        for (size_t s = 0; s < bn_outputs.size(); s++) {
+            for (size_t k = 0; k < bn_outputs[s].size(); k++) {
+                fold_difference = std::max(fold_difference, std::abs(bn_outputs[s][k] - folded_outputs[s][k]));
+            }
+        }
+    }
+    
+    bn_net.saveModel("test_batchnorm_model.dat");
+    neural_network::Network bn_loaded;
+    bool bn_roundtrip = bn_loaded.loadModel("test_batchnorm_model.dat") &&
+                        bn_loaded.predictBatch(bn_inputs) == bn_outputs;
+    std::remove("test_batchnorm_model.dat");
+    
+    // 滑动统计量是状态量而不是参数：不计入参数量和梯度，复制和数据并行副本同步时一并带上
+    auto bn_copy = bn_net.clone();
+    bool bn_buffers_ok = bn_net.getParameterCount() == 6 * 4 + 12 + 2 * 7 && bn_net.getBuffers().size() == 12 &&
+                         bn_net.getGradients().size() == bn_net.getParameterCount() && bn_copy &&
+                         bn_copy->getBuffers() == bn_net.getBuffers() && bn_copy->predictBatch(bn_inputs) == bn_outputs;
+    neural_network::Dataset bn_head(bn_data.begin(), bn_data.begin() + 16);
+    neural_network::Dataset bn_tail(bn_data.begin() + 16, bn_data.begin() + 32);
+    auto bn_synced = bn_net.clone();
+    auto bn_fresh = bn_net.clone();
+    neural_network::DataParallelTrainer bn_synced_trainer(*bn_synced, reference_options);
+    bn_synced_trainer.trainBatch(bn_head, 0.5);
+    {
+        neural_network::DataParallelTrainer bn_fresh_trainer(*bn_fresh, reference_options);
+        bn_fresh_trainer.trainBatch(bn_head, 0.5);
+    }
+    // 主网络的trainBatch更新滑动统计量后，已有副本必须同步到新的统计量
+    bn_synced->trainBatch(bn_tail, 0.5);
+    bn_fresh->trainBatch(bn_tail, 0.5);
+    bn_synced_trainer.trainBatch(bn_head, 0.5);
+    {
+        neural_network::DataParallelTrainer bn_fresh_trainer(*bn_fresh, reference_options);
+        bn_fresh_trainer.trainBatch(bn_head, 0.5);
+    }
+    bn_buffers_ok = bn_buffers_ok && bn_synced->getParameters() == bn_fresh->getParameters() &&
+                    bn_synced->getBuffers() != bn_net.getBuffers();
+    
+    // 整批前向与逐样本前向一样把过短的样本按0补齐
+    neural_network::BatchNormLayer bn_short(3);
+    neural_network::BatchNormLayer bn_padded(3);
+    bn_buffers_ok = bn_buffers_ok && bn_short.forwardBatch({{1.0, 2.0}, {3.0, -1.0, 0.5}, {0.2}}) ==
+                                     bn_padded.forwardBatch({{1.0, 2.0, 0.0}, {3.0, -1.0, 0.5}, {0.2, 0.0, 0.0}});
+    
+    if (bn_gradient_ok && batch_matches && bn_last_loss < bn_first_loss && fold_difference < 1e-12 &&
+        folded->exportInferenceModel() && !bn_net.exportInferenceModel() && bn_roundtrip && bn_buffers_ok) {
+        std::cout << "✓ 批归一化层梯度检查通过，批量训练损失: " << bn_first_loss << " -> " << bn_last_loss
+                  << "，折叠为" << folded->getLayerCount() << "层后最大偏差: " << fold_difference << std::endl;
+    } else {
+        std::cout << "⚠ 批归一化层可能存在问题" << std::endl;
+    }
+    
     std::cout << "\n所有网络测试完成!" << std::endl;
     return 0;
 }
\ No newline at end of file
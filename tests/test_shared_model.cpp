@@ -0,0 +1,104 @@
+#include "../src/network/network.h"
+#include "../src/network/layer.h"
+#include "../src/network/shared_model.h"
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+int main() {
+    std::cout << "测试SharedModel类功能..." << std::endl;
+    
+    // 测试1: 发布网络到共享内存
+    neural_network::Network network;
+    network.addLayer(std::make_shared<neural_network::Layer>(4, 3));
+    network.addLayer(std::make_shared<neural_network::Layer>(2, 4));
+    for (auto& neuron : network.getLayer(1)->getNeurons()) {
+        neuron->setActivationFunction(neural_network::ActivationType::TANH);
+    }
+    
+    const std::string name = "/nn_test_shared_model_" + std::to_string(getpid());
+    auto publisher = neural_network::SharedModel::publish(name, network);
+    if (publisher) {
+        std::cout << "✓ 成功发布模型，映射大小: " << publisher->getMappedBytes() << " 字节" << std::endl;
+    } else {
+        std::cout << "⚠ 模型发布失败" << std::endl;
+        return 0;
+    }
+    
+    // 测试2: 重复发布同名模型应失败
+    if (!neural_network::SharedModel::publish(name, network)) {
+        std::cout << "✓ 同名模型不能重复发布" << std::endl;
+    } else {
+        std::cout << "⚠ 同名模型被重复发布" << std::endl;
+    }
+    
+    // 测试3: 子进程附加并推理，结果与原网络逐位一致
+    std::vector<double> inputs = {0.2, -0.4, 0.9};
+    std::vector<double> expected = network.predict(inputs);
+    
+    pid_t child = fork();
+    if (child == 0) {
+        bool ok = false;
+        {
+            auto attached = neural_network::SharedModel::attach(name);
+            ok = attached && attached->predict(inputs) == expected && attached->getRefCount() == 2;
+        }
+        _exit(ok ? 0 : 1);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+        std::cout << "✓ 子进程零拷贝附加，推理结果与原网络一致" << std::endl;
+    } else {
+        std::cout << "⚠ 子进程附加或推理失败" << std::endl;
+    }
+    
+    // 测试4: 引用计数在子进程退出后恢复
+    std::cout << "✓ 当前引用计数: " << publisher->getRefCount() << std::endl;
+    
+    // 测试5: 最后一个引用释放后自动清理
+    publisher.reset();
+    if (!neural_network::SharedModel::attach(name)) {
+        std::cout << "✓ 最后一个引用释放后共享内存已清理" << std::endl;
+    } else {
+        std::cout << "⚠ 共享内存未被清理" << std::endl;
+        neural_network::SharedModel::remove(name);
+    }
+    
+    // 测试6: 文件方式共享
+    const std::string path = "test_shared_model_" + std::to_string(getpid()) + ".bin";
+    auto file_model = neural_network::SharedModel::publish(path, network, neural_network::SharedModelBacking::FILE);
+    auto file_reader = neural_network::SharedModel::attach(path, neural_network::SharedModelBacking::FILE);
+    bool file_exclusive = !neural_network::SharedModel::publish(path, network, neural_network::SharedModelBacking::FILE) &&
+                          access((path + ".tmp." + std::to_string(getpid())).c_str(), F_OK) != 0;
+    if (file_model && file_reader && file_reader->predict(inputs) == expected && file_exclusive) {
+        std::cout << "✓ 文件共享映射推理结果一致" << std::endl;
+    } else {
+        std::cout << "⚠ 文件共享映射可能存在问题" << std::endl;
+    }
+    
+    // 测试7: 输入数与第一层不符时拒绝推理
+    if (file_reader && file_reader->predict({0.2, -0.4}).empty() &&
+        file_reader->predict({0.2, -0.4, 0.9, 0.1}).empty()) {
+        std::cout << "✓ 输入数不符时返回空结果" << std::endl;
+    } else {
+        std::cout << "⚠ 输入数不符时仍返回了推理结果" << std::endl;
+    }
+    neural_network::SharedModel::remove(path, neural_network::SharedModelBacking::FILE);
+    
+    // 测试8: 层内激活函数不一致的网络不能发布
+    network.getLayer(1)->getNeurons()[0]->setActivationFunction(neural_network::ActivationType::RELU);
+    const std::string mixed_name = "/nn_test_shared_mixed_" + std::to_string(getpid());
+    if (!neural_network::SharedModel::publish(mixed_name, network)) {
+        std::cout << "✓ 层内激活函数不一致的网络被拒绝发布" << std::endl;
+    } else {
+        std::cout << "⚠ 层内激活函数不一致的网络被发布" << std::endl;
+        neural_network::SharedModel::remove(mixed_name);
+    }
+    
+    std::cout << "\n所有共享模型测试完成!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,39 @@
+#include "../src/network/network.h"
+#include "../src/network/code_generator.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdio>
+
+// 将Network::saveModel保存的模型转换为独立的C++推理头文件
+int main(int argc, char* argv[]) {
+    if (argc < 3 || argc > 4) {
+        std::cerr << "用法: " << argv[0] << " <模型文件> <输出头文件> [命名空间]" << std::endl;
+        return 2;
+    }
+    const std::string model_file = argv[1];
+    const std::string header_file = argv[2];
+    const std::string namespace_name = argc > 3 ? argv[3] : "nn_model";
+    
+    neural_network::Network network;
+    if (!network.loadModel(model_file)) {
+        std::cerr << "无法加载模型: " << model_file << std::endl;
+        return 1;
+    }
+    
+    std::ofstream out(header_file);
+    if (!out.is_open()) {
+        std::cerr << "无法写入: " << header_file << std::endl;
+        return 1;
+    }
+    if (!neural_network::generateInferenceHeader(network, namespace_name, out)) {
+        std::cerr << "模型包含不支持的层类型，或命名空间不合法: " << namespace_name << std::endl;
+        out.close();
+        std::remove(header_file.c_str());
+        return 1;
+    }
+    
+    std::cout << "已生成 " << header_file << "（" << network.getLayerCount() << "层，命名空间 "
+              << namespace_name << "）" << std::endl;
+    return 0;
+}